@@ -0,0 +1,107 @@
+#include "AttributeTypes.h"
+#include <array>
+
+namespace
+{
+    template <AttributeKind kind>
+    int encodeAttribute(float normalised, const AttributeEncoding &encoding) noexcept
+    {
+        return AttributeEncoder<kind>::encode(normalised, encoding);
+    }
+
+    // Indexed by AttributeKind
+    constexpr std::array<AttributeTypes::EncodeFunction, (size_t)AttributeKind::numKinds> encodeFunctions{
+        &encodeAttribute<AttributeKind::generic>,
+        &encodeAttribute<AttributeKind::dimmer>,
+        &encodeAttribute<AttributeKind::hue>,
+        &encodeAttribute<AttributeKind::position16>,
+        &encodeAttribute<AttributeKind::enumerated>,
+        &encodeAttribute<AttributeKind::strobe>};
+
+    constexpr std::array<int, (size_t)AttributeKind::numKinds> messageCounts{
+        AttributeEncoder<AttributeKind::generic>::numMessages,
+        AttributeEncoder<AttributeKind::dimmer>::numMessages,
+        AttributeEncoder<AttributeKind::hue>::numMessages,
+        AttributeEncoder<AttributeKind::position16>::numMessages,
+        AttributeEncoder<AttributeKind::enumerated>::numMessages,
+        AttributeEncoder<AttributeKind::strobe>::numMessages};
+} // namespace
+
+//==============================================================================
+AttributeKind AttributeTypes::getKindFromName(const juce::String &typeName)
+{
+    if (typeName == "dimmer")
+        return AttributeKind::dimmer;
+    if (typeName == "hue")
+        return AttributeKind::hue;
+    if (typeName == "position16")
+        return AttributeKind::position16;
+    if (typeName == "enum")
+        return AttributeKind::enumerated;
+    if (typeName == "strobe")
+        return AttributeKind::strobe;
+
+    return AttributeKind::generic;
+}
+
+AttributeEncoding AttributeTypes::createEncoding(const MidiMap::AttributeType &type, int ccNumber)
+{
+    AttributeEncoding encoding;
+    encoding.kind = getKindFromName(type.type);
+
+    // 14-bit controllers conventionally pair CC n with CC n + 32
+    if (encoding.kind == AttributeKind::position16)
+        encoding.fineCC = juce::jlimit(0, 127, type.fineCC >= 0 ? type.fineCC : ccNumber + 32);
+
+    if (encoding.kind == AttributeKind::enumerated)
+        encoding.numSlots = type.options.size();
+
+    return encoding;
+}
+
+AttributeTypes::EncodeFunction AttributeTypes::getEncodeFunction(AttributeKind kind) noexcept
+{
+    return encodeFunctions[(size_t)kind];
+}
+
+int AttributeTypes::getNumMessages(AttributeKind kind) noexcept
+{
+    return messageCounts[(size_t)kind];
+}
+
+AttributeTypes::ParameterRange AttributeTypes::getParameterRange(const MidiMap::AttributeType &type)
+{
+    ParameterRange range;
+
+    switch (getKindFromName(type.type))
+    {
+    case AttributeKind::dimmer:
+        range.defaultValue = 100.0f;
+        range.unit = "%";
+        break;
+    case AttributeKind::hue:
+        range.maxValue = 360.0f;
+        range.unit = juce::String::fromUTF8(u8"°");
+        break;
+    case AttributeKind::position16:
+        range.interval = 0.0f; // continuous, so the fine CC has something to carry
+        range.unit = "%";
+        break;
+    case AttributeKind::enumerated:
+        range.maxValue = (float)juce::jmax(1, type.options.size() - 1);
+        break;
+    case AttributeKind::strobe:
+        range.maxValue = type.maxRate > 0.0f ? type.maxRate : 20.0f;
+        range.unit = "Hz";
+        break;
+    case AttributeKind::generic:
+    case AttributeKind::numKinds:
+        range.unit = "%";
+        break;
+    }
+
+    if (type.defaultValue >= 0.0f)
+        range.defaultValue = juce::jlimit(range.minValue, range.maxValue, type.defaultValue);
+
+    return range;
+}
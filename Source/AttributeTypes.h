@@ -0,0 +1,112 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "MidiMap.h"
+
+//==============================================================================
+/**
+ * What an attribute controls, which decides its parameter range and how its
+ * normalised value is encoded for MIDI.
+ */
+enum class AttributeKind
+{
+    generic,    // Plain 0-100 %, linear 7-bit
+    dimmer,     // Intensity, linear 7-bit
+    hue,        // 0-360 degrees; 360 wraps to 0
+    position16, // 14-bit value over a coarse and a fine CC
+    enumerated, // Named slots (gobos, macros), each sent at the centre of its band
+    strobe,     // 0 = off, otherwise a rate over 1-127
+    numKinds
+};
+
+//==============================================================================
+/**
+ * Everything an encoder needs about one attribute, resolved when the map is
+ * compiled.
+ */
+struct AttributeEncoding
+{
+    AttributeKind kind = AttributeKind::generic;
+    int fineCC = -1;  // position16: CC carrying the low 7 bits
+    int numSlots = 0; // enumerated: number of named slots
+};
+
+//==============================================================================
+/**
+ * Per-kind encoders. Each specialisation turns a normalised value into the
+ * value sent on the wire (7-bit, or 14-bit for position16).
+ */
+template <AttributeKind kind>
+struct AttributeEncoder
+{
+    static constexpr int numMessages = 1;
+    static int encode(float normalised, const AttributeEncoding &) noexcept { return juce::roundToInt(normalised * 127.0f); }
+};
+
+template <>
+struct AttributeEncoder<AttributeKind::hue>
+{
+    static constexpr int numMessages = 1;
+    static int encode(float normalised, const AttributeEncoding &) noexcept { return juce::roundToInt(normalised * 128.0f) & 127; }
+};
+
+template <>
+struct AttributeEncoder<AttributeKind::position16>
+{
+    static constexpr int numMessages = 2;
+    static int encode(float normalised, const AttributeEncoding &) noexcept { return juce::roundToInt(normalised * 16383.0f); }
+};
+
+template <>
+struct AttributeEncoder<AttributeKind::enumerated>
+{
+    static constexpr int numMessages = 1;
+    static int encode(float normalised, const AttributeEncoding &encoding) noexcept
+    {
+        if (encoding.numSlots <= 1)
+            return 0;
+
+        auto slot = juce::roundToInt(normalised * (float)(encoding.numSlots - 1));
+        return juce::jmin(127, (slot * 128 + 64) / encoding.numSlots);
+    }
+};
+
+template <>
+struct AttributeEncoder<AttributeKind::strobe>
+{
+    static constexpr int numMessages = 1;
+    static int encode(float normalised, const AttributeEncoding &) noexcept { return normalised <= 0.0f ? 0 : 1 + juce::roundToInt(normalised * 126.0f); }
+};
+
+//==============================================================================
+/**
+ * Compile-time lookups for attribute kinds: the encoder table the output
+ * path dispatches through, and the parameter range each kind exposes.
+ */
+namespace AttributeTypes
+{
+    using EncodeFunction = int (*)(float normalised, const AttributeEncoding &encoding) noexcept;
+
+    struct ParameterRange
+    {
+        float minValue = 0.0f;
+        float maxValue = 100.0f;
+        float defaultValue = 0.0f;
+        float interval = 1.0f;
+        juce::String unit;
+    };
+
+    // Resolve a map attribute type into its encoding
+    AttributeEncoding createEncoding(const MidiMap::AttributeType &type, int ccNumber);
+
+    // Specialised encoder for a kind
+    EncodeFunction getEncodeFunction(AttributeKind kind) noexcept;
+
+    // Number of CCs one value takes on the wire
+    int getNumMessages(AttributeKind kind) noexcept;
+
+    // Parameter range for a map attribute type
+    ParameterRange getParameterRange(const MidiMap::AttributeType &type);
+
+    AttributeKind getKindFromName(const juce::String &typeName);
+} // namespace AttributeTypes
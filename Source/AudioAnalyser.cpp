@@ -0,0 +1,157 @@
+#include "AudioAnalyser.h"
+#include "MemoryFootprint.h"
+#include <cmath>
+
+namespace
+{
+    // One-pole coefficient reaching 63 % of a step after timeSeconds, updated every intervalSeconds
+    float getOnePoleCoefficient(double timeSeconds, double intervalSeconds)
+    {
+        return (float)(1.0 - std::exp(-intervalSeconds / juce::jmax(1.0e-6, timeSeconds)));
+    }
+
+    // Amplitude to 0-1 over a 60 dB range
+    float normaliseLevel(float amplitude) noexcept
+    {
+        return juce::jlimit(0.0f, 1.0f, (juce::Decibels::gainToDecibels(amplitude, -60.0f) + 60.0f) / 60.0f);
+    }
+
+    void follow(float &envelope, float target, float attack, float release) noexcept
+    {
+        envelope += (target > envelope ? attack : release) * (target - envelope);
+    }
+} // namespace
+
+//==============================================================================
+void AudioAnalyser::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+    mono.assign((size_t)juce::jmax(SUB_BLOCK_SIZE, maximumBlockSize), 0.0f);
+
+    for (size_t lane = 0; lane < crossoverCoefficients.size(); ++lane)
+    {
+        auto frequency = lane < crossoverFrequencies.size() ? crossoverFrequencies[lane] : crossoverFrequencies.back();
+        crossoverCoefficients[lane] = (float)(1.0 - std::exp(-juce::MathConstants<double>::twoPi * frequency / sampleRate));
+    }
+
+    auto subBlockSeconds = SUB_BLOCK_SIZE / sampleRate;
+    attackCoefficient = getOnePoleCoefficient(0.005, subBlockSeconds);
+    releaseCoefficient = getOnePoleCoefficient(0.150, subBlockSeconds);
+    fluxMeanCoefficient = getOnePoleCoefficient(0.5, subBlockSeconds);
+    onsetDecay = 1.0f - getOnePoleCoefficient(0.120, subBlockSeconds);
+    refractorySubBlocks = juce::roundToInt(0.080 / subBlockSeconds);
+
+    reset();
+}
+
+void AudioAnalyser::reset() noexcept
+{
+    stage1.fill(0.0f);
+    stage2.fill(0.0f);
+    levelEnvelope = 0.0f;
+    bandEnvelopes.fill(0.0f);
+    previousBandLogs.fill(0.0f);
+    fluxMean = 0.0f;
+    onsetPulse = 0.0f;
+    subBlocksSinceOnset = refractorySubBlocks;
+
+    for (auto &value : values)
+        value.store(0.0f, std::memory_order_relaxed);
+}
+
+//==============================================================================
+void AudioAnalyser::process(const juce::AudioBuffer<float> &buffer) noexcept
+{
+    using FVO = juce::FloatVectorOperations;
+
+    auto numChannels = buffer.getNumChannels();
+    auto numSamples = juce::jmin(buffer.getNumSamples(), (int)mono.size());
+    if (numChannels == 0 || numSamples == 0)
+        return;
+
+    // Fold to mono
+    FVO::copy(mono.data(), buffer.getReadPointer(0), numSamples);
+    for (int channel = 1; channel < numChannels; ++channel)
+        FVO::add(mono.data(), buffer.getReadPointer(channel), numSamples);
+    if (numChannels > 1)
+        FVO::multiply(mono.data(), 1.0f / (float)numChannels, numSamples);
+
+    for (int start = 0; start < numSamples; start += SUB_BLOCK_SIZE)
+        processSubBlock(mono.data() + start, juce::jmin(SUB_BLOCK_SIZE, numSamples - start));
+
+    values[level].store(normaliseLevel(levelEnvelope), std::memory_order_relaxed);
+    for (int band = 0; band < NUM_BANDS; ++band)
+        values[(size_t)(low + band)].store(normaliseLevel(bandEnvelopes[(size_t)band]), std::memory_order_relaxed);
+    values[onset].store(onsetPulse, std::memory_order_relaxed);
+}
+
+void AudioAnalyser::processSubBlock(const float *samples, int numSamples) noexcept
+{
+    // Peak envelope for the overall level
+    auto range = juce::FloatVectorOperations::findMinAndMax(samples, numSamples);
+    follow(levelEnvelope, juce::jmax(-range.getStart(), range.getEnd()), attackCoefficient, releaseCoefficient);
+
+    // Filterbank: crossover lanes advance together, bands are their differences
+    std::array<float, NUM_BANDS> energies{};
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto x = samples[i];
+        for (size_t lane = 0; lane < NUM_LANES; ++lane)
+        {
+            stage1[lane] += crossoverCoefficients[lane] * (x - stage1[lane]);
+            stage2[lane] += crossoverCoefficients[lane] * (stage1[lane] - stage2[lane]);
+        }
+
+        std::array<float, NUM_BANDS> bands{stage2[0], stage2[1] - stage2[0], stage2[2] - stage2[1], x - stage2[2]};
+        for (size_t band = 0; band < NUM_BANDS; ++band)
+            energies[band] += bands[band] * bands[band];
+    }
+
+    // Band envelopes and the positive log-flux between sub-blocks
+    auto flux = 0.0f;
+    for (size_t band = 0; band < NUM_BANDS; ++band)
+    {
+        auto rms = std::sqrt(energies[band] / (float)numSamples);
+        follow(bandEnvelopes[band], rms, attackCoefficient, releaseCoefficient);
+
+        auto bandLog = std::log1p(100.0f * rms);
+        flux += juce::jmax(0.0f, bandLog - previousBandLogs[band]);
+        previousBandLogs[band] = bandLog;
+    }
+
+    onsetPulse *= onsetDecay;
+    ++subBlocksSinceOnset;
+
+    if (flux > 1.5f * fluxMean + 0.05f && subBlocksSinceOnset >= refractorySubBlocks)
+    {
+        onsetPulse = 1.0f;
+        subBlocksSinceOnset = 0;
+        numOnsets.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    fluxMean += fluxMeanCoefficient * (flux - fluxMean);
+}
+
+//==============================================================================
+int AudioAnalyser::getSourceFromName(const juce::String &name)
+{
+    if (name == "level")
+        return level;
+    if (name == "low")
+        return low;
+    if (name == "lowMid")
+        return lowMid;
+    if (name == "highMid")
+        return highMid;
+    if (name == "high")
+        return high;
+    if (name == "onset")
+        return onset;
+
+    return -1;
+}
+
+size_t AudioAnalyser::getMemoryUsage() const
+{
+    return MemoryFootprint::getHeapBytes(mono);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+//==============================================================================
+/**
+ * Block-rate analysis of the host audio for audio-reactive modulation.
+ *
+ * The input is folded to mono and analysed in sub-blocks of SUB_BLOCK_SIZE
+ * samples. Each sub-block advances:
+ * - a peak envelope follower for the overall level;
+ * - a four-band filterbank. It is built from cascaded one-pole low-passes
+ *   at three crossovers, and the bands are their differences. The crossover
+ *   states are updated together as lanes of one small array, so the inner
+ *   loop vectorises. Each band gets its own RMS envelope.
+ * - an onset detector: positive band flux on a log scale against an
+ *   adaptive threshold, with a refractory period. It produces a decaying
+ *   pulse.
+ *
+ * Every source is normalised to 0-1 (levels over a 60 dB range). Values
+ * reflect the end of the current block, so modulation follows the audio
+ * with less than a block of delay. process() is allocation-free; values
+ * can be read from any thread.
+ */
+class AudioAnalyser
+{
+public:
+    enum Source
+    {
+        level,
+        low,     // below 150 Hz
+        lowMid,  // 150-600 Hz
+        highMid, // 600 Hz-3 kHz
+        high,    // above 3 kHz
+        onset,   // 1 at a detected onset, decaying
+        numSources
+    };
+
+    static constexpr int NUM_BANDS = 4;
+    static constexpr int SUB_BLOCK_SIZE = 64;
+
+    AudioAnalyser() = default;
+
+    void prepare(double sampleRate, int maximumBlockSize);
+    void reset() noexcept;
+
+    // Analyse one block of audio (audio thread)
+    void process(const juce::AudioBuffer<float> &buffer) noexcept;
+
+    float getValue(Source source) const noexcept { return values[(size_t)source].load(std::memory_order_relaxed); }
+    juce::uint32 getNumOnsets() const noexcept { return numOnsets.load(std::memory_order_relaxed); }
+
+    // Heap bytes held, not counting the object itself (message thread)
+    size_t getMemoryUsage() const;
+
+    // "level", "low", "lowMid", "highMid", "high" or "onset"; -1 if unknown
+    static int getSourceFromName(const juce::String &name);
+
+private:
+    void processSubBlock(const float *samples, int numSamples) noexcept;
+
+    static constexpr int NUM_CROSSOVERS = NUM_BANDS - 1;
+    static constexpr int NUM_LANES = 4; // crossovers padded to a full vector
+    static constexpr std::array<float, NUM_CROSSOVERS> crossoverFrequencies{150.0f, 600.0f, 3000.0f};
+
+    double sampleRate = 44100.0;
+    std::vector<float> mono;
+
+    // Crossover low-passes, two one-pole stages per lane
+    std::array<float, NUM_LANES> crossoverCoefficients{};
+    std::array<float, NUM_LANES> stage1{}, stage2{};
+
+    // Envelopes (linear amplitude) and their per-sub-block coefficients
+    float levelEnvelope = 0.0f;
+    std::array<float, NUM_BANDS> bandEnvelopes{};
+    float attackCoefficient = 0.0f;
+    float releaseCoefficient = 0.0f;
+
+    // Onset detection
+    std::array<float, NUM_BANDS> previousBandLogs{};
+    float fluxMean = 0.0f;
+    float fluxMeanCoefficient = 0.0f;
+    float onsetPulse = 0.0f;
+    float onsetDecay = 0.0f;
+    int subBlocksSinceOnset = 0;
+    int refractorySubBlocks = 0;
+
+    std::array<std::atomic<float>, numSources> values{};
+    std::atomic<juce::uint32> numOnsets{0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioAnalyser)
+};
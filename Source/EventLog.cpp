@@ -0,0 +1,308 @@
+#include "EventLog.h"
+#include <juce_events/juce_events.h>
+#include <algorithm>
+#include <cstring>
+
+#if JUCE_DEBUG
+std::atomic<int> EventLog::minimumLevel{(int)EventLog::Level::debug};
+#else
+std::atomic<int> EventLog::minimumLevel{(int)EventLog::Level::info};
+#endif
+
+//==============================================================================
+EventLog::EventLog()
+    : juce::Thread("EventLog"),
+      originTicks(juce::Time::getHighResolutionTicks()),
+      originMillis(juce::Time::currentTimeMillis())
+{
+    // Allocated once for the life of the process, so a thread's first line never allocates
+    auto &state = getState();
+    const juce::ScopedLock lock(state.lock);
+    if (!state.allocated.load())
+    {
+        for (auto &ring : state.rings)
+            ring.records.allocate((size_t)RECORDS_PER_THREAD, true);
+        state.allocated.store(true, std::memory_order_release);
+    }
+}
+
+EventLog::~EventLog()
+{
+    stopThread(2000);
+}
+
+void EventLog::start()
+{
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::background);
+}
+
+//==============================================================================
+void EventLog::setLevel(Level newLevel) noexcept
+{
+    minimumLevel.store((int)newLevel, std::memory_order_relaxed);
+}
+
+const char *EventLog::getLevelName(Level level)
+{
+    switch (level)
+    {
+    case Level::debug:
+        return "debug";
+    case Level::info:
+        return "info";
+    case Level::warning:
+        return "warning";
+    case Level::error:
+        return "error";
+    }
+
+    return "";
+}
+
+//==============================================================================
+EventLog::State &EventLog::getState()
+{
+    static State state;
+    return state;
+}
+
+void EventLog::nameCurrentThread(const char *name) noexcept
+{
+    getRingForCurrentThread(name);
+}
+
+EventLog::ThreadRing *EventLog::getRingForCurrentThread(const char *name) noexcept
+{
+    // Handed back when the thread exits, so short-lived threads don't use the rings up
+    struct Claim
+    {
+        ThreadRing *ring = nullptr;
+        bool attempted = false;
+
+        ~Claim()
+        {
+            if (ring != nullptr)
+                ring->claimed.store(false, std::memory_order_release);
+        }
+    };
+
+    static thread_local Claim claim;
+    if (claim.attempted)
+        return claim.ring;
+
+    auto &state = getState();
+    if (!state.allocated.load(std::memory_order_acquire))
+        return nullptr; // Nothing to log into until the first EventLog exists
+
+    claim.attempted = true;
+    for (auto &ring : state.rings)
+    {
+        auto expected = false;
+        if (ring.claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        {
+            claim.ring = &ring;
+            break;
+        }
+    }
+
+    if (claim.ring != nullptr)
+    {
+        // Named once, here; the formatter reads the name from then on
+        if (name != nullptr)
+        {
+            std::strncpy(claim.ring->threadName, name, sizeof(claim.ring->threadName) - 1);
+        }
+        else if (auto *thread = juce::Thread::getCurrentThread())
+        {
+            std::strncpy(claim.ring->threadName, thread->getThreadName().toRawUTF8(), sizeof(claim.ring->threadName) - 1);
+        }
+        else
+        {
+            name = juce::MessageManager::existsAndIsCurrentThread() ? "Message thread" : "Thread";
+            std::strncpy(claim.ring->threadName, name, sizeof(claim.ring->threadName) - 1);
+        }
+    }
+
+    return claim.ring;
+}
+
+EventLog::Record *EventLog::beginRecord(Level level, const char *format) noexcept
+{
+    auto &state = getState();
+    auto *ring = getRingForCurrentThread();
+    if (ring == nullptr)
+    {
+        state.numDropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    auto writePosition = ring->writePosition.load(std::memory_order_relaxed);
+    if (writePosition - ring->readPosition.load(std::memory_order_acquire) >= (juce::uint32)RECORDS_PER_THREAD)
+    {
+        state.numDropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    auto &record = ring->records[writePosition % (juce::uint32)RECORDS_PER_THREAD];
+    record.format = format;
+    record.ticks = juce::Time::getHighResolutionTicks();
+    record.level = level;
+    record.numArguments = 0;
+    record.textUsed = 0;
+    return &record;
+}
+
+void EventLog::endRecord() noexcept
+{
+    auto *ring = getRingForCurrentThread();
+    ring->writePosition.store(ring->writePosition.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void EventLog::addArgument(Record &record, const char *text) noexcept
+{
+    auto &argument = record.arguments[record.numArguments++];
+    argument.type = Argument::Type::text;
+    argument.textOffset = record.textUsed;
+
+    auto length = text != nullptr ? std::strlen(text) : 0;
+    auto space = (size_t)(TEXT_BYTES - record.textUsed);
+    if (length > space)
+    {
+        // Cut on a character boundary, so the text stays valid UTF-8
+        length = space;
+        while (length > 0 && (text[length] & 0xc0) == 0x80)
+            --length;
+    }
+
+    std::memcpy(record.text + record.textUsed, text, length);
+    argument.textLength = (juce::uint8)length;
+    record.textUsed = (juce::uint8)(record.textUsed + length);
+}
+
+//==============================================================================
+void EventLog::run()
+{
+    while (!threadShouldExit())
+    {
+        formatPendingRecords();
+        wait(FORMAT_INTERVAL_MS);
+    }
+
+    formatPendingRecords();
+}
+
+void EventLog::formatPendingRecords()
+{
+    auto &state = getState();
+    pending.clear();
+
+    for (auto &ring : state.rings)
+    {
+        auto readPosition = ring.readPosition.load(std::memory_order_relaxed);
+        auto writePosition = ring.writePosition.load(std::memory_order_acquire);
+        if (readPosition == writePosition)
+            continue;
+
+        juce::String threadName(ring.threadName);
+        for (; readPosition != writePosition; ++readPosition)
+        {
+            const auto &record = ring.records[readPosition % (juce::uint32)RECORDS_PER_THREAD];
+
+            Line line;
+            line.index = record.ticks; // sort key until the line is numbered
+            line.time = juce::Time(originMillis + (juce::int64)(juce::Time::highResolutionTicksToSeconds(record.ticks - originTicks) * 1000.0));
+            line.level = record.level;
+            line.threadName = threadName;
+            line.text = formatRecord(record);
+            pending.push_back(std::move(line));
+        }
+
+        ring.readPosition.store(readPosition, std::memory_order_release);
+    }
+
+    if (pending.empty())
+        return;
+
+    // Each ring is in order already; merge the threads by time
+    std::stable_sort(pending.begin(), pending.end(), [](const Line &a, const Line &b)
+                     { return a.index < b.index; });
+
+#if JUCE_DEBUG
+    for (const auto &line : pending)
+        juce::Logger::outputDebugString("[" + juce::String(getLevelName(line.level)) + "] " + line.text);
+#endif
+
+    const juce::ScopedLock lock(historyLock);
+    for (auto &line : pending)
+    {
+        line.index = nextLineIndex++;
+        history.push_back(std::move(line));
+    }
+
+    while ((int)history.size() > HISTORY_LINES)
+        history.pop_front();
+}
+
+juce::String EventLog::formatRecord(const Record &record)
+{
+    juce::String text;
+    text.preallocateBytes(128);
+
+    int argumentIndex = 0;
+    auto *start = record.format;
+    for (auto *position = start; *position != 0; ++position)
+    {
+        if (position[0] != '{' || position[1] != '}' || argumentIndex >= record.numArguments)
+            continue;
+
+        text += juce::String(juce::CharPointer_UTF8(start), juce::CharPointer_UTF8(position));
+
+        const auto &argument = record.arguments[(size_t)argumentIndex++];
+        switch (argument.type)
+        {
+        case Argument::Type::integer:
+            text += juce::String(argument.integer);
+            break;
+        case Argument::Type::real:
+            text += juce::String(argument.real);
+            break;
+        case Argument::Type::text:
+        {
+            auto *argumentText = record.text + argument.textOffset;
+            text += juce::String(juce::CharPointer_UTF8(argumentText), juce::CharPointer_UTF8(argumentText + argument.textLength));
+            break;
+        }
+        }
+
+        start = ++position + 1;
+    }
+
+    return text + juce::String(juce::CharPointer_UTF8(start));
+}
+
+//==============================================================================
+std::vector<EventLog::Line> EventLog::getLinesAfter(juce::int64 index) const
+{
+    const juce::ScopedLock lock(historyLock);
+
+    auto first = std::upper_bound(history.begin(), history.end(), index, [](juce::int64 value, const Line &line)
+                                  { return value < line.index; });
+    return {first, history.end()};
+}
+
+juce::int64 EventLog::getNumDropped() const noexcept
+{
+    return getState().numDropped.load(std::memory_order_relaxed);
+}
+
+size_t EventLog::getMemoryUsage() const
+{
+    auto bytes = sizeof(State) + (size_t)MAX_THREADS * (size_t)RECORDS_PER_THREAD * sizeof(Record);
+
+    const juce::ScopedLock lock(historyLock);
+    for (const auto &line : history)
+        bytes += sizeof(Line) + line.text.getNumBytesAsUTF8() + 1;
+
+    return bytes;
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <type_traits>
+#include <vector>
+
+//==============================================================================
+/**
+ * Process-wide structured log for the paths DBG made expensive.
+ *
+ * A call site records its format string and raw arguments into a ring owned
+ * by the calling thread: no string is built, nothing allocates and no lock is
+ * taken, so it can stay on in release builds and on the audio thread. The
+ * format must be a string literal; its pointer is the line's identity until
+ * it is formatted. Placeholders are {} and are filled in order.
+ *
+ * The EventLog object every instance shares formats the records on a
+ * background thread, merges the threads in time order and keeps the latest
+ * lines for the editor's log view (and DBG output in debug builds). Lines
+ * below the level filter cost one relaxed load; lines that find their ring
+ * full are dropped and counted. String arguments share TEXT_BYTES per line
+ * and are cut to fit.
+ */
+class EventLog : private juce::Thread
+{
+public:
+    enum class Level : juce::uint8
+    {
+        debug,
+        info,
+        warning,
+        error
+    };
+
+    EventLog();
+    ~EventLog() override;
+
+    // Start formatting; records wait in their rings until then
+    void start();
+
+    //==============================================================================
+    static void setLevel(Level newLevel) noexcept;
+    static Level getLevel() noexcept { return (Level)minimumLevel.load(std::memory_order_relaxed); }
+    static bool isEnabled(Level level) noexcept { return (int)level >= minimumLevel.load(std::memory_order_relaxed); }
+    static const char *getLevelName(Level level);
+
+    // Claim the calling thread's ring under this name, if it has none yet. Threads we
+    // don't own (the host's audio thread) call this before logging, so claiming a ring
+    // there only copies the literal.
+    static void nameCurrentThread(const char *name) noexcept;
+
+    // Integers, floating point values, juce::Strings and C strings
+    template <typename... Args>
+    static void write(Level level, const char *format, const Args &...args) noexcept
+    {
+        static_assert(sizeof...(Args) <= MAX_ARGUMENTS, "Too many arguments for one log line");
+
+        if (!isEnabled(level))
+            return;
+
+        if (auto *record = beginRecord(level, format))
+        {
+            (addArgument(*record, args), ...);
+            endRecord();
+        }
+    }
+
+    //==============================================================================
+    struct Line
+    {
+        juce::int64 index = 0;
+        juce::Time time;
+        Level level = Level::info;
+        juce::String threadName;
+        juce::String text;
+    };
+
+    // Formatted lines after the given index, oldest first (the last HISTORY_LINES are kept)
+    std::vector<Line> getLinesAfter(juce::int64 index) const;
+
+    // Lines lost to full rings or to threads beyond MAX_THREADS
+    juce::int64 getNumDropped() const noexcept;
+
+    // The rings and the formatted history
+    size_t getMemoryUsage() const;
+
+    static constexpr int MAX_THREADS = 32;         // later threads go unlogged
+    static constexpr int RECORDS_PER_THREAD = 256; // about 54 KB per thread
+    static constexpr int MAX_ARGUMENTS = 6;
+    static constexpr int TEXT_BYTES = 96;
+    static constexpr int HISTORY_LINES = 1000;
+    static constexpr int FORMAT_INTERVAL_MS = 20;
+
+private:
+    struct Argument
+    {
+        enum class Type : juce::uint8
+        {
+            integer,
+            real,
+            text
+        };
+
+        Type type = Type::integer;
+        juce::uint8 textOffset = 0;
+        juce::uint8 textLength = 0;
+        union
+        {
+            juce::int64 integer;
+            double real;
+        };
+    };
+
+    struct Record
+    {
+        const char *format = nullptr;
+        juce::int64 ticks = 0;
+        Level level = Level::info;
+        juce::uint8 numArguments = 0;
+        juce::uint8 textUsed = 0;
+        std::array<Argument, MAX_ARGUMENTS> arguments;
+        char text[TEXT_BYTES];
+    };
+
+    // Written only by the thread that claimed it, read only by the formatter
+    struct ThreadRing
+    {
+        juce::HeapBlock<Record> records;
+        std::atomic<juce::uint32> writePosition{0};
+        std::atomic<juce::uint32> readPosition{0};
+        std::atomic<bool> claimed{false};
+        char threadName[64] = {};
+    };
+
+    struct State
+    {
+        std::array<ThreadRing, MAX_THREADS> rings;
+        std::atomic<bool> allocated{false};
+        std::atomic<juce::int64> numDropped{0};
+        juce::CriticalSection lock;
+    };
+
+    static State &getState();
+    static ThreadRing *getRingForCurrentThread(const char *name = nullptr) noexcept;
+    static Record *beginRecord(Level level, const char *format) noexcept;
+    static void endRecord() noexcept;
+
+    template <typename Value>
+    static std::enable_if_t<std::is_arithmetic_v<Value>> addArgument(Record &record, Value value) noexcept
+    {
+        auto &argument = record.arguments[record.numArguments++];
+        if constexpr (std::is_floating_point_v<Value>)
+        {
+            argument.type = Argument::Type::real;
+            argument.real = (double)value;
+        }
+        else
+        {
+            argument.type = Argument::Type::integer;
+            argument.integer = (juce::int64)value;
+        }
+    }
+
+    static void addArgument(Record &record, const char *text) noexcept;
+    static void addArgument(Record &record, const juce::String &text) noexcept { addArgument(record, text.toRawUTF8()); }
+
+    //==============================================================================
+    void run() override;
+    void formatPendingRecords();
+    static juce::String formatRecord(const Record &record);
+
+    juce::int64 originTicks;
+    juce::int64 originMillis;
+
+    mutable juce::CriticalSection historyLock;
+    std::deque<Line> history;
+    juce::int64 nextLineIndex = 1;
+    std::vector<Line> pending; // formatter thread only
+
+    static std::atomic<int> minimumLevel;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EventLog)
+};
+
+// Records a line if the level passes the filter, without evaluating the arguments otherwise
+#define KADMIUM_LOG(level, ...)                                               \
+    do                                                                        \
+    {                                                                         \
+        if (EventLog::isEnabled(EventLog::Level::level))                      \
+            EventLog::write(EventLog::Level::level, __VA_ARGS__);             \
+    } while (false)
@@ -0,0 +1,362 @@
+#include "FixtureProfile.h"
+#include <juce_graphics/juce_graphics.h>
+
+namespace
+{
+    using ChannelRole = FixtureProfile::ChannelRole;
+
+    ChannelRole getRoleFromCapability(const juce::var &capability)
+    {
+        auto type = capability.getProperty("type", "").toString();
+        if (type == "Intensity")
+            return ChannelRole::intensity;
+
+        if (type == "ColorIntensity")
+        {
+            auto colour = capability.getProperty("color", "").toString();
+            if (colour == "Red")
+                return ChannelRole::red;
+            if (colour == "Green")
+                return ChannelRole::green;
+            if (colour == "Blue")
+                return ChannelRole::blue;
+            if (colour == "White" || colour == "Warm White" || colour == "Cold White")
+                return ChannelRole::white;
+            if (colour == "Amber")
+                return ChannelRole::amber;
+            if (colour == "Cyan")
+                return ChannelRole::cyan;
+            if (colour == "Magenta")
+                return ChannelRole::magenta;
+            if (colour == "Yellow")
+                return ChannelRole::yellow;
+        }
+
+        return ChannelRole::other;
+    }
+
+    // Mixing rows over [r, g, b, white, amber, 1]
+    std::array<float, FixtureProfile::basisSize> getMixRow(ChannelRole role)
+    {
+        switch (role)
+        {
+        case ChannelRole::red:
+            return {1.0f, 0.0f, 0.0f, -1.0f, -1.0f, 0.0f};
+        case ChannelRole::green:
+            return {0.0f, 1.0f, 0.0f, -1.0f, -0.5f, 0.0f};
+        case ChannelRole::blue:
+            return {0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f};
+        case ChannelRole::white:
+            return {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f};
+        case ChannelRole::amber:
+            return {0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+        case ChannelRole::cyan:
+            return {-1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+        case ChannelRole::magenta:
+            return {0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+        case ChannelRole::yellow:
+            return {0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f};
+        case ChannelRole::intensity:
+        case ChannelRole::other:
+            break;
+        }
+
+        return {};
+    }
+
+    // "linear", "square", "inverseSquare", "sCurve" or an array of evenly spaced output points
+    juce::Result buildCurve(const juce::var &curveVar, std::array<float, FixtureProfile::curveSize> &curve)
+    {
+        for (size_t i = 0; i < curve.size(); ++i)
+        {
+            auto x = (float)i / (float)(curve.size() - 1);
+
+            if (auto *points = curveVar.getArray())
+            {
+                if (points->size() < 2)
+                    return juce::Result::fail("Curve needs at least two points");
+
+                auto position = x * (float)(points->size() - 1);
+                auto index = juce::jmin((int)position, points->size() - 2);
+                auto fraction = position - (float)index;
+                auto a = (float)points->getReference(index);
+                auto b = (float)points->getReference(index + 1);
+                curve[i] = juce::jlimit(0.0f, 1.0f, a + fraction * (b - a));
+                continue;
+            }
+
+            auto name = curveVar.toString();
+            if (name.isEmpty() || name == "linear")
+                curve[i] = x;
+            else if (name == "square")
+                curve[i] = x * x;
+            else if (name == "inverseSquare")
+                curve[i] = 1.0f - (1.0f - x) * (1.0f - x);
+            else if (name == "sCurve")
+                curve[i] = x * x * (3.0f - 2.0f * x);
+            else
+                return juce::Result::fail("Unknown curve: " + name);
+        }
+
+        return juce::Result::ok();
+    }
+
+    // Fully saturated RGB around the colour wheel, so rendering doesn't evaluate HSV per channel
+    constexpr int hueTableSize = 1024;
+
+    const std::array<std::array<float, 3>, hueTableSize> &getHueTable()
+    {
+        static const auto table = []
+        {
+            std::array<std::array<float, 3>, hueTableSize> entries{};
+            for (size_t i = 0; i < entries.size(); ++i)
+            {
+                auto colour = juce::Colour::fromHSV((float)i / (float)hueTableSize, 1.0f, 1.0f, 1.0f);
+                entries[i] = {colour.getFloatRed(), colour.getFloatGreen(), colour.getFloatBlue()};
+            }
+            return entries;
+        }();
+
+        return table;
+    }
+
+    constexpr juce::uint32 cacheMagic = 0x5046444b; // "KDFP"
+    constexpr int cacheVersion = 2; // 2: unknown modes fail rather than fall back to the first
+} // namespace
+
+//==============================================================================
+std::array<float, FixtureProfile::basisSize> FixtureProfile::getBasis(float red, float green, float blue) const noexcept
+{
+    auto white = hasWhiteEmitter ? juce::jmin(red, green, blue) : 0.0f;
+    auto amber = hasAmberEmitter ? juce::jmin(red - white, green - white) : 0.0f;
+    return {red, green, blue, white, amber, 1.0f};
+}
+
+void FixtureProfile::render(float hue, float saturation, float brightness, float *channelValues) const noexcept
+{
+    const auto &hueColour = getHueTable()[(size_t)(juce::roundToInt(hue * (float)hueTableSize) & (hueTableSize - 1))];
+
+    // Fixtures with a dimmer channel mix the colour at full level and dim separately
+    auto level = hasIntensityChannel ? 1.0f : brightness;
+    auto white = 1.0f - saturation;
+    auto basis = getBasis(level * (white + saturation * hueColour[0]),
+                          level * (white + saturation * hueColour[1]),
+                          level * (white + saturation * hueColour[2]));
+
+    for (size_t i = 0; i < channels.size(); ++i)
+    {
+        const auto &channel = channels[i];
+        auto value = 0.0f;
+
+        switch (channel.role)
+        {
+        case ChannelRole::intensity:
+            value = brightness;
+            break;
+        case ChannelRole::other:
+            channelValues[i] = channel.defaultValue;
+            continue;
+        default:
+            for (size_t j = 0; j < basis.size(); ++j)
+                value += channel.mix[j] * basis[j];
+            break;
+        }
+
+        channelValues[i] = channel.applyCurve(juce::jlimit(0.0f, 1.0f, value));
+    }
+}
+
+juce::Result FixtureProfile::parse(const juce::var &json, const juce::String &modeName, FixtureProfile &profile)
+{
+    if (!json.isObject())
+        return juce::Result::fail("Profile root must be an object");
+
+    profile = FixtureProfile();
+    profile.name = json.getProperty("name", "Unnamed").toString();
+
+    // Pick the requested mode, or the first one when none is named
+    auto *modes = json.getProperty("modes", juce::var()).getArray();
+    if (modes == nullptr || modes->isEmpty())
+        return juce::Result::fail("Profile " + profile.name + " has no modes");
+
+    const juce::var *mode = modeName.isEmpty() ? &modes->getReference(0) : nullptr;
+    for (const auto &candidate : *modes)
+    {
+        if (candidate.getProperty("name", "").toString() == modeName)
+            mode = &candidate;
+    }
+
+    if (mode == nullptr)
+        return juce::Result::fail("Profile " + profile.name + " has no mode " + modeName);
+
+    profile.mode = mode->getProperty("name", "").toString();
+
+    auto availableChannels = json.getProperty("availableChannels", juce::var());
+    auto *channelNames = mode->getProperty("channels", juce::var()).getArray();
+    if (channelNames == nullptr)
+        return juce::Result::fail("Mode " + profile.mode + " has no channels");
+
+    for (const auto &channelName : *channelNames)
+    {
+        // null entries are unused slots in the mode
+        Channel channel;
+        channel.name = channelName.toString();
+
+        auto definition = availableChannels.getProperty(channel.name, juce::var());
+        auto capability = definition.getProperty("capability", juce::var());
+        channel.role = getRoleFromCapability(capability);
+
+        // OFL defaults are DMX values (0-255)
+        channel.defaultValue = juce::jlimit(0.0f, 1.0f, (float)definition.getProperty("defaultValue", 0) / 255.0f);
+
+        auto result = buildCurve(definition.getProperty("curve", "linear"), channel.curve);
+        if (result.failed())
+            return juce::Result::fail("Channel " + channel.name + ": " + result.getErrorMessage());
+
+        // Calibration gain for the emitter, folded into its mixing row
+        auto gain = (float)definition.getProperty("gain", 1.0f);
+        channel.mix = getMixRow(channel.role);
+        for (auto &coefficient : channel.mix)
+            coefficient *= gain;
+
+        profile.hasIntensityChannel |= channel.role == ChannelRole::intensity;
+        profile.hasWhiteEmitter |= channel.role == ChannelRole::white;
+        profile.hasAmberEmitter |= channel.role == ChannelRole::amber;
+        profile.channels.push_back(std::move(channel));
+    }
+
+    getHueTable(); // built here rather than on the first render
+    return juce::Result::ok();
+}
+
+//==============================================================================
+void FixtureProfile::writeTo(juce::OutputStream &stream) const
+{
+    stream.writeInt((int)cacheMagic);
+    stream.writeInt(cacheVersion);
+    stream.writeString(name);
+    stream.writeString(mode);
+    stream.writeBool(hasIntensityChannel);
+    stream.writeBool(hasWhiteEmitter);
+    stream.writeBool(hasAmberEmitter);
+    stream.writeInt((int)channels.size());
+
+    for (const auto &channel : channels)
+    {
+        stream.writeString(channel.name);
+        stream.writeInt((int)channel.role);
+        stream.writeFloat(channel.defaultValue);
+        stream.write(channel.mix.data(), sizeof(channel.mix));
+        stream.write(channel.curve.data(), sizeof(channel.curve));
+    }
+}
+
+bool FixtureProfile::readFrom(juce::InputStream &stream)
+{
+    if ((juce::uint32)stream.readInt() != cacheMagic || stream.readInt() != cacheVersion)
+        return false;
+
+    name = stream.readString();
+    mode = stream.readString();
+    hasIntensityChannel = stream.readBool();
+    hasWhiteEmitter = stream.readBool();
+    hasAmberEmitter = stream.readBool();
+
+    auto numChannels = stream.readInt();
+    if (numChannels < 0 || numChannels > 512)
+        return false;
+
+    channels.resize((size_t)numChannels);
+    for (auto &channel : channels)
+    {
+        channel.name = stream.readString();
+        channel.role = (ChannelRole)juce::jlimit(0, (int)ChannelRole::other, stream.readInt());
+        channel.defaultValue = stream.readFloat();
+
+        if (stream.read(channel.mix.data(), (int)sizeof(channel.mix)) != (int)sizeof(channel.mix) ||
+            stream.read(channel.curve.data(), (int)sizeof(channel.curve)) != (int)sizeof(channel.curve))
+            return false;
+    }
+
+    getHueTable();
+    return true;
+}
+
+//==============================================================================
+FixtureProfileLibrary::FixtureProfileLibrary()
+    : FixtureProfileLibrary(juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory).getChildFile("KadmiumDMX/Profiles"),
+                            juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory).getChildFile("KadmiumDMX/ProfileCache"))
+{
+}
+
+FixtureProfileLibrary::FixtureProfileLibrary(const juce::File &profileDir, const juce::File &cacheDir)
+    : profileDirectory(profileDir), cacheDirectory(cacheDir)
+{
+}
+
+juce::int64 FixtureProfileLibrary::getSourceStamp(const juce::File &profileFile)
+{
+    return profileFile.getSize() ^ (profileFile.getLastModificationTime().toMilliseconds() << 20);
+}
+
+juce::File FixtureProfileLibrary::getCacheFile(const juce::File &profileFile, const juce::String &modeName) const
+{
+    auto key = (profileFile.getFullPathName() + "|" + modeName).hashCode64();
+    return cacheDirectory.getChildFile(juce::String::toHexString(key) + ".kdfp");
+}
+
+std::shared_ptr<const FixtureProfile> FixtureProfileLibrary::getProfile(const juce::String &profilePath, const juce::String &modeName,
+                                                                        juce::String &errorMessage)
+{
+    auto profileFile = juce::File::isAbsolutePath(profilePath) ? juce::File(profilePath) : profileDirectory.getChildFile(profilePath);
+    auto key = profileFile.getFullPathName() + "|" + modeName;
+
+    if (!profileFile.existsAsFile())
+    {
+        loadedProfiles.erase(key);
+        errorMessage = "Fixture profile not found: " + profileFile.getFullPathName();
+        return nullptr;
+    }
+
+    // Held from an earlier map, unless the file has been edited since
+    auto sourceStamp = getSourceStamp(profileFile);
+    auto loaded = loadedProfiles.find(key);
+    if (loaded != loadedProfiles.end() && loaded->second.sourceStamp == sourceStamp)
+        return loaded->second.profile;
+
+    auto profile = std::make_shared<FixtureProfile>();
+    auto cacheFile = getCacheFile(profileFile, modeName);
+
+    // Compiled copy from an earlier session, if the source hasn't changed since
+    if (auto cacheStream = cacheFile.createInputStream())
+    {
+        if (cacheStream->readInt64() == sourceStamp && profile->readFrom(*cacheStream))
+        {
+            loadedProfiles[key] = {sourceStamp, profile};
+            return profile;
+        }
+    }
+
+    auto result = FixtureProfile::parse(juce::JSON::parse(profileFile), modeName, *profile);
+    if (result.failed())
+    {
+        errorMessage = result.getErrorMessage();
+        return nullptr;
+    }
+
+    // Best effort: a missing cache only costs the parse next time
+    if (cacheDirectory.createDirectory().wasOk())
+    {
+        juce::FileOutputStream cacheStream(cacheFile);
+        if (cacheStream.openedOk())
+        {
+            cacheStream.setPosition(0);
+            cacheStream.truncate();
+            cacheStream.writeInt64(sourceStamp);
+            profile->writeTo(cacheStream);
+        }
+    }
+
+    loadedProfiles[key] = {sourceStamp, profile};
+    return profile;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <map>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/**
+ * A compiled fixture profile: the channel layout of one mode, with every
+ * channel's dimmer curve and colour mix precomputed when the profile loads.
+ *
+ * Colour channels take their value from a mixing row applied to the basis
+ * [r, g, b, white, amber, 1], where white and amber are the parts of the
+ * colour the fixture's white and amber emitters can take over (zero when the
+ * fixture has none). Rows are pre-scaled by the emitter's calibration gain,
+ * so rendering a channel is one dot product and one curve lookup.
+ */
+struct FixtureProfile
+{
+    enum class ChannelRole
+    {
+        intensity,
+        red,
+        green,
+        blue,
+        white,
+        amber,
+        cyan,
+        magenta,
+        yellow,
+        other
+    };
+
+    static constexpr int curveSize = 256;
+    static constexpr int basisSize = 6;
+
+    struct Channel
+    {
+        juce::String name;
+        ChannelRole role = ChannelRole::other;
+        float defaultValue = 0.0f;                // normalised, used by channels we don't drive
+        std::array<float, basisSize> mix{};       // colour channels: calibrated mixing row
+        std::array<float, curveSize> curve{};     // output = curve[input], both normalised
+
+        float applyCurve(float value) const noexcept
+        {
+            return curve[(size_t)juce::jlimit(0, curveSize - 1, juce::roundToInt(value * (float)(curveSize - 1)))];
+        }
+    };
+
+    juce::String name;
+    juce::String mode;
+    std::vector<Channel> channels;
+    bool hasIntensityChannel = false;
+    bool hasWhiteEmitter = false;
+    bool hasAmberEmitter = false;
+
+    // Mixing basis for a colour (components 0-1)
+    std::array<float, basisSize> getBasis(float red, float green, float blue) const noexcept;
+
+    // Normalised output of every channel for an HSV colour (all 0-1). channelValues
+    // must hold channels.size() values. Only table lookups, safe on the audio thread.
+    void render(float hue, float saturation, float brightness, float *channelValues) const noexcept;
+
+    // Parse an Open Fixture Library style profile and build its tables
+    static juce::Result parse(const juce::var &json, const juce::String &modeName, FixtureProfile &profile);
+
+    // Compiled form for the disk cache
+    void writeTo(juce::OutputStream &stream) const;
+    bool readFrom(juce::InputStream &stream);
+};
+
+//==============================================================================
+/**
+ * Loads fixture profiles on demand and keeps them compiled.
+ *
+ * Profiles are looked up relative to the profile directory. A compiled copy
+ * of every parsed profile is written to the cache directory, keyed by path,
+ * mode, size and modification time, so later sessions skip the JSON parse
+ * and the table builds. Profiles held in memory are checked against the same
+ * stamp on every lookup, so an edited file is picked up by the next map
+ * compile. A mode the profile doesn't have is an error; an empty mode name
+ * picks the first. Message thread only; the returned profiles are
+ * immutable and can be shared with the audio thread.
+ */
+class FixtureProfileLibrary
+{
+public:
+    FixtureProfileLibrary();
+    FixtureProfileLibrary(const juce::File &profileDirectory, const juce::File &cacheDirectory);
+
+    std::shared_ptr<const FixtureProfile> getProfile(const juce::String &profilePath, const juce::String &modeName,
+                                                     juce::String &errorMessage);
+
+    const juce::File &getProfileDirectory() const { return profileDirectory; }
+
+private:
+    juce::File getCacheFile(const juce::File &profileFile, const juce::String &modeName) const;
+    static juce::int64 getSourceStamp(const juce::File &profileFile);
+
+    juce::File profileDirectory;
+    juce::File cacheDirectory;
+
+    // Parsed profiles by path and mode, with the source stamp they were parsed from
+    struct LoadedProfile
+    {
+        juce::int64 sourceStamp = 0;
+        std::shared_ptr<const FixtureProfile> profile;
+    };
+    std::map<juce::String, LoadedProfile> loadedProfiles;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FixtureProfileLibrary)
+};
@@ -0,0 +1,46 @@
+#include "GroupColourSnapshot.h"
+
+//==============================================================================
+GroupColourSnapshot::GroupColourSnapshot()
+{
+    for (auto &colour : colours)
+        colour.store(0xff000000, std::memory_order_relaxed);
+
+    for (auto &version : versions)
+        version.store(0, std::memory_order_relaxed);
+}
+
+void GroupColourSnapshot::setNumGroups(int newNumGroups) noexcept
+{
+    numGroups.store(juce::jlimit(0, MAX_GROUPS, newNumGroups), std::memory_order_release);
+    sequence.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void GroupColourSnapshot::setColour(int groupIndex, juce::uint32 argb) noexcept
+{
+    if (groupIndex < 0 || groupIndex >= MAX_GROUPS)
+        return;
+
+    // Skip no-op writes so readers don't repaint unchanged groups
+    if (colours[(size_t)groupIndex].exchange(argb, std::memory_order_relaxed) == argb)
+        return;
+
+    versions[(size_t)groupIndex].fetch_add(1, std::memory_order_release);
+    sequence.fetch_add(1, std::memory_order_acq_rel);
+}
+
+juce::uint32 GroupColourSnapshot::getColour(int groupIndex) const noexcept
+{
+    if (groupIndex < 0 || groupIndex >= MAX_GROUPS)
+        return 0;
+
+    return colours[(size_t)groupIndex].load(std::memory_order_relaxed);
+}
+
+juce::uint32 GroupColourSnapshot::getVersion(int groupIndex) const noexcept
+{
+    if (groupIndex < 0 || groupIndex >= MAX_GROUPS)
+        return 0;
+
+    return versions[(size_t)groupIndex].load(std::memory_order_acquire);
+}
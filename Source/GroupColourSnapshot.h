@@ -0,0 +1,42 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/**
+ * Lock-free snapshot of the colour currently output for every group.
+ *
+ * The processor writes a packed ARGB colour per group (indexed by the group's
+ * position in the MIDI map) and bumps that group's version. Readers such as
+ * the rig visualiser poll the versions and only touch groups that changed.
+ * Storage is fixed-size so the snapshot never reallocates under a reader.
+ */
+class GroupColourSnapshot
+{
+public:
+    static constexpr int MAX_GROUPS = 4096;
+
+    GroupColourSnapshot();
+
+    // Writer side (any thread)
+    void setNumGroups(int numGroups) noexcept;
+    void setColour(int groupIndex, juce::uint32 argb) noexcept;
+
+    // Reader side (any thread)
+    int getNumGroups() const noexcept { return numGroups.load(std::memory_order_acquire); }
+    juce::uint32 getColour(int groupIndex) const noexcept;
+    juce::uint32 getVersion(int groupIndex) const noexcept;
+
+    // Bumped whenever any group changes or the group count changes
+    juce::uint32 getSequence() const noexcept { return sequence.load(std::memory_order_acquire); }
+
+private:
+    std::array<std::atomic<juce::uint32>, MAX_GROUPS> colours;
+    std::array<std::atomic<juce::uint32>, MAX_GROUPS> versions;
+    std::atomic<int> numGroups{0};
+    std::atomic<juce::uint32> sequence{0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GroupColourSnapshot)
+};
@@ -0,0 +1,716 @@
+#include "InputRecorder.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace
+{
+    // Frame of a record in the FIFO: type (uint8), payload size (uint32), ticks (int64)
+    constexpr size_t FRAME_HEADER_BYTES = 13;
+
+    // Play head fields present in a block record
+    enum PositionFlags : juce::uint8
+    {
+        hasPosition = 1,
+        hasTimeInSamples = 2,
+        hasPpqPosition = 4,
+        hasBpm = 8,
+        isPlaying = 16
+    };
+
+    int getVarintSize(juce::uint64 value)
+    {
+        int size = 1;
+        while (value >= 0x80)
+        {
+            value >>= 7;
+            ++size;
+        }
+        return size;
+    }
+
+    void appendVarint(std::vector<juce::uint8> &destination, juce::uint64 value)
+    {
+        while (value >= 0x80)
+        {
+            destination.push_back((juce::uint8)(value | 0x80));
+            value >>= 7;
+        }
+        destination.push_back((juce::uint8)value);
+    }
+
+    // Bounds-checked reads from a record; any overrun marks the reader failed
+    struct ByteReader
+    {
+        const juce::uint8 *data = nullptr;
+        size_t size = 0;
+        size_t position = 0;
+        bool failed = false;
+
+        size_t getRemaining() const { return size - position; }
+
+        bool read(void *destination, size_t numBytes)
+        {
+            if (failed || numBytes > getRemaining())
+            {
+                failed = true;
+                return false;
+            }
+
+            std::memcpy(destination, data + position, numBytes);
+            position += numBytes;
+            return true;
+        }
+
+        template <typename T>
+        T readValue()
+        {
+            T value{};
+            read(&value, sizeof(value));
+            return value;
+        }
+
+        juce::uint64 readVarint()
+        {
+            juce::uint64 value = 0;
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                auto byte = readValue<juce::uint8>();
+                if (failed)
+                    return 0;
+
+                value |= (juce::uint64)(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0)
+                    return value;
+            }
+
+            failed = true;
+            return 0;
+        }
+
+        juce::String readString()
+        {
+            auto length = (size_t)readVarint();
+            if (failed || length > getRemaining())
+            {
+                failed = true;
+                return {};
+            }
+
+            auto text = juce::String::fromUTF8((const char *)data + position, (int)length);
+            position += length;
+            return text;
+        }
+    };
+
+    bool decodeRecord(ByteReader &reader, InputTraceReader::Record &record)
+    {
+        using RecordType = InputRecorder::RecordType;
+
+        switch (record.type)
+        {
+        case RecordType::prepare:
+            record.sampleRate = reader.readValue<double>();
+            record.numSamples = reader.readValue<juce::int32>();
+            break;
+
+        case RecordType::midiMap:
+        case RecordType::selectGroup:
+            record.text = reader.readString();
+            break;
+
+        case RecordType::state:
+            record.data.replaceAll(reader.data, reader.size);
+            break;
+
+        case RecordType::parameter:
+            record.value = reader.readValue<float>();
+            record.text = reader.readString();
+            break;
+
+        case RecordType::mqttMessage:
+            record.text = reader.readString();
+            record.message = reader.readString();
+            break;
+
+        case RecordType::block:
+        {
+            record.numSamples = reader.readValue<juce::int32>();
+            auto flags = reader.readValue<juce::uint8>();
+
+            record.position = {};
+            if ((flags & hasPosition) != 0)
+            {
+                juce::AudioPlayHead::PositionInfo position;
+                if ((flags & hasTimeInSamples) != 0)
+                    position.setTimeInSamples(reader.readValue<juce::int64>());
+                if ((flags & hasPpqPosition) != 0)
+                    position.setPpqPosition(reader.readValue<double>());
+                if ((flags & hasBpm) != 0)
+                    position.setBpm(reader.readValue<double>());
+                position.setIsPlaying((flags & isPlaying) != 0);
+                record.position = position;
+            }
+
+            record.midi.clear();
+            auto numEvents = reader.readValue<juce::uint32>();
+            for (juce::uint32 i = 0; i < numEvents && !reader.failed; ++i)
+            {
+                auto samplePosition = (int)reader.readVarint();
+                auto numBytes = (size_t)reader.readVarint();
+                if (reader.failed || numBytes > reader.getRemaining())
+                    return false;
+
+                record.midi.addEvent(reader.data + reader.position, (int)numBytes, samplePosition);
+                reader.position += numBytes;
+            }
+            break;
+        }
+
+        default:
+            return false; // From a newer version; skipped
+        }
+
+        return !reader.failed;
+    }
+} // namespace
+
+//==============================================================================
+// Builds one framed record in a caller-owned buffer. Records that don't fit are
+// flagged and dropped rather than grown, so the audio thread never allocates.
+struct InputRecorder::RecordWriter
+{
+    RecordWriter(juce::uint8 *destination, size_t destinationSize, RecordType type)
+        : data(destination), capacity(destinationSize)
+    {
+        writeValue((juce::uint8)type);
+        writeValue((juce::uint32)0); // Payload size, set by push()
+        writeValue(juce::Time::getHighResolutionTicks());
+    }
+
+    bool write(const void *source, size_t numBytes)
+    {
+        if (overflowed || size + numBytes > capacity)
+        {
+            overflowed = true;
+            return false;
+        }
+
+        std::memcpy(data + size, source, numBytes);
+        size += numBytes;
+        return true;
+    }
+
+    template <typename T>
+    void writeValue(T value) { write(&value, sizeof(value)); }
+
+    void writeVarint(juce::uint64 value)
+    {
+        while (value >= 0x80)
+        {
+            writeValue((juce::uint8)(value | 0x80));
+            value >>= 7;
+        }
+        writeValue((juce::uint8)value);
+    }
+
+    void writeString(const juce::String &text)
+    {
+        auto numBytes = text.getNumBytesAsUTF8();
+        writeVarint(numBytes);
+        write(text.toRawUTF8(), numBytes);
+    }
+
+    juce::uint8 *data;
+    size_t capacity;
+    size_t size = 0;
+    bool overflowed = false;
+};
+
+//==============================================================================
+InputRecorder::InputRecorder() : juce::Thread("KadmiumDMX InputRecorder")
+{
+}
+
+InputRecorder::~InputRecorder()
+{
+    stop();
+}
+
+juce::Result InputRecorder::start(const juce::File &file, size_t capacityBytes)
+{
+    stop();
+
+    // Segment sizes are stored as int32
+    segmentBytes = juce::jlimit(MIN_SEGMENT_BYTES, (size_t)1 << 30, capacityBytes / NUM_SEGMENTS);
+
+    file.deleteFile();
+    stream = std::make_unique<juce::FileOutputStream>(file);
+    if (stream->failedToOpen())
+    {
+        auto error = stream->getStatus().getErrorMessage();
+        stream.reset();
+        return juce::Result::fail("Could not create " + file.getFullPathName() + ": " + error);
+    }
+
+    stream->write(FILE_MAGIC, 8);
+    stream->writeInt(FILE_VERSION);
+    stream->writeInt((int)segmentBytes);
+    stream->writeInt(NUM_SEGMENTS);
+    stream->writeRepeatedByte(0, (size_t)FILE_HEADER_BYTES - 20);
+    stream->flush();
+
+    if (fifoBuffer == nullptr)
+    {
+        fifoBuffer.allocate((size_t)FIFO_BYTES, false);
+        blockScratch.allocate((size_t)BLOCK_SCRATCH_BYTES, false);
+        drained.resize((size_t)FIFO_BYTES);
+    }
+
+    fifo.reset();
+    segmentIndex = -1;
+    segmentSequence = 0;
+    segmentUsed = segmentWritten = 0;
+    segmentLastMicros = lastMicros = 0;
+    pending.clear();
+    contextPrepare.reset();
+    contextMap.reset();
+    contextState.reset();
+    contextGroup.reset();
+    contextParameters.clear();
+    numDropped = 0;
+    startTicks = juce::Time::getHighResolutionTicks();
+
+    startThread(juce::Thread::Priority::background);
+
+    const juce::SpinLock::ScopedLockType lock(writeLock);
+    recording.store(true, std::memory_order_release);
+    return juce::Result::ok();
+}
+
+void InputRecorder::stop()
+{
+    {
+        // Once this is held no producer is mid-write, and none will start
+        const juce::SpinLock::ScopedLockType lock(writeLock);
+        recording.store(false, std::memory_order_release);
+    }
+
+    // The thread drains what is left before it exits
+    signalThreadShouldExit();
+    notify();
+    stopThread(5000);
+
+    stream.reset();
+}
+
+//==============================================================================
+void InputRecorder::recordPrepare(double sampleRate, int blockSize)
+{
+    if (!isRecording())
+        return;
+
+    std::array<juce::uint8, FRAME_HEADER_BYTES + 16> buffer;
+    RecordWriter writer(buffer.data(), buffer.size(), RecordType::prepare);
+    writer.writeValue(sampleRate);
+    writer.writeValue((juce::int32)blockSize);
+    push(writer);
+}
+
+void InputRecorder::recordMidiMap(const juce::String &json)
+{
+    recordText(RecordType::midiMap, json);
+}
+
+void InputRecorder::recordState(const juce::MemoryBlock &state)
+{
+    if (!isRecording())
+        return;
+
+    juce::HeapBlock<juce::uint8> buffer(FRAME_HEADER_BYTES + state.getSize());
+    RecordWriter writer(buffer.get(), FRAME_HEADER_BYTES + state.getSize(), RecordType::state);
+    writer.write(state.getData(), state.getSize());
+    push(writer);
+}
+
+void InputRecorder::recordSelectGroup(const juce::String &groupId)
+{
+    recordText(RecordType::selectGroup, groupId);
+}
+
+void InputRecorder::recordParameter(const juce::String &parameterID, float value)
+{
+    if (!isRecording())
+        return;
+
+    // Parameter IDs are short; longer ones are dropped rather than allocated for
+    std::array<juce::uint8, 256> buffer;
+    RecordWriter writer(buffer.data(), buffer.size(), RecordType::parameter);
+    writer.writeValue(value);
+    writer.writeString(parameterID);
+    push(writer);
+}
+
+void InputRecorder::recordMqttMessage(const juce::String &topic, const juce::String &payload)
+{
+    recordText(RecordType::mqttMessage, topic, payload);
+}
+
+void InputRecorder::recordBlock(int numSamples, const juce::Optional<juce::AudioPlayHead::PositionInfo> &position,
+                                const juce::MidiBuffer &midi)
+{
+    if (!isRecording())
+        return;
+
+    RecordWriter writer(blockScratch.get(), (size_t)BLOCK_SCRATCH_BYTES, RecordType::block);
+    writer.writeValue((juce::int32)numSamples);
+
+    if (position.hasValue())
+    {
+        auto flags = (juce::uint8)hasPosition;
+        auto timeInSamples = position->getTimeInSamples();
+        auto ppqPosition = position->getPpqPosition();
+        auto bpm = position->getBpm();
+
+        if (timeInSamples.hasValue())
+            flags |= hasTimeInSamples;
+        if (ppqPosition.hasValue())
+            flags |= hasPpqPosition;
+        if (bpm.hasValue())
+            flags |= hasBpm;
+        if (position->getIsPlaying())
+            flags |= isPlaying;
+
+        writer.writeValue(flags);
+        if (timeInSamples.hasValue())
+            writer.writeValue((juce::int64)*timeInSamples);
+        if (ppqPosition.hasValue())
+            writer.writeValue(*ppqPosition);
+        if (bpm.hasValue())
+            writer.writeValue(*bpm);
+    }
+    else
+    {
+        writer.writeValue((juce::uint8)0);
+    }
+
+    // Events that would overflow the scratch are cut, keeping the block itself
+    auto countOffset = writer.size;
+    writer.writeValue((juce::uint32)0);
+
+    juce::uint32 numEvents = 0;
+    for (const auto metadata : midi)
+    {
+        if (writer.size + 10 + (size_t)metadata.numBytes > writer.capacity)
+            break;
+
+        writer.writeVarint((juce::uint64)metadata.samplePosition);
+        writer.writeVarint((juce::uint64)metadata.numBytes);
+        writer.write(metadata.data, (size_t)metadata.numBytes);
+        ++numEvents;
+    }
+
+    std::memcpy(writer.data + countOffset, &numEvents, sizeof(numEvents));
+    push(writer);
+}
+
+void InputRecorder::recordText(RecordType type, const juce::String &first, const juce::String &second)
+{
+    if (!isRecording())
+        return;
+
+    auto capacity = FRAME_HEADER_BYTES + 20 + first.getNumBytesAsUTF8() + second.getNumBytesAsUTF8();
+    juce::HeapBlock<juce::uint8> buffer(capacity);
+    RecordWriter writer(buffer.get(), capacity, type);
+    writer.writeString(first);
+    if (type == RecordType::mqttMessage)
+        writer.writeString(second);
+    push(writer);
+}
+
+void InputRecorder::push(RecordWriter &writer)
+{
+    if (writer.overflowed)
+    {
+        ++numDropped;
+        return;
+    }
+
+    auto payloadSize = (juce::uint32)(writer.size - FRAME_HEADER_BYTES);
+    std::memcpy(writer.data + 1, &payloadSize, sizeof(payloadSize));
+
+    // The writer thread polls, so producers never have to wake it
+    const juce::SpinLock::ScopedLockType lock(writeLock);
+    if (!recording.load(std::memory_order_relaxed))
+        return;
+
+    if (fifo.getFreeSpace() < (int)writer.size)
+    {
+        ++numDropped;
+        return;
+    }
+
+    auto scope = fifo.write((int)writer.size);
+    std::memcpy(fifoBuffer + scope.startIndex1, writer.data, (size_t)scope.blockSize1);
+    if (scope.blockSize2 > 0)
+        std::memcpy(fifoBuffer + scope.startIndex2, writer.data + scope.blockSize1, (size_t)scope.blockSize2);
+}
+
+//==============================================================================
+void InputRecorder::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(FLUSH_INTERVAL_MS);
+        drain();
+    }
+
+    drain();
+}
+
+void InputRecorder::drain()
+{
+    auto numReady = fifo.getNumReady();
+    if (numReady > 0)
+    {
+        {
+            auto scope = fifo.read(numReady);
+            std::memcpy(drained.data(), fifoBuffer + scope.startIndex1, (size_t)scope.blockSize1);
+            if (scope.blockSize2 > 0)
+                std::memcpy(drained.data() + scope.blockSize1, fifoBuffer + scope.startIndex2, (size_t)scope.blockSize2);
+        }
+
+        // Producers write whole frames under the lock, so only whole frames are ready
+        for (size_t position = 0; position + FRAME_HEADER_BYTES <= (size_t)numReady;)
+        {
+            const auto *frame = drained.data() + position;
+            juce::uint32 payloadSize = 0;
+            juce::int64 ticks = 0;
+            std::memcpy(&payloadSize, frame + 1, sizeof(payloadSize));
+            std::memcpy(&ticks, frame + 5, sizeof(ticks));
+
+            // Producers on different threads can land slightly out of order; time never runs back
+            auto micros = (juce::int64)(juce::Time::highResolutionTicksToSeconds(ticks - startTicks) * 1.0e6);
+            lastMicros = juce::jmax(lastMicros, micros);
+
+            append((RecordType)frame[0], lastMicros, frame + FRAME_HEADER_BYTES, payloadSize);
+            position += FRAME_HEADER_BYTES + payloadSize;
+        }
+    }
+
+    writePending();
+}
+
+void InputRecorder::append(RecordType type, juce::int64 micros, const juce::uint8 *payload, size_t size)
+{
+    if (segmentIndex < 0 || !appendToSegment(type, micros, payload, size))
+    {
+        startSegment(micros);
+
+        if (!appendToSegment(type, micros, payload, size))
+            ++numDropped;
+    }
+
+    updateContext(type, payload, size);
+}
+
+bool InputRecorder::appendToSegment(RecordType type, juce::int64 micros, const juce::uint8 *payload, size_t size)
+{
+    auto delta = (juce::uint64)(micros - segmentLastMicros);
+    auto encodedSize = 1 + (size_t)getVarintSize(size) + (size_t)getVarintSize(delta) + size;
+    if (segmentUsed + encodedSize > segmentBytes - (size_t)SEGMENT_HEADER_BYTES)
+        return false;
+
+    pending.push_back((juce::uint8)type);
+    appendVarint(pending, size);
+    appendVarint(pending, delta);
+    pending.insert(pending.end(), payload, payload + size);
+
+    segmentUsed += encodedSize;
+    segmentLastMicros = micros;
+    return true;
+}
+
+void InputRecorder::startSegment(juce::int64 micros)
+{
+    writePending();
+
+    segmentIndex = (segmentIndex + 1) % NUM_SEGMENTS;
+    ++segmentSequence;
+    segmentUsed = segmentWritten = 0;
+    segmentLastMicros = 0; // The first record's time is absolute
+
+    // Claim the segment before anything is written to it
+    stream->setPosition(getSegmentOffset(segmentIndex));
+    stream->writeInt64(segmentSequence);
+    stream->writeInt(0);
+    stream->writeInt(0);
+
+    // Restate the context, so replays can start from this segment
+    auto restate = [&](RecordType type, const juce::MemoryBlock &payload)
+    {
+        if (!payload.isEmpty())
+            appendToSegment(type, micros, static_cast<const juce::uint8 *>(payload.getData()), payload.getSize());
+    };
+
+    restate(RecordType::prepare, contextPrepare);
+    restate(RecordType::midiMap, contextMap);
+    restate(RecordType::state, contextState);
+    restate(RecordType::selectGroup, contextGroup);
+    for (const auto &parameter : contextParameters)
+        restate(RecordType::parameter, parameter.second);
+}
+
+void InputRecorder::writePending()
+{
+    if (pending.empty() || stream == nullptr)
+        return;
+
+    auto offset = getSegmentOffset(segmentIndex);
+    stream->setPosition(offset + SEGMENT_HEADER_BYTES + (juce::int64)segmentWritten);
+    stream->write(pending.data(), pending.size());
+    segmentWritten += pending.size();
+    pending.clear();
+
+    // Bytes used go last, so a reader never sees a record that isn't fully written
+    stream->setPosition(offset + 8);
+    stream->writeInt((int)segmentWritten);
+    stream->flush();
+}
+
+void InputRecorder::updateContext(RecordType type, const juce::uint8 *payload, size_t size)
+{
+    switch (type)
+    {
+    case RecordType::prepare:
+        contextPrepare.replaceAll(payload, size);
+        break;
+
+    case RecordType::midiMap:
+        // A new map rebuilds the parameters at their defaults
+        contextMap.replaceAll(payload, size);
+        contextParameters.clear();
+        break;
+
+    case RecordType::state:
+        // Restoring state sets every parameter
+        contextState.replaceAll(payload, size);
+        contextParameters.clear();
+        break;
+
+    case RecordType::selectGroup:
+        contextGroup.replaceAll(payload, size);
+        break;
+
+    case RecordType::parameter:
+    {
+        ByteReader reader{payload, size};
+        reader.readValue<float>();
+        auto parameterID = reader.readString();
+        if (!reader.failed)
+            contextParameters[parameterID].replaceAll(payload, size);
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+juce::int64 InputRecorder::getSegmentOffset(int index) const
+{
+    return FILE_HEADER_BYTES + (juce::int64)index * (juce::int64)segmentBytes;
+}
+
+//==============================================================================
+juce::Result InputTraceReader::open(const juce::File &file)
+{
+    segments.clear();
+    rewind();
+
+    juce::MemoryBlock fileData;
+    if (!file.loadFileAsData(fileData))
+        return juce::Result::fail("Could not read " + file.getFullPathName());
+
+    if (fileData.getSize() < (size_t)InputRecorder::FILE_HEADER_BYTES || std::memcmp(fileData.getData(), InputRecorder::FILE_MAGIC, 8) != 0)
+        return juce::Result::fail(file.getFullPathName() + " is not an input trace");
+
+    juce::MemoryInputStream in(fileData, false);
+    in.setPosition(8);
+    auto version = in.readInt();
+    auto segmentBytes = (juce::int64)in.readInt();
+    auto numSegments = in.readInt();
+
+    if (version != InputRecorder::FILE_VERSION)
+        return juce::Result::fail("Unsupported trace version " + juce::String(version));
+
+    // Segments are written in sequence; unused ones (sequence 0) may lie past the end of the file
+    std::vector<std::pair<juce::int64, juce::MemoryBlock>> found;
+    for (int index = 0; index < numSegments; ++index)
+    {
+        auto offset = InputRecorder::FILE_HEADER_BYTES + index * segmentBytes;
+        if (offset + InputRecorder::SEGMENT_HEADER_BYTES > (juce::int64)fileData.getSize())
+            continue;
+
+        in.setPosition(offset);
+        auto sequence = in.readInt64();
+        auto used = (juce::int64)in.readInt();
+        auto dataOffset = offset + InputRecorder::SEGMENT_HEADER_BYTES;
+        used = juce::jmin(used, (juce::int64)fileData.getSize() - dataOffset);
+
+        if (sequence > 0 && used > 0)
+            found.push_back({sequence, juce::MemoryBlock(static_cast<const char *>(fileData.getData()) + dataOffset, (size_t)used)});
+    }
+
+    std::sort(found.begin(), found.end(), [](const auto &a, const auto &b)
+              { return a.first < b.first; });
+
+    for (auto &segment : found)
+        segments.push_back(std::move(segment.second));
+
+    return juce::Result::ok();
+}
+
+void InputTraceReader::rewind()
+{
+    segmentIndex = 0;
+    position = 0;
+    segmentMicros = 0;
+}
+
+bool InputTraceReader::readNext(Record &record)
+{
+    while (segmentIndex < segments.size())
+    {
+        const auto &segment = segments[segmentIndex];
+        if (position >= segment.getSize())
+        {
+            ++segmentIndex;
+            position = 0;
+            segmentMicros = 0;
+            continue;
+        }
+
+        ByteReader reader{static_cast<const juce::uint8 *>(segment.getData()) + position, segment.getSize() - position};
+        auto type = reader.readValue<juce::uint8>();
+        auto size = (size_t)reader.readVarint();
+        auto delta = (juce::int64)reader.readVarint();
+
+        if (reader.failed || size > reader.getRemaining())
+        {
+            position = segment.getSize(); // Torn tail; move to the next segment
+            continue;
+        }
+
+        ByteReader payload{reader.data + reader.position, size};
+        position += reader.position + size;
+        segmentMicros += delta;
+
+        record.type = (InputRecorder::RecordType)type;
+        record.timeSeconds = (double)segmentMicros / 1.0e6;
+        if (decodeRecord(payload, record))
+            return true;
+    }
+
+    return false;
+}
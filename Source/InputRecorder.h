@@ -0,0 +1,159 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <map>
+#include <vector>
+
+//==============================================================================
+/**
+ * Captures every input to a processor with its time, so a problem seen at a
+ * gig can be replayed, profiled and bisected from the trace (see InputReplay).
+ *
+ * Records are pushed from any thread into a byte FIFO (the audio thread's
+ * without allocating) and appended to a ring file by a background thread.
+ * The file holds a fixed number of equal segments, overwritten oldest first.
+ * Each segment starts by restating the context a replay needs: the playback
+ * settings, MIDI map, plugin state, selected group and the parameter values
+ * set since the last map load. A trace therefore replays from its oldest
+ * surviving segment. Audio is not captured; replays feed silence.
+ *
+ * A record on disk is its type byte, payload size and microseconds since the
+ * previous record in the segment (both varints), then the payload. Numbers
+ * in payloads are little-endian, as on every platform the plugin ships for.
+ */
+class InputRecorder : private juce::Thread
+{
+public:
+    enum class RecordType : juce::uint8
+    {
+        prepare = 1, // sampleRate (double), blockSize (int32)
+        midiMap,     // map JSON
+        state,       // getStateInformation() blob
+        selectGroup, // group ID
+        parameter,   // value in parameter units (float), parameter ID
+        mqttMessage, // topic, payload
+        block        // numSamples (int32), play head position, MIDI events
+    };
+
+    static constexpr size_t DEFAULT_CAPACITY_BYTES = 64 * 1024 * 1024;
+
+    InputRecorder();
+    ~InputRecorder() override;
+
+    // Start a new trace, replacing the file (message thread). The FIFO and
+    // writer thread are only created once something records.
+    juce::Result start(const juce::File &file, size_t capacityBytes = DEFAULT_CAPACITY_BYTES);
+    void stop();
+    bool isRecording() const { return recording.load(std::memory_order_acquire); }
+
+    // Recording (any thread unless noted; no-ops while stopped)
+    void recordPrepare(double sampleRate, int blockSize);
+    void recordMidiMap(const juce::String &json);
+    void recordState(const juce::MemoryBlock &state);
+    void recordSelectGroup(const juce::String &groupId);
+    void recordParameter(const juce::String &parameterID, float value); // allocation-free
+    void recordMqttMessage(const juce::String &topic, const juce::String &payload);
+
+    // The block's size, host position and incoming MIDI (audio thread, allocation-free)
+    void recordBlock(int numSamples, const juce::Optional<juce::AudioPlayHead::PositionInfo> &position,
+                     const juce::MidiBuffer &midi);
+
+    // Records lost to a full FIFO or too large for a segment
+    juce::int64 getNumDropped() const { return numDropped.load(); }
+
+    // File layout, shared with InputTraceReader
+    static constexpr const char *FILE_MAGIC = "KDMXTRC1";
+    static constexpr int FILE_VERSION = 1;
+    static constexpr int FILE_HEADER_BYTES = 32;
+    static constexpr int SEGMENT_HEADER_BYTES = 16; // sequence (int64, 0 = unused), bytes used (int32), reserved
+
+private:
+    struct RecordWriter;
+
+    void run() override;
+
+    // Producer side: frame the record and copy it into the FIFO
+    void push(RecordWriter &writer);
+    void recordText(RecordType type, const juce::String &first, const juce::String &second = {});
+
+    // Writer thread: drain the FIFO into the ring
+    void drain();
+    void append(RecordType type, juce::int64 micros, const juce::uint8 *payload, size_t size);
+    bool appendToSegment(RecordType type, juce::int64 micros, const juce::uint8 *payload, size_t size);
+    void startSegment(juce::int64 micros);
+    juce::int64 getSegmentOffset(int index) const;
+    void writePending();
+    void updateContext(RecordType type, const juce::uint8 *payload, size_t size);
+
+    static constexpr int NUM_SEGMENTS = 8;
+    static constexpr size_t MIN_SEGMENT_BYTES = 256 * 1024;
+    static constexpr int FIFO_BYTES = 1024 * 1024;
+    static constexpr int BLOCK_SCRATCH_BYTES = 16 * 1024; // MIDI beyond this is cut from the block's record
+    static constexpr int FLUSH_INTERVAL_MS = 50;
+
+    std::atomic<bool> recording{false};
+    std::atomic<juce::int64> numDropped{0};
+    juce::int64 startTicks = 0;
+
+    // Framed records: type (uint8), payload size (uint32), ticks (int64), payload
+    juce::SpinLock writeLock; // Producers only; the writer thread reads lock-free
+    juce::AbstractFifo fifo{FIFO_BYTES};
+    juce::HeapBlock<juce::uint8> fifoBuffer;
+    juce::HeapBlock<juce::uint8> blockScratch; // audio thread
+    std::vector<juce::uint8> drained;          // writer thread
+
+    // Ring file (writer thread)
+    std::unique_ptr<juce::FileOutputStream> stream;
+    size_t segmentBytes = MIN_SEGMENT_BYTES;
+    int segmentIndex = -1;
+    juce::int64 segmentSequence = 0;
+    size_t segmentUsed = 0;    // encoded bytes in the current segment
+    size_t segmentWritten = 0; // of which already in the file
+    juce::int64 segmentLastMicros = 0; // time of the segment's last record
+    juce::int64 lastMicros = 0;
+    std::vector<juce::uint8> pending;
+
+    // Latest context records, restated at the start of every segment
+    juce::MemoryBlock contextPrepare, contextMap, contextState, contextGroup;
+    std::map<juce::String, juce::MemoryBlock> contextParameters;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(InputRecorder)
+};
+
+//==============================================================================
+/**
+ * Reads an InputRecorder trace back in recorded order, oldest segment first.
+ */
+class InputTraceReader
+{
+public:
+    struct Record
+    {
+        InputRecorder::RecordType type = InputRecorder::RecordType::block;
+        double timeSeconds = 0.0; // since recording started
+        juce::String text;        // parameter or group ID, MQTT topic or map JSON
+        juce::String message;     // MQTT payload
+        juce::MemoryBlock data;   // plugin state
+        double sampleRate = 0.0;
+        int numSamples = 0; // block size for prepare records
+        float value = 0.0f;
+        juce::Optional<juce::AudioPlayHead::PositionInfo> position;
+        juce::MidiBuffer midi;
+    };
+
+    juce::Result open(const juce::File &file);
+
+    // Decode the next record into the given one, reusing its storage; false at the end
+    bool readNext(Record &record);
+
+    void rewind();
+    int getNumSegments() const { return (int)segments.size(); }
+
+private:
+    std::vector<juce::MemoryBlock> segments; // used bytes, oldest first
+    size_t segmentIndex = 0;
+    size_t position = 0;
+    juce::int64 segmentMicros = 0;
+};
@@ -0,0 +1,162 @@
+#include "LatencyMonitor.h"
+
+//==============================================================================
+// LatencyHistogram implementation
+
+int LatencyHistogram::getBucketIndex(juce::int64 micros) noexcept
+{
+    if (micros <= 0)
+        return 0;
+
+    micros = juce::jmin(micros, (juce::int64(1) << maxMagnitude) - 1);
+
+    // Values below the sub-bucket count get an exact bucket each
+    if (micros < subBucketCount)
+        return (int)micros;
+
+    auto magnitude = juce::findHighestSetBit((juce::uint32)micros);
+    auto subBucket = (int)((micros >> (magnitude - subBucketBits)) & (subBucketCount - 1));
+    return (magnitude - subBucketBits + 1) * subBucketCount + subBucket;
+}
+
+juce::int64 LatencyHistogram::getBucketUpperBound(int bucketIndex) noexcept
+{
+    if (bucketIndex < subBucketCount)
+        return bucketIndex;
+
+    auto magnitude = bucketIndex / subBucketCount + subBucketBits - 1;
+    auto subBucket = bucketIndex % subBucketCount;
+    auto shift = magnitude - subBucketBits;
+    auto lowerBound = juce::int64(subBucketCount + subBucket) << shift;
+    return lowerBound + (juce::int64(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(juce::int64 micros) noexcept
+{
+    micros = juce::jmax(juce::int64(0), micros);
+
+    buckets[(size_t)getBucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+
+    auto currentMax = maxMicros.load(std::memory_order_relaxed);
+    while (micros > currentMax && !maxMicros.compare_exchange_weak(currentMax, micros, std::memory_order_relaxed))
+    {
+    }
+}
+
+LatencyHistogram::Summary LatencyHistogram::getSummary() const
+{
+    // Take a copy of the buckets so the percentiles are self-consistent
+    std::array<juce::uint64, numBuckets> snapshot;
+    juce::uint64 total = 0;
+
+    for (size_t i = 0; i < snapshot.size(); ++i)
+    {
+        snapshot[i] = buckets[i].load(std::memory_order_relaxed);
+        total += snapshot[i];
+    }
+
+    Summary summary;
+    summary.count = total;
+
+    if (total == 0)
+        return summary;
+
+    auto maxValue = maxMicros.load(std::memory_order_relaxed);
+
+    auto percentile = [&](double fraction)
+    {
+        auto target = (juce::uint64)std::ceil((double)total * fraction);
+        juce::uint64 cumulative = 0;
+
+        for (int i = 0; i < numBuckets; ++i)
+        {
+            cumulative += snapshot[(size_t)i];
+            if (cumulative >= target)
+                return juce::jmin(getBucketUpperBound(i), maxValue);
+        }
+
+        return maxValue;
+    };
+
+    summary.p50Ms = (double)percentile(0.50) / 1000.0;
+    summary.p99Ms = (double)percentile(0.99) / 1000.0;
+    summary.maxMs = (double)maxValue / 1000.0;
+    return summary;
+}
+
+void LatencyHistogram::reset() noexcept
+{
+    for (auto &bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+
+    maxMicros.store(0, std::memory_order_relaxed);
+}
+
+//==============================================================================
+// LatencyMonitor implementation
+
+LatencyMonitor::LatencyMonitor()
+    : ticksPerMicrosecond((double)juce::Time::getHighResolutionTicksPerSecond() / 1000000.0)
+{
+}
+
+void LatencyMonitor::record(Stage stage, juce::int64 startTicks, juce::int64 endTicks) noexcept
+{
+    if (startTicks == 0 || stage == Stage::numStages)
+        return;
+
+    auto micros = (juce::int64)((double)(endTicks - startTicks) / ticksPerMicrosecond);
+    histograms[(size_t)stage].record(micros);
+}
+
+LatencyHistogram::Summary LatencyMonitor::getSummary(Stage stage) const
+{
+    jassert(stage != Stage::numStages);
+    return histograms[(size_t)stage].getSummary();
+}
+
+void LatencyMonitor::reset() noexcept
+{
+    for (auto &histogram : histograms)
+        histogram.reset();
+}
+
+juce::var LatencyMonitor::toVar() const
+{
+    auto *rootObject = new juce::DynamicObject();
+
+    for (int i = 0; i < (int)Stage::numStages; ++i)
+    {
+        auto stage = (Stage)i;
+        auto summary = getSummary(stage);
+
+        auto *stageObject = new juce::DynamicObject();
+        stageObject->setProperty("count", (juce::int64)summary.count);
+        stageObject->setProperty("p50Ms", summary.p50Ms);
+        stageObject->setProperty("p99Ms", summary.p99Ms);
+        stageObject->setProperty("maxMs", summary.maxMs);
+
+        rootObject->setProperty(getStageName(stage), juce::var(stageObject));
+    }
+
+    return juce::var(rootObject);
+}
+
+const char *LatencyMonitor::getStageName(Stage stage)
+{
+    switch (stage)
+    {
+    case Stage::parameterToMidiDrain:
+        return "parameterToMidiDrain";
+    case Stage::parameterToMqttSend:
+        return "parameterToMqttSend";
+    case Stage::mqttSendToDelivery:
+        return "mqttSendToDelivery";
+    case Stage::parameterToMqttDelivery:
+        return "parameterToMqttDelivery";
+    case Stage::numStages:
+        break;
+    }
+
+    return "unknown";
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/**
+ * Lock-free latency histogram.
+ *
+ * Samples are recorded in microseconds into log-linear buckets (8 sub-buckets
+ * per power of two, so every bucket is within 12.5% of its neighbours).
+ * Recording is a handful of relaxed atomic increments and is safe from any
+ * thread, including the audio thread. Percentiles are computed on read.
+ */
+class LatencyHistogram
+{
+public:
+    struct Summary
+    {
+        juce::uint64 count = 0;
+        double p50Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+    };
+
+    LatencyHistogram() = default;
+
+    // Record a single sample (microseconds)
+    void record(juce::int64 micros) noexcept;
+
+    // Aggregate the current buckets into percentiles
+    Summary getSummary() const;
+
+    // Clear all samples (not atomic with respect to concurrent writers)
+    void reset() noexcept;
+
+    // Bucket layout, exposed for the stats exporters
+    static constexpr int subBucketBits = 3;
+    static constexpr int subBucketCount = 1 << subBucketBits;
+    static constexpr int maxMagnitude = 27; // ~134 s
+    static constexpr int numBuckets = (maxMagnitude - 2) * subBucketCount;
+
+    static int getBucketIndex(juce::int64 micros) noexcept;
+    static juce::int64 getBucketUpperBound(int bucketIndex) noexcept;
+
+private:
+    std::array<std::atomic<juce::uint64>, numBuckets> buckets{};
+    std::atomic<juce::int64> maxMicros{0};
+
+    JUCE_DECLARE_NON_COPYABLE(LatencyHistogram)
+};
+
+//==============================================================================
+/**
+ * End-to-end latency tracking for the output path.
+ *
+ * Timestamps are taken with juce::Time::getHighResolutionTicks() at
+ * parameterChanged, at queue drain in processBlock, at MQTTAsync_sendMessage
+ * and at publish delivery, and each hop is folded into its own histogram.
+ */
+class LatencyMonitor
+{
+public:
+    enum class Stage
+    {
+        parameterToMidiDrain,    // parameterChanged -> CC leaves processBlock
+        parameterToMqttSend,     // parameterChanged -> MQTTAsync_sendMessage
+        mqttSendToDelivery,      // MQTTAsync_sendMessage -> delivery complete
+        parameterToMqttDelivery, // parameterChanged -> delivery complete
+        numStages
+    };
+
+    LatencyMonitor();
+
+    // Current timestamp in high resolution ticks
+    static juce::int64 now() noexcept { return juce::Time::getHighResolutionTicks(); }
+
+    // Record the interval between two tick timestamps (ignored if start is 0)
+    void record(Stage stage, juce::int64 startTicks, juce::int64 endTicks) noexcept;
+
+    // Percentiles for a single stage
+    LatencyHistogram::Summary getSummary(Stage stage) const;
+
+    // Clear all histograms
+    void reset() noexcept;
+
+    // JSON-friendly representation for the stats topic
+    juce::var toVar() const;
+
+    static const char *getStageName(Stage stage);
+
+private:
+    std::array<LatencyHistogram, (size_t)Stage::numStages> histograms;
+    double ticksPerMicrosecond;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LatencyMonitor)
+};
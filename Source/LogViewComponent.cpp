@@ -0,0 +1,123 @@
+#include "LogViewComponent.h"
+
+//==============================================================================
+LogViewComponent::LogViewComponent(EventLog &log)
+    : eventLog(log)
+{
+    // Item IDs are the level + 1
+    for (auto level : {EventLog::Level::debug, EventLog::Level::info, EventLog::Level::warning, EventLog::Level::error})
+        levelCombo.addItem(EventLog::getLevelName(level), (int)level + 1);
+
+    levelCombo.setSelectedId((int)EventLog::getLevel() + 1, juce::dontSendNotification);
+    levelCombo.onChange = [this]()
+    {
+        if (auto selectedId = levelCombo.getSelectedId(); selectedId > 0)
+            EventLog::setLevel((EventLog::Level)(selectedId - 1));
+    };
+    addAndMakeVisible(levelCombo);
+
+    droppedLabel.setFont(juce::FontOptions(12.0f));
+    droppedLabel.setJustificationType(juce::Justification::centredRight);
+    addAndMakeVisible(droppedLabel);
+
+    text.setMultiLine(true, false);
+    text.setReadOnly(true);
+    text.setCaretVisible(false);
+    text.setScrollbarsShown(true);
+    text.setFont(juce::FontOptions(juce::Font::getDefaultMonospacedFontName(), 11.0f, juce::Font::plain));
+    addAndMakeVisible(text);
+}
+
+LogViewComponent::~LogViewComponent()
+{
+    stopTimer();
+}
+
+//==============================================================================
+void LogViewComponent::paint(juce::Graphics &g)
+{
+    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+}
+
+void LogViewComponent::resized()
+{
+    auto bounds = getLocalBounds();
+    auto topRow = bounds.removeFromTop(24);
+    levelCombo.setBounds(topRow.removeFromLeft(100));
+    droppedLabel.setBounds(topRow);
+    bounds.removeFromTop(4);
+    text.setBounds(bounds);
+}
+
+void LogViewComponent::visibilityChanged()
+{
+    updateTimerState();
+}
+
+void LogViewComponent::parentHierarchyChanged()
+{
+    updateTimerState();
+}
+
+void LogViewComponent::updateTimerState()
+{
+    if (isShowing())
+    {
+        if (!isTimerRunning())
+        {
+            // Catch up on what was logged while we were hidden
+            appendNewLines();
+            startTimer(REFRESH_INTERVAL_MS);
+        }
+    }
+    else
+    {
+        stopTimer();
+    }
+}
+
+void LogViewComponent::timerCallback()
+{
+    appendNewLines();
+}
+
+//==============================================================================
+void LogViewComponent::appendNewLines()
+{
+    auto numDropped = eventLog.getNumDropped();
+    if (numDropped != lastNumDropped)
+    {
+        lastNumDropped = numDropped;
+        droppedLabel.setText(numDropped > 0 ? juce::String(numDropped) + " lines dropped" : juce::String(),
+                             juce::dontSendNotification);
+    }
+
+    auto lines = eventLog.getLinesAfter(lastLineIndex);
+    if (lines.empty())
+        return;
+
+    // Past the limit, start again from the latest lines rather than trimming the editor
+    if (numLinesShown + (int)lines.size() > MAX_LINES_SHOWN)
+    {
+        lines = eventLog.getLinesAfter(lines.back().index - MAX_LINES_SHOWN);
+        text.clear();
+        numLinesShown = 0;
+    }
+
+    lastLineIndex = lines.back().index;
+    numLinesShown += (int)lines.size();
+
+    juce::String newText;
+    for (const auto &line : lines)
+        newText << formatLine(line) << "\n";
+
+    text.moveCaretToEnd();
+    text.insertTextAtCaret(newText);
+}
+
+juce::String LogViewComponent::formatLine(const EventLog::Line &line)
+{
+    return line.time.formatted("%H:%M:%S.") + juce::String(line.time.getMilliseconds()).paddedLeft('0', 3)
+           + " " + juce::String(EventLog::getLevelName(line.level)).paddedRight(' ', 7)
+           + " [" + line.threadName + "] " + line.text;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "EventLog.h"
+
+//==============================================================================
+/**
+ * Live view of the shared EventLog, with the process-wide level filter.
+ *
+ * Polls the log's formatted history while showing and appends only the lines
+ * it hasn't shown yet, keeping the last MAX_LINES_SHOWN.
+ */
+class LogViewComponent : public juce::Component,
+                         private juce::Timer
+{
+public:
+    explicit LogViewComponent(EventLog &log);
+    ~LogViewComponent() override;
+
+    void paint(juce::Graphics &g) override;
+    void resized() override;
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
+
+private:
+    void timerCallback() override;
+    void updateTimerState();
+    void appendNewLines();
+    static juce::String formatLine(const EventLog::Line &line);
+
+    static constexpr int REFRESH_INTERVAL_MS = 100;
+    static constexpr int MAX_LINES_SHOWN = 500;
+
+    EventLog &eventLog;
+
+    juce::ComboBox levelCombo;
+    juce::Label droppedLabel;
+    juce::TextEditor text;
+
+    juce::int64 lastLineIndex = 0;
+    juce::int64 lastNumDropped = -1;
+    int numLinesShown = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LogViewComponent)
+};
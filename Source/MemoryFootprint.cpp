@@ -0,0 +1,91 @@
+#include "MemoryFootprint.h"
+
+//==============================================================================
+size_t MemoryFootprint::getInstanceTotal() const
+{
+    size_t total = 0;
+    for (auto bytes : subsystemBytes)
+        total += bytes;
+
+    return total;
+}
+
+juce::var MemoryFootprint::toVar() const
+{
+    auto *rootObject = new juce::DynamicObject();
+
+    auto *subsystemsObject = new juce::DynamicObject();
+    for (int i = 0; i < numSubsystems; ++i)
+        subsystemsObject->setProperty(getSubsystemName((Subsystem)i), (juce::int64)subsystemBytes[(size_t)i]);
+    rootObject->setProperty("instanceBytes", juce::var(subsystemsObject));
+    rootObject->setProperty("instanceTotal", (juce::int64)getInstanceTotal());
+
+    auto *sharedObject = new juce::DynamicObject();
+    for (int i = 0; i < numShared; ++i)
+        sharedObject->setProperty(getSharedName((Shared)i), (juce::int64)sharedBytes[(size_t)i]);
+    rootObject->setProperty("sharedBytes", juce::var(sharedObject));
+
+    return juce::var(rootObject);
+}
+
+const char *MemoryFootprint::getSubsystemName(Subsystem subsystem)
+{
+    switch (subsystem)
+    {
+    case Subsystem::instance:
+        return "instance";
+    case Subsystem::midiMap:
+        return "midiMap";
+    case Subsystem::parameters:
+        return "parameters";
+    case Subsystem::mergeEngine:
+        return "mergeEngine";
+    case Subsystem::outputStages:
+        return "outputStages";
+    case Subsystem::midiBuffers:
+        return "midiBuffers";
+    case Subsystem::scenes:
+        return "scenes";
+    case Subsystem::audioAnalyser:
+        return "audioAnalyser";
+    case Subsystem::pixelRenderer:
+        return "pixelRenderer";
+    case Subsystem::numSubsystems:
+        break;
+    }
+
+    return "unknown";
+}
+
+const char *MemoryFootprint::getSharedName(Shared shared)
+{
+    switch (shared)
+    {
+    case Shared::names:
+        return "names";
+    case Shared::outputHub:
+        return "outputHub";
+    case Shared::eventLog:
+        return "eventLog";
+    case Shared::numShared:
+        break;
+    }
+
+    return "unknown";
+}
+
+//==============================================================================
+size_t MemoryFootprint::getHeapBytes(const juce::String &text) noexcept
+{
+    // The shared empty string owns nothing
+    if (text.isEmpty())
+        return 0;
+
+    // Reference count and capacity ahead of the UTF-8 text and its terminator
+    return sizeof(int) + sizeof(size_t) + text.getNumBytesAsUTF8() + 1;
+}
+
+size_t MemoryFootprint::getHeapBytes(const juce::StringArray &strings) noexcept
+{
+    return (size_t)strings.strings.size() * sizeof(juce::String);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <vector>
+
+//==============================================================================
+/**
+ * Bytes held by one plugin instance, by subsystem, and by the process-wide
+ * state every instance shares.
+ *
+ * Heap sizes are container capacities, so they report what is reserved
+ * rather than what is in use. Fixed-size tables and FIFOs live inside the
+ * processor object and are counted once, under "instance". Strings taken from
+ * the shared NameTable are counted there, not by every instance holding them.
+ */
+struct MemoryFootprint
+{
+    enum class Subsystem
+    {
+        instance,      // The processor object: fixed-size input tables, queues and counters
+        midiMap,       // Compiled snapshot, including replaced ones not yet reclaimed
+        parameters,    // Definitions, the APVTS and its parameters
+        mergeEngine,   // Layers, output frame and scratch
+        outputStages,  // Modulation, smoothing, scheduling and per-cell output state
+        midiBuffers,   // Thru buffer
+        scenes,        // Stored scenes and the fader
+        audioAnalyser, // Analysis buffers
+        pixelRenderer, // Pixel engine and frames in flight
+        numSubsystems
+    };
+
+    enum class Shared
+    {
+        names,     // Interned names and topics
+        outputHub, // MQTT client, publish queue and subscriptions
+        eventLog,  // Per-thread log rings and the formatted history
+        numShared
+    };
+
+    static constexpr int numSubsystems = (int)Subsystem::numSubsystems;
+    static constexpr int numShared = (int)Shared::numShared;
+
+    std::array<size_t, numSubsystems> subsystemBytes{};
+    std::array<size_t, numShared> sharedBytes{};
+
+    size_t &operator[](Subsystem subsystem) { return subsystemBytes[(size_t)subsystem]; }
+    size_t &operator[](Shared shared) { return sharedBytes[(size_t)shared]; }
+    size_t get(Subsystem subsystem) const { return subsystemBytes[(size_t)subsystem]; }
+    size_t get(Shared shared) const { return sharedBytes[(size_t)shared]; }
+
+    // Everything one more instance would add, excluding the shared state
+    size_t getInstanceTotal() const;
+
+    // JSON-friendly representation for the metrics topic
+    juce::var toVar() const;
+
+    static const char *getSubsystemName(Subsystem subsystem);
+    static const char *getSharedName(Shared shared);
+
+    //==============================================================================
+    // Heap bytes of a container or string
+    template <typename ElementType>
+    static size_t getHeapBytes(const std::vector<ElementType> &vector) noexcept
+    {
+        return vector.capacity() * sizeof(ElementType);
+    }
+
+    static size_t getHeapBytes(const std::vector<bool> &vector) noexcept { return vector.capacity() / 8; }
+    static size_t getHeapBytes(const juce::String &text) noexcept;
+    static size_t getHeapBytes(const juce::StringArray &strings) noexcept; // the array only; the strings are shared
+};
@@ -0,0 +1,266 @@
+#include "MergeEngine.h"
+#include "MemoryFootprint.h"
+#include <algorithm>
+#include <numeric>
+
+//==============================================================================
+// MergeLayer implementation
+
+MergeLayer::MergeLayer(const juce::String &layerName, int layerPriority)
+    : name(layerName), priority(layerPriority)
+{
+}
+
+void MergeLayer::resize(int numCells)
+{
+    values.assign((size_t)numCells, 0.0f);
+    active.assign((size_t)numCells, 0.0f);
+    stamps.assign((size_t)numCells, 0);
+    ++changeCount;
+}
+
+void MergeLayer::set(int cell, float normalisedValue, juce::int64 ticks) noexcept
+{
+    if (cell < 0 || cell >= getNumCells())
+        return;
+
+    values[(size_t)cell] = juce::jlimit(0.0f, 1.0f, normalisedValue);
+    active[(size_t)cell] = 1.0f;
+    stamps[(size_t)cell] = juce::jmax(juce::int64(1), ticks); // 0 is reserved for released cells
+    ++changeCount;
+}
+
+void MergeLayer::release(int cell) noexcept
+{
+    if (cell < 0 || cell >= getNumCells() || active[(size_t)cell] == 0.0f)
+        return;
+
+    values[(size_t)cell] = 0.0f;
+    active[(size_t)cell] = 0.0f;
+    stamps[(size_t)cell] = 0;
+    ++changeCount;
+}
+
+void MergeLayer::releaseAll() noexcept
+{
+    std::fill(values.begin(), values.end(), 0.0f);
+    std::fill(active.begin(), active.end(), 0.0f);
+    std::fill(stamps.begin(), stamps.end(), 0);
+    ++changeCount;
+}
+
+void MergeLayer::setFrame(const float *newValues, const float *newActive, juce::int64 ticks) noexcept
+{
+    using FVO = juce::FloatVectorOperations;
+
+    auto numCells = getNumCells();
+
+    // Released cells hold 0 so HTP can take a plain max
+    FVO::multiply(values.data(), newValues, newActive, numCells);
+    FVO::clip(values.data(), values.data(), 0.0f, 1.0f, numCells);
+    FVO::copy(active.data(), newActive, numCells);
+
+    auto stamp = juce::jmax(juce::int64(1), ticks);
+    for (size_t cell = 0; cell < (size_t)numCells; ++cell)
+        stamps[cell] = active[cell] != 0.0f ? stamp : 0;
+
+    ++changeCount;
+}
+
+bool MergeLayer::isActive(int cell) const noexcept
+{
+    return cell >= 0 && cell < getNumCells() && active[(size_t)cell] != 0.0f;
+}
+
+float MergeLayer::getValue(int cell) const noexcept
+{
+    return isActive(cell) ? values[(size_t)cell] : 0.0f;
+}
+
+//==============================================================================
+// MergeEngine implementation
+
+int MergeEngine::addLayer(const juce::String &name, int priority)
+{
+    layers.push_back(std::make_unique<MergeLayer>(name, priority));
+    layers.back()->resize(getNumCells());
+    seenChangeCounts.push_back(0);
+    sortLayersByPriority();
+    dirty = true;
+    return (int)layers.size() - 1;
+}
+
+void MergeEngine::setLayerPriority(int layerIndex, int priority)
+{
+    if (layerIndex < 0 || layerIndex >= getNumLayers())
+        return;
+
+    layers[(size_t)layerIndex]->priority = priority;
+    sortLayersByPriority();
+    dirty = true;
+}
+
+void MergeEngine::sortLayersByPriority()
+{
+    bandOrder.resize(layers.size());
+    std::iota(bandOrder.begin(), bandOrder.end(), 0);
+    std::stable_sort(bandOrder.begin(), bandOrder.end(), [this](int a, int b)
+                     { return layers[(size_t)a]->priority > layers[(size_t)b]->priority; });
+}
+
+void MergeEngine::prepare(int newNumGroups, int newNumAttributes, bool keepLayerValues)
+{
+    keepLayerValues = keepLayerValues && newNumGroups == numGroups && newNumAttributes == numAttributes;
+    numGroups = juce::jmax(0, newNumGroups);
+    numAttributes = juce::jmax(0, newNumAttributes);
+
+    auto numCells = (size_t)getNumCells();
+
+    // Cells change meaning with the layout, so every source starts released
+    if (!keepLayerValues)
+        for (auto &layer : layers)
+            layer->resize((int)numCells);
+
+    attributeModes.resize((size_t)numAttributes, MergeMode::ltp);
+    htpMask.assign(numCells, 0.0f);
+    for (int attribute = 0; attribute < numAttributes; ++attribute)
+        setAttributeMode(attribute, attributeModes[(size_t)attribute]);
+
+    output.assign(numCells, 0.0f);
+    outputActive.assign(numCells, 0.0f);
+    outputStamps.assign(numCells, 0);
+
+    remaining.assign(numCells, 0.0f);
+    bandHtp.assign(numCells, 0.0f);
+    bandLtp.assign(numCells, 0.0f);
+    bandActive.assign(numCells, 0.0f);
+    bandStamps.assign(numCells, 0);
+    take.assign(numCells, 0.0f);
+    scratch.assign(numCells, 0.0f);
+
+    dirty = true;
+}
+
+void MergeEngine::setAttributeMode(int attributeIndex, MergeMode mode)
+{
+    if (attributeIndex < 0 || attributeIndex >= numAttributes)
+        return;
+
+    attributeModes[(size_t)attributeIndex] = mode;
+
+    auto maskValue = mode == MergeMode::htp ? 1.0f : 0.0f;
+    for (int group = 0; group < numGroups; ++group)
+        htpMask[(size_t)getCellIndex(group, attributeIndex)] = maskValue;
+
+    dirty = true;
+}
+
+MergeMode MergeEngine::getAttributeMode(int attributeIndex) const
+{
+    if (attributeIndex < 0 || attributeIndex >= numAttributes)
+        return MergeMode::ltp;
+
+    return attributeModes[(size_t)attributeIndex];
+}
+
+//==============================================================================
+bool MergeEngine::process() noexcept
+{
+    using FVO = juce::FloatVectorOperations;
+
+    auto numCells = getNumCells();
+    if (numCells == 0)
+        return false;
+
+    // Skip the merge when nothing has been written since the last frame
+    auto changed = dirty;
+    for (size_t i = 0; i < layers.size(); ++i)
+    {
+        if (layers[i]->changeCount != seenChangeCounts[i])
+        {
+            seenChangeCounts[i] = layers[i]->changeCount;
+            changed = true;
+        }
+    }
+
+    if (!changed)
+        return false;
+
+    dirty = false;
+
+    FVO::fill(remaining.data(), 1.0f, numCells);
+    FVO::clear(output.data(), numCells);
+    FVO::clear(outputActive.data(), numCells);
+    std::fill(outputStamps.begin(), outputStamps.end(), 0);
+
+    size_t next = 0;
+    while (next < bandOrder.size())
+    {
+        auto bandPriority = layers[(size_t)bandOrder[next]]->priority;
+
+        FVO::clear(bandHtp.data(), numCells);
+        FVO::clear(bandLtp.data(), numCells);
+        FVO::clear(bandActive.data(), numCells);
+        std::fill(bandStamps.begin(), bandStamps.end(), 0);
+
+        // Fold every layer of this priority into the band
+        for (; next < bandOrder.size() && layers[(size_t)bandOrder[next]]->priority == bandPriority; ++next)
+        {
+            const auto &layer = *layers[(size_t)bandOrder[next]];
+
+            // Released cells hold 0, so they never win the maximum
+            FVO::max(bandHtp.data(), bandHtp.data(), layer.values.data(), numCells);
+            FVO::max(bandActive.data(), bandActive.data(), layer.active.data(), numCells);
+
+            // Released cells have stamp 0, so they never count as the latest
+            for (size_t cell = 0; cell < (size_t)numCells; ++cell)
+            {
+                if (layer.stamps[cell] > bandStamps[cell])
+                {
+                    bandStamps[cell] = layer.stamps[cell];
+                    bandLtp[cell] = layer.values[cell];
+                }
+            }
+        }
+
+        // Band value per cell: ltp + htpMask * (htp - ltp)
+        FVO::subtract(scratch.data(), bandHtp.data(), bandLtp.data(), numCells);
+        FVO::multiply(scratch.data(), htpMask.data(), numCells);
+        FVO::add(scratch.data(), bandLtp.data(), numCells);
+
+        // The band only takes cells that no higher band holds
+        FVO::multiply(take.data(), remaining.data(), bandActive.data(), numCells);
+
+        // output += take * (bandValue - output)
+        FVO::subtract(scratch.data(), output.data(), numCells);
+        FVO::multiply(scratch.data(), take.data(), numCells);
+        FVO::add(output.data(), scratch.data(), numCells);
+
+        FVO::add(outputActive.data(), take.data(), numCells);
+        FVO::subtract(remaining.data(), take.data(), numCells);
+
+        for (size_t cell = 0; cell < (size_t)numCells; ++cell)
+        {
+            if (take[cell] > 0.5f)
+                outputStamps[cell] = bandStamps[cell];
+        }
+    }
+
+    return true;
+}
+
+size_t MergeEngine::getMemoryUsage() const
+{
+    using MF = MemoryFootprint;
+    auto bytes = MF::getHeapBytes(layers) + MF::getHeapBytes(bandOrder) + MF::getHeapBytes(seenChangeCounts)
+                 + MF::getHeapBytes(attributeModes) + MF::getHeapBytes(htpMask) + MF::getHeapBytes(output)
+                 + MF::getHeapBytes(outputActive) + MF::getHeapBytes(outputStamps) + MF::getHeapBytes(remaining)
+                 + MF::getHeapBytes(bandHtp) + MF::getHeapBytes(bandLtp) + MF::getHeapBytes(bandActive)
+                 + MF::getHeapBytes(bandStamps) + MF::getHeapBytes(take) + MF::getHeapBytes(scratch);
+
+    for (const auto &layer : layers)
+        bytes += sizeof(MergeLayer) + MF::getHeapBytes(layer->name) + MF::getHeapBytes(layer->values)
+                 + MF::getHeapBytes(layer->active) + MF::getHeapBytes(layer->stamps);
+
+    return bytes;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/**
+ * How overlapping sources are arbitrated for an attribute.
+ */
+enum class MergeMode
+{
+    htp, // Highest takes precedence
+    ltp  // Latest takes precedence
+};
+
+//==============================================================================
+/**
+ * One source of control values (host automation, inbound MQTT commands,
+ * generators, ...) laid out as a contiguous group x attribute grid of
+ * normalised values. A cell is either active (holding a value and the
+ * timestamp it was set at) or released.
+ *
+ * Layers are not internally synchronised; the owner serialises access
+ * (the processor does this with its merge lock).
+ */
+class MergeLayer
+{
+public:
+    MergeLayer(const juce::String &layerName, int layerPriority);
+
+    const juce::String &getName() const { return name; }
+    int getPriority() const { return priority; }
+
+    // Cell access (cell = group * numAttributes + attribute)
+    void set(int cell, float normalisedValue, juce::int64 ticks) noexcept;
+    void release(int cell) noexcept;
+    void releaseAll() noexcept;
+
+    // Replace every cell at once; cells with an active flag of 0 are released
+    void setFrame(const float *newValues, const float *newActive, juce::int64 ticks) noexcept;
+    bool isActive(int cell) const noexcept;
+    float getValue(int cell) const noexcept;
+    int getNumCells() const { return (int)values.size(); }
+
+    // Bumped on every write so the engine can skip unchanged layers
+    juce::uint32 getChangeCount() const { return changeCount; }
+
+private:
+    friend class MergeEngine;
+
+    void resize(int numCells);
+
+    juce::String name;
+    int priority;
+
+    std::vector<float> values; // 0 when released, so HTP can take a plain max
+    std::vector<float> active; // 1 or 0, kept as floats for the vector blends
+    std::vector<juce::int64> stamps;
+    juce::uint32 changeCount = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MergeLayer)
+};
+
+//==============================================================================
+/**
+ * Merges every layer into one output frame.
+ *
+ * Layers are visited in priority bands (highest first). Within a band, HTP
+ * attributes take the maximum of the active values and LTP attributes take the
+ * most recently set value; a band only fills cells that no higher band holds.
+ * All of the per-cell arithmetic runs as juce::FloatVectorOperations over the
+ * whole grid, and the merge is skipped entirely when no layer changed.
+ */
+class MergeEngine
+{
+public:
+    MergeEngine() = default;
+
+    // Configuration (not thread-safe: call under the owner's lock)
+    int addLayer(const juce::String &name, int priority);
+    void setLayerPriority(int layerIndex, int priority);
+    // Sizes the grid; every layer starts released unless the caller knows the cells
+    // still mean the same (same groups and attributes in the same order)
+    void prepare(int numGroups, int numAttributes, bool keepLayerValues = false);
+    void setAttributeMode(int attributeIndex, MergeMode mode);
+    MergeMode getAttributeMode(int attributeIndex) const;
+
+    MergeLayer &getLayer(int layerIndex) { return *layers[(size_t)layerIndex]; }
+    int getNumLayers() const { return (int)layers.size(); }
+
+    int getNumGroups() const { return numGroups; }
+    int getNumAttributes() const { return numAttributes; }
+    int getNumCells() const { return numGroups * numAttributes; }
+    int getCellIndex(int groupIndex, int attributeIndex) const { return groupIndex * numAttributes + attributeIndex; }
+
+    // Compute the output frame. Returns false (and leaves the output untouched)
+    // when no layer changed since the last call. Allocation-free.
+    bool process() noexcept;
+
+    // Force the next process() call to re-merge
+    void markDirty() noexcept { dirty = true; }
+
+    // Output frame
+    const float *getOutputValues() const { return output.data(); }
+    const float *getOutputActive() const { return outputActive.data(); }
+    const juce::int64 *getOutputStamps() const { return outputStamps.data(); }
+
+    // Heap bytes held, not counting the object itself (message thread)
+    size_t getMemoryUsage() const;
+
+private:
+    void sortLayersByPriority();
+
+    std::vector<std::unique_ptr<MergeLayer>> layers;
+    std::vector<int> bandOrder; // layer indices, highest priority first
+    std::vector<juce::uint32> seenChangeCounts;
+    std::vector<MergeMode> attributeModes;
+
+    int numGroups = 0;
+    int numAttributes = 0;
+    bool dirty = true;
+
+    // Per-cell frame data (structure of arrays)
+    std::vector<float> htpMask; // 1 for HTP cells, 0 for LTP cells
+    std::vector<float> output;
+    std::vector<float> outputActive;
+    std::vector<juce::int64> outputStamps;
+
+    // Scratch
+    std::vector<float> remaining;
+    std::vector<float> bandHtp;
+    std::vector<float> bandLtp;
+    std::vector<float> bandActive;
+    std::vector<juce::int64> bandStamps;
+    std::vector<float> take;
+    std::vector<float> scratch;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MergeEngine)
+};
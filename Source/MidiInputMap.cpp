@@ -0,0 +1,182 @@
+#include "MidiInputMap.h"
+#include <algorithm>
+
+//==============================================================================
+MidiInputMap::MidiInputMap()
+{
+    for (auto &entry : compiledTable)
+        entry.store(unmapped, std::memory_order_relaxed);
+
+    for (auto &entry : learnedTable)
+        entry.store(unmapped, std::memory_order_relaxed);
+
+    resolvedLearned.fill(unmapped);
+}
+
+int MidiInputMap::getSlot(EventType type, int channel, int number) noexcept
+{
+    if (channel < 1 || channel > numChannels || number < 0 || number >= numNumbers)
+        return -1;
+
+    auto typeOffset = type == EventType::note ? numChannels * numNumbers : 0;
+    return typeOffset + (channel - 1) * numNumbers + number;
+}
+
+juce::int32 MidiInputMap::pack(Target target) noexcept
+{
+    if (!target.isValid())
+        return unmapped;
+
+    return (juce::int32)((target.groupIndex & 0xffff) << 16 | (target.attributeIndex & 0xffff));
+}
+
+MidiInputMap::Target MidiInputMap::unpack(juce::int32 packed) noexcept
+{
+    if (packed < 0)
+        return {};
+
+    return {(int)((packed >> 16) & 0x7fff), (int)(packed & 0xffff)};
+}
+
+//==============================================================================
+void MidiInputMap::compile(const MidiMap &midiMap)
+{
+    // Entries learned against the outgoing map are recorded by ID while its indices still apply
+    captureLearned();
+
+    groupIds.clearQuick();
+    attributeIds.clearQuick();
+    for (const auto &groupPair : midiMap.groups)
+        groupIds.add(groupPair.first);
+
+    for (const auto &attributePair : midiMap.attributes)
+        attributeIds.add(attributePair.first);
+
+    for (auto &entry : compiledTable)
+        entry.store(unmapped, std::memory_order_relaxed);
+
+    // Inverse of the output mapping: what we send for a group/attribute drives it when received
+    for (size_t group = 0; group < midiMap.groups.size(); ++group)
+    {
+        auto channel = midiMap.groups[group].first.getIntValue() + 1;
+
+        for (size_t attribute = 0; attribute < midiMap.attributes.size(); ++attribute)
+        {
+            auto slot = getSlot(EventType::controller, channel, midiMap.attributes[attribute].first.getIntValue());
+            if (slot >= 0)
+                compiledTable[(size_t)slot].store(pack({(int)group, (int)attribute}), std::memory_order_release);
+        }
+    }
+
+    resolveLearned();
+}
+
+MidiInputMap::Target MidiInputMap::lookup(EventType type, int channel, int number) const noexcept
+{
+    auto slot = getSlot(type, channel, number);
+    if (slot < 0)
+        return {};
+
+    auto learned = learnedTable[(size_t)slot].load(std::memory_order_acquire);
+    if (learned != unmapped)
+        return unpack(learned);
+
+    return unpack(compiledTable[(size_t)slot].load(std::memory_order_acquire));
+}
+
+void MidiInputMap::learn(EventType type, int channel, int number, Target target) noexcept
+{
+    auto slot = getSlot(type, channel, number);
+    if (slot >= 0)
+        learnedTable[(size_t)slot].store(pack(target), std::memory_order_release);
+}
+
+void MidiInputMap::clearLearned()
+{
+    for (auto &entry : learnedTable)
+        entry.store(unmapped, std::memory_order_release);
+
+    learnedEntries.clear();
+    resolvedLearned.fill(unmapped);
+}
+
+void MidiInputMap::captureLearned()
+{
+    for (int slot = 0; slot < tableSize; ++slot)
+    {
+        auto packed = learnedTable[(size_t)slot].load(std::memory_order_acquire);
+        if (packed == resolvedLearned[(size_t)slot])
+            continue;
+
+        // Learned on the audio thread since the last resolve, so the indices are the current map's
+        resolvedLearned[(size_t)slot] = packed;
+        learnedEntries.erase(std::remove_if(learnedEntries.begin(), learnedEntries.end(), [slot](const LearnedEntry &entry)
+                                            { return entry.slot == slot; }),
+                             learnedEntries.end());
+
+        auto target = unpack(packed);
+        if (target.isValid() && target.groupIndex < groupIds.size() && target.attributeIndex < attributeIds.size())
+            learnedEntries.push_back({slot, groupIds[target.groupIndex], attributeIds[target.attributeIndex]});
+    }
+}
+
+void MidiInputMap::resolveLearned()
+{
+    for (const auto &entry : learnedEntries)
+    {
+        auto packed = pack({groupIds.indexOf(entry.groupId), attributeIds.indexOf(entry.attributeId)});
+
+        // A learn landing meanwhile wins; the next capture records it
+        auto expected = resolvedLearned[(size_t)entry.slot];
+        if (learnedTable[(size_t)entry.slot].compare_exchange_strong(expected, packed, std::memory_order_acq_rel))
+            resolvedLearned[(size_t)entry.slot] = packed;
+    }
+}
+
+//==============================================================================
+std::unique_ptr<juce::XmlElement> MidiInputMap::createLearnedXml()
+{
+    captureLearned();
+
+    auto xml = std::make_unique<juce::XmlElement>(LEARNED_TAG);
+
+    for (const auto &learned : learnedEntries)
+    {
+        auto *entry = xml->createNewChildElement("ENTRY");
+        entry->setAttribute("type", learned.slot >= numChannels * numNumbers ? "note" : "cc");
+        entry->setAttribute("channel", (learned.slot / numNumbers) % numChannels + 1);
+        entry->setAttribute("number", learned.slot % numNumbers);
+        entry->setAttribute("groupId", learned.groupId);
+        entry->setAttribute("attributeId", learned.attributeId);
+    }
+
+    return xml;
+}
+
+void MidiInputMap::restoreLearned(const juce::XmlElement &xml)
+{
+    clearLearned();
+
+    for (auto *entry : xml.getChildWithTagNameIterator("ENTRY"))
+    {
+        auto type = entry->getStringAttribute("type") == "note" ? EventType::note : EventType::controller;
+        auto slot = getSlot(type, entry->getIntAttribute("channel"), entry->getIntAttribute("number"));
+        if (slot < 0)
+            continue;
+
+        // States saved before targets were kept by ID hold indices into the current map
+        auto groupId = entry->hasAttribute("groupId") ? entry->getStringAttribute("groupId")
+                                                      : groupIds[entry->getIntAttribute("group", -1)];
+        auto attributeId = entry->hasAttribute("attributeId") ? entry->getStringAttribute("attributeId")
+                                                              : attributeIds[entry->getIntAttribute("attribute", -1)];
+        if (groupId.isEmpty() || attributeId.isEmpty())
+            continue;
+
+        learnedEntries.erase(std::remove_if(learnedEntries.begin(), learnedEntries.end(), [slot](const LearnedEntry &learned)
+                                            { return learned.slot == slot; }),
+                             learnedEntries.end());
+        learnedEntries.push_back({slot, groupId, attributeId});
+    }
+
+    resolveLearned();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "MidiMap.h"
+
+//==============================================================================
+/**
+ * Translates incoming MIDI events into group/attribute targets.
+ *
+ * Lookups go through flat 16 x 128 tables (one for CCs, one for notes) so the
+ * audio thread resolves an event with a single atomic load. The compiled
+ * table mirrors the output mapping of the MidiMap (channel = group ID + 1,
+ * CC = attribute ID); MIDI-learned entries live in a second table that takes
+ * precedence. Learned targets are kept by group and attribute ID and resolved
+ * again by every compile, so they follow their cell when a map edit reorders
+ * or inserts groups or attributes, and go quiet while it is missing.
+ *
+ * Lookups and learning are lock-free and allocation-free; compiling and
+ * (de)serialising the learned entries happen on the message thread.
+ */
+class MidiInputMap
+{
+public:
+    enum class EventType
+    {
+        controller,
+        note
+    };
+
+    static constexpr int numChannels = 16;
+    static constexpr int numNumbers = 128;
+
+    struct Target
+    {
+        int groupIndex = -1;
+        int attributeIndex = -1;
+
+        bool isValid() const { return groupIndex >= 0 && attributeIndex >= 0; }
+    };
+
+    MidiInputMap();
+
+    // Rebuild the compiled table from the map (message thread)
+    void compile(const MidiMap &midiMap);
+
+    // Resolve an event (1-based channel); learned entries win over compiled ones
+    Target lookup(EventType type, int channel, int number) const noexcept;
+
+    // MIDI learn (any thread), against the map last compiled
+    void learn(EventType type, int channel, int number, Target target) noexcept;
+
+    // Forget every learned entry (message thread)
+    void clearLearned();
+
+    // Learned entries for the plugin state, by ID (message thread)
+    std::unique_ptr<juce::XmlElement> createLearnedXml();
+    void restoreLearned(const juce::XmlElement &xml);
+    static constexpr const char *LEARNED_TAG = "MIDI_LEARN";
+
+private:
+    static constexpr int tableSize = 2 * numChannels * numNumbers;
+    static constexpr juce::int32 unmapped = -1;
+
+    static int getSlot(EventType type, int channel, int number) noexcept;
+    static juce::int32 pack(Target target) noexcept;
+    static Target unpack(juce::int32 packed) noexcept;
+
+    // Pick up entries learned since the last call, by ID against the map last compiled
+    void captureLearned();
+
+    // Store each learned entry's target in the current map, or unmapped if it has none
+    void resolveLearned();
+
+    std::array<std::atomic<juce::int32>, tableSize> compiledTable;
+    std::array<std::atomic<juce::int32>, tableSize> learnedTable;
+
+    // Message thread: learned targets by ID, the indices last resolved for them, and
+    // the IDs of the map last compiled
+    struct LearnedEntry
+    {
+        int slot = 0;
+        juce::String groupId;
+        juce::String attributeId;
+    };
+
+    std::vector<LearnedEntry> learnedEntries;
+    std::array<juce::int32, tableSize> resolvedLearned;
+    juce::StringArray groupIds, attributeIds;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiInputMap)
+};
@@ -1,4 +1,5 @@
 #include "MidiMap.h"
+#include "TraceEvents.h"
 
 //==============================================================================
 // MidiMap implementation
@@ -43,6 +44,60 @@ juce::String MidiMap::getAttributeName(const juce::String &attributeId) const
     return juce::String();
 }
 
+juce::String MidiMap::getMergeMode(const juce::String &attributeId) const
+{
+    for (const auto &pair : mergeModes)
+    {
+        if (pair.first == attributeId)
+            return pair.second;
+    }
+    return juce::String();
+}
+
+MidiMap::AttributeType MidiMap::getAttributeType(const juce::String &attributeId) const
+{
+    for (const auto &pair : attributeTypes)
+    {
+        if (pair.first == attributeId)
+            return pair.second;
+    }
+
+    // Maps without a "types" section: infer from the attribute name as before
+    AttributeType inferred;
+    auto name = getAttributeName(attributeId);
+
+    if (name.containsIgnoreCase("hue"))
+        inferred.type = "hue";
+    else if (name.containsIgnoreCase("brightness") || name.containsIgnoreCase("intensity") || name.containsIgnoreCase("dimmer"))
+        inferred.type = "dimmer";
+    else if (name.containsIgnoreCase("strobe"))
+        inferred.type = "strobe";
+    else if (name.containsIgnoreCase("saturation"))
+        inferred.defaultValue = 100.0f;
+
+    return inferred;
+}
+
+MidiMap::SmoothingSetting MidiMap::getSmoothing(const juce::String &attributeId) const
+{
+    for (const auto &pair : smoothing)
+    {
+        if (pair.first == attributeId)
+            return pair.second;
+    }
+    return {"none", 0.0f};
+}
+
+const MidiMap::FixtureAssignment *MidiMap::getFixture(const juce::String &groupId) const
+{
+    for (const auto &pair : fixtures)
+    {
+        if (pair.first == groupId)
+            return &pair.second;
+    }
+    return nullptr;
+}
+
 juce::StringArray MidiMap::getAllGroupIds() const
 {
     juce::StringArray ids;
@@ -84,6 +139,62 @@ juce::String MidiMap::toString() const
         result += "  " + pair.first + " -> " + pair.second + "\n";
     }
 
+    if (!mergeModes.empty())
+    {
+        result += "Merge:\n";
+        for (const auto &pair : mergeModes)
+        {
+            result += "  " + pair.first + " -> " + pair.second + "\n";
+        }
+    }
+
+    if (!attributeTypes.empty())
+    {
+        result += "Types:\n";
+        for (const auto &pair : attributeTypes)
+        {
+            result += "  " + pair.first + " -> " + pair.second.type + "\n";
+        }
+    }
+
+    if (!smoothing.empty())
+    {
+        result += "Smoothing:\n";
+        for (const auto &pair : smoothing)
+        {
+            result += "  " + pair.first + " -> " + pair.second.mode + " " + juce::String(pair.second.timeMs) + " ms\n";
+        }
+    }
+
+    if (!fixtures.empty())
+    {
+        result += "Fixtures:\n";
+        for (const auto &pair : fixtures)
+        {
+            result += "  " + pair.first + " -> " + pair.second.profile + " (" + pair.second.mode + ") from CC " + juce::String(pair.second.startCC) + "\n";
+        }
+    }
+
+    if (!modulation.empty())
+    {
+        result += "Modulation:\n";
+        for (const auto &pair : modulation)
+        {
+            result += "  " + pair.first + " <- " + pair.second.source + " (" + pair.second.mode + " " + juce::String(pair.second.depth) + ")\n";
+        }
+    }
+
+    if (!pixels.empty())
+    {
+        result += "Pixels:\n";
+        for (const auto &pair : pixels)
+        {
+            const auto &mapping = pair.second;
+            result += "  " + pair.first + " -> " + juce::String(mapping.width) + "x" + juce::String(mapping.height) +
+                      " at " + juce::String(mapping.universe) + "." + juce::String(mapping.address) + ", " + mapping.effect + "\n";
+        }
+    }
+
     return result;
 }
 
@@ -92,6 +203,8 @@ juce::String MidiMap::toString() const
 
 juce::Result MidiMapSerializer::deserialize(const juce::String &jsonString, MidiMap &midiMap)
 {
+    KADMIUM_TRACE_SPAN("MidiMapSerializer::deserialize");
+
     auto parseResult = juce::JSON::parse(jsonString);
 
     if (!parseResult.isObject())
@@ -141,11 +254,212 @@ juce::Result MidiMapSerializer::deserialize(const juce::var &jsonVar, MidiMap &m
         }
     }
 
+    // Parse optional attribute types, e.g. "1": "hue" or "5": {"type": "position16", "fineCC": 37}
+    if (object->hasProperty("types"))
+    {
+        auto typesVar = object->getProperty("types");
+        if (typesVar.isObject())
+        {
+            if (auto *typesObject = typesVar.getDynamicObject())
+            {
+                for (const auto &property : typesObject->getProperties())
+                {
+                    MidiMap::AttributeType attributeType;
+
+                    if (property.value.isString())
+                    {
+                        attributeType.type = property.value.toString();
+                    }
+                    else
+                    {
+                        attributeType.type = property.value.getProperty("type", "generic").toString();
+                        attributeType.fineCC = (int)property.value.getProperty("fineCC", -1);
+                        attributeType.maxRate = (float)property.value.getProperty("maxRate", 0.0f);
+                        attributeType.defaultValue = (float)property.value.getProperty("default", -1.0f);
+
+                        if (auto *options = property.value.getProperty("options", juce::var()).getArray())
+                        {
+                            for (const auto &option : *options)
+                                attributeType.options.add(option.toString());
+                        }
+                    }
+
+                    if (attributeType.type != "generic" && attributeType.type != "dimmer" && attributeType.type != "hue" &&
+                        attributeType.type != "position16" && attributeType.type != "enum" && attributeType.type != "strobe")
+                        return juce::Result::fail("Unknown type for attribute " + property.name.toString() + ": " + attributeType.type);
+
+                    if (attributeType.type == "enum" && attributeType.options.isEmpty())
+                        return juce::Result::fail("Enum attribute " + property.name.toString() + " needs at least one option");
+
+                    midiMap.attributeTypes.push_back({property.name.toString(), attributeType});
+                }
+            }
+        }
+    }
+
+    // Parse optional merge rules
+    if (object->hasProperty("merge"))
+    {
+        auto mergeVar = object->getProperty("merge");
+        if (mergeVar.isObject())
+        {
+            if (auto *mergeObject = mergeVar.getDynamicObject())
+            {
+                for (const auto &property : mergeObject->getProperties())
+                {
+                    auto mode = property.value.toString().toLowerCase();
+                    if (mode != "htp" && mode != "ltp")
+                        return juce::Result::fail("Merge rule for attribute " + property.name.toString() + " must be \"htp\" or \"ltp\"");
+
+                    midiMap.mergeModes.push_back({property.name.toString(), mode});
+                }
+            }
+        }
+    }
+
+    // Parse optional smoothing settings, e.g. "3": {"mode": "onePole", "timeMs": 80}
+    if (object->hasProperty("smoothing"))
+    {
+        auto smoothingVar = object->getProperty("smoothing");
+        if (smoothingVar.isObject())
+        {
+            if (auto *smoothingObject = smoothingVar.getDynamicObject())
+            {
+                for (const auto &property : smoothingObject->getProperties())
+                {
+                    MidiMap::SmoothingSetting setting;
+                    setting.mode = property.value.getProperty("mode", "none").toString();
+                    setting.timeMs = (float)property.value.getProperty("timeMs", 0.0f);
+
+                    if (setting.mode != "none" && setting.mode != "onePole" &&
+                        setting.mode != "linear" && setting.mode != "maxSlew")
+                        return juce::Result::fail("Unknown smoothing mode for attribute " + property.name.toString() + ": " + setting.mode);
+
+                    if (setting.timeMs < 0.0f)
+                        return juce::Result::fail("Smoothing time for attribute " + property.name.toString() + " must not be negative");
+
+                    midiMap.smoothing.push_back({property.name.toString(), setting});
+                }
+            }
+        }
+    }
+
+    // Parse optional fixture profiles, e.g. "0": {"profile": "generic-rgbw.json", "mode": "8-channel", "startCC": 20}
+    if (object->hasProperty("fixtures"))
+    {
+        auto fixturesVar = object->getProperty("fixtures");
+        if (fixturesVar.isObject())
+        {
+            if (auto *fixturesObject = fixturesVar.getDynamicObject())
+            {
+                for (const auto &property : fixturesObject->getProperties())
+                {
+                    MidiMap::FixtureAssignment fixture;
+                    fixture.profile = property.value.getProperty("profile", "").toString();
+                    fixture.mode = property.value.getProperty("mode", "").toString();
+                    fixture.startCC = (int)property.value.getProperty("startCC", fixture.startCC);
+
+                    if (fixture.profile.isEmpty())
+                        return juce::Result::fail("Fixture for group " + property.name.toString() + " needs a profile");
+
+                    if (fixture.startCC < 0 || fixture.startCC > 127)
+                        return juce::Result::fail("Start CC for group " + property.name.toString() + " must be 0-127");
+
+                    midiMap.fixtures.push_back({property.name.toString(), fixture});
+                }
+            }
+        }
+    }
+
+    // Parse optional audio modulation, e.g. "3": {"source": "low", "depth": 0.8} or "chaseRate": {"source": "onset"}
+    if (object->hasProperty("modulation"))
+    {
+        auto modulationVar = object->getProperty("modulation");
+        if (modulationVar.isObject())
+        {
+            if (auto *modulationObject = modulationVar.getDynamicObject())
+            {
+                static const juce::StringArray sources{"level", "low", "lowMid", "highMid", "high", "onset"};
+
+                for (const auto &property : modulationObject->getProperties())
+                {
+                    MidiMap::ModulationSetting setting;
+                    setting.source = property.value.getProperty("source", "").toString();
+                    setting.depth = (float)property.value.getProperty("depth", setting.depth);
+                    setting.mode = property.value.getProperty("mode", setting.mode).toString();
+
+                    if (!sources.contains(setting.source))
+                        return juce::Result::fail("Unknown modulation source for " + property.name.toString() + ": " + setting.source);
+
+                    if (setting.mode != "scale" && setting.mode != "add")
+                        return juce::Result::fail("Modulation mode for " + property.name.toString() + " must be \"scale\" or \"add\"");
+
+                    if (setting.depth < 0.0f || setting.depth > 1.0f)
+                        return juce::Result::fail("Modulation depth for " + property.name.toString() + " must be 0-1");
+
+                    midiMap.modulation.push_back({property.name.toString(), setting});
+                }
+            }
+        }
+    }
+
+    // Parse optional pixel maps, e.g. "2": {"width": 60, "height": 8, "universe": 1, "effect": "chase"}
+    if (object->hasProperty("pixels"))
+    {
+        auto pixelsVar = object->getProperty("pixels");
+        if (pixelsVar.isObject())
+        {
+            if (auto *pixelsObject = pixelsVar.getDynamicObject())
+            {
+                for (const auto &property : pixelsObject->getProperties())
+                {
+                    const auto &value = property.value;
+                    MidiMap::PixelMapping mapping;
+                    mapping.width = (int)value.getProperty("width", mapping.width);
+                    mapping.height = (int)value.getProperty("height", mapping.height);
+                    mapping.serpentine = (bool)value.getProperty("serpentine", mapping.serpentine);
+                    mapping.universe = (int)value.getProperty("universe", mapping.universe);
+                    mapping.address = (int)value.getProperty("address", mapping.address);
+                    mapping.order = value.getProperty("order", mapping.order).toString();
+                    mapping.effect = value.getProperty("effect", mapping.effect).toString();
+                    mapping.colour = value.getProperty("colour", mapping.colour).toString();
+                    mapping.speed = (float)value.getProperty("speed", mapping.speed);
+                    mapping.scale = (float)value.getProperty("scale", mapping.scale);
+                    mapping.angle = (float)value.getProperty("angle", mapping.angle);
+                    mapping.bandWidth = (float)value.getProperty("bandWidth", mapping.bandWidth);
+                    mapping.image = value.getProperty("image", mapping.image).toString();
+
+                    if (mapping.width < 1 || mapping.height < 1)
+                        return juce::Result::fail("Pixel map for group " + property.name.toString() + " needs a width and height of at least 1");
+
+                    if (mapping.universe < 1 || mapping.address < 1 || mapping.address > 510)
+                        return juce::Result::fail("Pixel map for group " + property.name.toString() + " has an invalid universe or address");
+
+                    auto spanResult = checkPixelSpan(property.name.toString(), mapping);
+                    if (spanResult.failed())
+                        return spanResult;
+
+                    if (mapping.effect != "solid" && mapping.effect != "gradient" && mapping.effect != "noise" &&
+                        mapping.effect != "chase" && mapping.effect != "image")
+                        return juce::Result::fail("Unknown pixel effect for group " + property.name.toString() + ": " + mapping.effect);
+
+                    midiMap.pixels.push_back({property.name.toString(), mapping});
+                }
+            }
+        }
+
+        auto overlapResult = checkPixelOverlaps(midiMap.pixels);
+        if (overlapResult.failed())
+            return overlapResult;
+    }
+
     return juce::Result::ok();
 }
 
 juce::String MidiMapSerializer::serialize(const MidiMap &midiMap)
 {
+    KADMIUM_TRACE_SPAN("MidiMapSerializer::serialize");
+
     auto jsonVar = serializeToVar(midiMap);
     return juce::JSON::toString(jsonVar);
 }
@@ -160,6 +474,114 @@ juce::var MidiMapSerializer::serializeToVar(const MidiMap &midiMap)
     // Add attributes
     rootObject->setProperty("attributes", createAttributesVar(midiMap.attributes));
 
+    // Add attribute types (optional)
+    if (!midiMap.attributeTypes.empty())
+    {
+        auto *typesObject = new juce::DynamicObject();
+        for (const auto &pair : midiMap.attributeTypes)
+        {
+            const auto &attributeType = pair.second;
+            auto *typeObject = new juce::DynamicObject();
+            typeObject->setProperty("type", attributeType.type);
+
+            if (attributeType.fineCC >= 0)
+                typeObject->setProperty("fineCC", attributeType.fineCC);
+
+            if (!attributeType.options.isEmpty())
+            {
+                juce::Array<juce::var> options;
+                for (const auto &option : attributeType.options)
+                    options.add(option);
+                typeObject->setProperty("options", options);
+            }
+
+            if (attributeType.maxRate > 0.0f)
+                typeObject->setProperty("maxRate", attributeType.maxRate);
+
+            if (attributeType.defaultValue >= 0.0f)
+                typeObject->setProperty("default", attributeType.defaultValue);
+
+            typesObject->setProperty(pair.first, juce::var(typeObject));
+        }
+        rootObject->setProperty("types", juce::var(typesObject));
+    }
+
+    // Add merge rules (optional)
+    if (!midiMap.mergeModes.empty())
+        rootObject->setProperty("merge", createAttributesVar(midiMap.mergeModes));
+
+    // Add smoothing settings (optional)
+    if (!midiMap.smoothing.empty())
+    {
+        auto *smoothingObject = new juce::DynamicObject();
+        for (const auto &pair : midiMap.smoothing)
+        {
+            auto *settingObject = new juce::DynamicObject();
+            settingObject->setProperty("mode", pair.second.mode);
+            settingObject->setProperty("timeMs", pair.second.timeMs);
+            smoothingObject->setProperty(pair.first, juce::var(settingObject));
+        }
+        rootObject->setProperty("smoothing", juce::var(smoothingObject));
+    }
+
+    // Add fixture profiles (optional)
+    if (!midiMap.fixtures.empty())
+    {
+        auto *fixturesObject = new juce::DynamicObject();
+        for (const auto &pair : midiMap.fixtures)
+        {
+            auto *fixtureObject = new juce::DynamicObject();
+            fixtureObject->setProperty("profile", pair.second.profile);
+            if (pair.second.mode.isNotEmpty())
+                fixtureObject->setProperty("mode", pair.second.mode);
+            fixtureObject->setProperty("startCC", pair.second.startCC);
+            fixturesObject->setProperty(pair.first, juce::var(fixtureObject));
+        }
+        rootObject->setProperty("fixtures", juce::var(fixturesObject));
+    }
+
+    // Add audio modulation (optional)
+    if (!midiMap.modulation.empty())
+    {
+        auto *modulationObject = new juce::DynamicObject();
+        for (const auto &pair : midiMap.modulation)
+        {
+            auto *settingObject = new juce::DynamicObject();
+            settingObject->setProperty("source", pair.second.source);
+            settingObject->setProperty("depth", pair.second.depth);
+            settingObject->setProperty("mode", pair.second.mode);
+            modulationObject->setProperty(pair.first, juce::var(settingObject));
+        }
+        rootObject->setProperty("modulation", juce::var(modulationObject));
+    }
+
+    // Add pixel maps (optional)
+    if (!midiMap.pixels.empty())
+    {
+        auto *pixelsObject = new juce::DynamicObject();
+        for (const auto &pair : midiMap.pixels)
+        {
+            const auto &mapping = pair.second;
+            auto *mappingObject = new juce::DynamicObject();
+            mappingObject->setProperty("width", mapping.width);
+            mappingObject->setProperty("height", mapping.height);
+            mappingObject->setProperty("serpentine", mapping.serpentine);
+            mappingObject->setProperty("universe", mapping.universe);
+            mappingObject->setProperty("address", mapping.address);
+            mappingObject->setProperty("order", mapping.order);
+            mappingObject->setProperty("effect", mapping.effect);
+            mappingObject->setProperty("colour", mapping.colour);
+            mappingObject->setProperty("speed", mapping.speed);
+            mappingObject->setProperty("scale", mapping.scale);
+            mappingObject->setProperty("angle", mapping.angle);
+            mappingObject->setProperty("bandWidth", mapping.bandWidth);
+            if (mapping.image.isNotEmpty())
+                mappingObject->setProperty("image", mapping.image);
+            pixelsObject->setProperty(pair.first, juce::var(mappingObject));
+        }
+        rootObject->setProperty("pixels", juce::var(pixelsObject));
+    }
+
     return juce::var(rootObject);
 }
 
@@ -244,6 +666,75 @@ juce::Result MidiMapSerializer::parseAttributes(const juce::var &attributesVar,
     return juce::Result::ok();
 }
 
+juce::Result MidiMapSerializer::checkPixelSpan(const juce::String &groupId, const MidiMap::PixelMapping &mapping)
+{
+    constexpr juce::int64 pixelsPerUniverse = universeSize / channelsPerPixel;
+
+    auto numPixels = (juce::int64)mapping.width * mapping.height;
+    if (mapping.universe > maxPixelUniverse || numPixels > maxPixelUniverse * pixelsPerUniverse)
+        return juce::Result::fail("Pixel map for group " + groupId + " is too large");
+
+    // Pixels that fit in the first universe, then whole universes for the rest
+    auto firstPixels = (juce::int64)((universeSize - mapping.address + 1) / channelsPerPixel);
+    auto lastUniverse = (juce::int64)mapping.universe;
+    if (numPixels > firstPixels)
+        lastUniverse += (numPixels - firstPixels + pixelsPerUniverse - 1) / pixelsPerUniverse;
+
+    if (lastUniverse > maxPixelUniverse)
+        return juce::Result::fail("Pixel map for group " + groupId + " runs past universe " + juce::String(maxPixelUniverse));
+
+    return juce::Result::ok();
+}
+
+juce::Result MidiMapSerializer::checkPixelOverlaps(const std::vector<std::pair<juce::String, MidiMap::PixelMapping>> &pixels)
+{
+    struct Span
+    {
+        size_t mappingIndex;
+        int universe;
+        int firstAddress;
+        int lastAddress;
+    };
+
+    std::vector<Span> spans;
+    for (size_t i = 0; i < pixels.size(); ++i)
+    {
+        const auto &mapping = pixels[i].second;
+        auto remaining = (juce::int64)mapping.width * mapping.height;
+        auto universe = mapping.universe;
+        auto address = mapping.address;
+
+        while (remaining > 0)
+        {
+            if (address + channelsPerPixel - 1 > universeSize)
+            {
+                ++universe;
+                address = 1;
+            }
+
+            auto numPixels = (int)juce::jmin(remaining, (juce::int64)((universeSize - address + 1) / channelsPerPixel));
+            spans.push_back({i, universe, address, address + numPixels * channelsPerPixel - 1});
+            address += numPixels * channelsPerPixel;
+            remaining -= numPixels;
+        }
+    }
+
+    for (size_t a = 0; a < spans.size(); ++a)
+    {
+        for (size_t b = a + 1; b < spans.size(); ++b)
+        {
+            const auto &first = spans[a];
+            const auto &second = spans[b];
+            if (first.mappingIndex != second.mappingIndex && first.universe == second.universe
+                && first.firstAddress <= second.lastAddress && second.firstAddress <= first.lastAddress)
+                return juce::Result::fail("Pixel maps for groups " + pixels[first.mappingIndex].first + " and "
+                                          + pixels[second.mappingIndex].first + " overlap in universe " + juce::String(first.universe));
+        }
+    }
+
+    return juce::Result::ok();
+}
+
 juce::var MidiMapSerializer::createGroupsVar(const std::vector<std::pair<juce::String, juce::String>> &groups)
 {
     auto *groupsObject = new juce::DynamicObject();
@@ -11,12 +11,81 @@
 
 struct MidiMap
 {
+    // Declared type of one attribute
+    struct AttributeType
+    {
+        juce::String type = "generic"; // "generic", "dimmer", "hue", "position16", "enum" or "strobe"
+        int fineCC = -1;               // position16: CC for the low 7 bits (defaults to CC + 32)
+        juce::StringArray options;     // enum: slot names, in order
+        float maxRate = 0.0f;          // strobe: top rate in Hz (defaults to 20)
+        float defaultValue = -1.0f;    // parameter default in its own units, -1 for the type's default
+    };
+
+    // Output smoothing for one attribute
+    struct SmoothingSetting
+    {
+        juce::String mode;   // "none", "onePole", "linear" or "maxSlew"
+        float timeMs = 0.0f; // Time constant, ramp time or full-range travel time
+    };
+
+    // Fixture profile driving one group's colour output
+    struct FixtureAssignment
+    {
+        juce::String profile; // Profile file, relative to the profile directory
+        juce::String mode;    // Profile mode; empty for the first
+        int startCC = 20;     // CC for the mode's first channel, the rest follow in order
+    };
+
+    // Pixel-mapped group: geometry, DMX placement and the effect rendered across it
+    struct PixelMapping
+    {
+        int width = 1;                   // pixels per row (a strip is one row)
+        int height = 1;                  // rows
+        bool serpentine = false;         // odd rows run backwards
+        int universe = 1;                // first DMX universe
+        int address = 1;                 // 1-based start address in that universe
+        juce::String order = "RGB";      // channel order of each pixel
+        juce::String effect = "solid";   // "solid", "gradient", "noise", "chase" or "image"
+        juce::String colour = "#000000"; // second colour the effect blends the group colour with
+        float speed = 0.0f;              // cycles per second
+        float scale = 1.0f;              // repeats across the geometry
+        float angle = 0.0f;              // degrees
+        float bandWidth = 0.25f;         // chase: lit fraction of each band
+        juce::String image;              // image effect: file, absolute or relative to the data directory
+    };
+
+    // Audio-reactive modulation of one attribute (or the chase rate) by an analysis source
+    struct ModulationSetting
+    {
+        juce::String source;         // "level", "low", "lowMid", "highMid", "high" or "onset"
+        float depth = 1.0f;          // 0-1
+        juce::String mode = "scale"; // "scale": value * (1 - depth + depth * source); "add": value + depth * source
+    };
+
     // Group ID to name mapping (e.g., "0" -> "Vocalist") - preserves order
     std::vector<std::pair<juce::String, juce::String>> groups;
 
     // Attribute ID to name mapping (e.g., "1" -> "Hue") - preserves order
     std::vector<std::pair<juce::String, juce::String>> attributes;
 
+    // Optional attribute ID to type mapping; unlisted attributes have their type inferred from the name
+    std::vector<std::pair<juce::String, AttributeType>> attributeTypes;
+
+    // Optional attribute ID to merge rule mapping (e.g., "3" -> "htp"); unlisted attributes use the default
+    std::vector<std::pair<juce::String, juce::String>> mergeModes;
+
+    // Optional attribute ID to output smoothing mapping; unlisted attributes are not smoothed
+    std::vector<std::pair<juce::String, SmoothingSetting>> smoothing;
+
+    // Optional group ID to fixture profile mapping; unlisted groups send their attributes directly
+    std::vector<std::pair<juce::String, FixtureAssignment>> fixtures;
+
+    // Optional group ID to pixel map mapping; listed groups are also rendered per pixel into DMX universes
+    std::vector<std::pair<juce::String, PixelMapping>> pixels;
+
+    // Optional attribute ID (or "chaseRate") to audio modulation mapping; only used by the audio-reactive build
+    std::vector<std::pair<juce::String, ModulationSetting>> modulation;
+
     // Default constructor
     MidiMap() = default;
 
@@ -25,6 +94,10 @@ struct MidiMap
     bool hasAttribute(const juce::String &attributeId) const;
     juce::String getGroupName(const juce::String &groupId) const;
     juce::String getAttributeName(const juce::String &attributeId) const;
+    juce::String getMergeMode(const juce::String &attributeId) const;
+    AttributeType getAttributeType(const juce::String &attributeId) const;
+    SmoothingSetting getSmoothing(const juce::String &attributeId) const;
+    const FixtureAssignment *getFixture(const juce::String &groupId) const;
 
     // Get all group IDs
     juce::StringArray getAllGroupIds() const;
@@ -69,4 +142,15 @@ private:
     static juce::Result parseAttributes(const juce::var &attributesVar, std::vector<std::pair<juce::String, juce::String>> &attributes);
     static juce::var createGroupsVar(const std::vector<std::pair<juce::String, juce::String>> &groups);
     static juce::var createAttributesVar(const std::vector<std::pair<juce::String, juce::String>> &attributes);
+
+    // Pixel maps are laid out as PixelMapEngine packs them: three channels a pixel,
+    // never straddling one of the 512-channel universes
+    static constexpr int universeSize = 512;
+    static constexpr int channelsPerPixel = 3;
+    static constexpr int maxPixelUniverse = 4096; // highest universe a pixel map may reach
+
+    static juce::Result checkPixelSpan(const juce::String &groupId, const MidiMap::PixelMapping &mapping);
+
+    // Pixel groups render in parallel, so no two may share a DMX channel
+    static juce::Result checkPixelOverlaps(const std::vector<std::pair<juce::String, MidiMap::PixelMapping>> &pixels);
 };
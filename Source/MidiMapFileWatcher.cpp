@@ -0,0 +1,237 @@
+#include "MidiMapFileWatcher.h"
+#include "EventLog.h"
+#include <algorithm>
+
+#if JUCE_LINUX
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+//==============================================================================
+MidiMapFileWatcher::MidiMapFileWatcher()
+    : juce::Thread("MIDI map watcher")
+{
+}
+
+MidiMapFileWatcher::~MidiMapFileWatcher()
+{
+    stopThread(2000);
+
+#if JUCE_LINUX
+    if (inotifyDescriptor >= 0)
+        ::close(inotifyDescriptor);
+#endif
+}
+
+void MidiMapFileWatcher::addListener(const juce::File &file, Listener *listener)
+{
+    removeListener(listener);
+
+    const juce::ScopedLock sl(lock);
+    auto found = std::find_if(files.begin(), files.end(), [&file](const std::unique_ptr<WatchedFile> &watched)
+                              { return watched->file == file; });
+
+    if (found == files.end())
+    {
+        // The listener has just loaded the file, so its current content is the baseline
+        auto watched = std::make_unique<WatchedFile>();
+        watched->file = file;
+        watched->lastContent = file.loadFileAsString();
+        watched->lastModified = file.getLastModificationTime();
+        watched->lastSize = file.getSize();
+
+#if JUCE_LINUX
+        // Set before the thread starts, so it never changes under it
+        if (inotifyDescriptor < 0 && !isThreadRunning())
+            inotifyDescriptor = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+        // Watching the directory catches editors that save by replacing the file
+        if (inotifyDescriptor >= 0)
+            watched->watchDescriptor = ::inotify_add_watch(inotifyDescriptor, file.getParentDirectory().getFullPathName().toRawUTF8(),
+                                                           IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MODIFY);
+#endif
+
+        files.push_back(std::move(watched));
+        found = std::prev(files.end());
+    }
+
+    (*found)->listeners.addIfNotAlreadyThere(listener);
+
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::background);
+}
+
+void MidiMapFileWatcher::removeListener(Listener *listener)
+{
+    const juce::ScopedLock sl(lock);
+
+    for (auto it = files.begin(); it != files.end();)
+    {
+        auto &watched = **it;
+        watched.listeners.removeFirstMatchingValue(listener);
+
+        if (watched.listeners.isEmpty())
+        {
+            unwatch(watched);
+            it = files.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void MidiMapFileWatcher::unwatch(WatchedFile &watched)
+{
+#if JUCE_LINUX
+    // Files in the same directory share one watch
+    auto shared = std::any_of(files.begin(), files.end(), [&watched](const std::unique_ptr<WatchedFile> &other)
+                              { return other.get() != &watched && other->watchDescriptor == watched.watchDescriptor; });
+
+    if (watched.watchDescriptor >= 0 && !shared)
+        ::inotify_rm_watch(inotifyDescriptor, watched.watchDescriptor);
+#endif
+
+    watched.watchDescriptor = -1;
+}
+
+//==============================================================================
+void MidiMapFileWatcher::run()
+{
+    while (!threadShouldExit())
+    {
+        // Come back soon while a change is settling, otherwise wake only to check for exit
+        auto timeoutMs = POLL_INTERVAL_MS;
+        {
+            const juce::ScopedLock sl(lock);
+            for (const auto &watched : files)
+                if (watched->changedAtMs > 0.0)
+                    timeoutMs = DEBOUNCE_MS / 4;
+        }
+
+        waitForChanges(timeoutMs);
+        reloadSettledFiles();
+    }
+}
+
+void MidiMapFileWatcher::waitForChanges(int timeoutMs)
+{
+    auto usesInotify = false;
+
+#if JUCE_LINUX
+    usesInotify = inotifyDescriptor >= 0;
+    pollfd descriptor{inotifyDescriptor, POLLIN, 0};
+
+    if (usesInotify && ::poll(&descriptor, 1, timeoutMs) > 0)
+    {
+        alignas(inotify_event) char buffer[4096];
+        for (;;)
+        {
+            auto numBytes = ::read(inotifyDescriptor, buffer, sizeof(buffer));
+            if (numBytes <= 0)
+                break;
+
+            auto nowMs = juce::Time::getMillisecondCounterHiRes();
+            const juce::ScopedLock sl(lock);
+
+            for (auto *position = buffer; position < buffer + numBytes;)
+            {
+                const auto *event = reinterpret_cast<const inotify_event *>(position);
+                position += sizeof(inotify_event) + event->len;
+
+                if (event->len == 0)
+                    continue;
+
+                juce::String name(juce::CharPointer_UTF8(event->name));
+                for (auto &watched : files)
+                    if (watched->watchDescriptor == event->wd && watched->file.getFileName() == name)
+                        watched->changedAtMs = nowMs;
+            }
+        }
+    }
+#endif
+
+    if (!usesInotify)
+        wait(timeoutMs);
+
+    // Files without a watch fall back to their modification time
+    auto nowMs = juce::Time::getMillisecondCounterHiRes();
+    const juce::ScopedLock sl(lock);
+
+    for (auto &watched : files)
+    {
+        if (watched->watchDescriptor >= 0)
+            continue;
+
+        auto modified = watched->file.getLastModificationTime();
+        auto size = watched->file.getSize();
+        if (modified != watched->lastModified || size != watched->lastSize)
+        {
+            watched->lastModified = modified;
+            watched->lastSize = size;
+            watched->changedAtMs = nowMs;
+        }
+    }
+}
+
+void MidiMapFileWatcher::reloadSettledFiles()
+{
+    std::vector<juce::File> settled;
+    {
+        auto nowMs = juce::Time::getMillisecondCounterHiRes();
+        const juce::ScopedLock sl(lock);
+
+        for (auto &watched : files)
+        {
+            if (watched->changedAtMs > 0.0 && nowMs - watched->changedAtMs >= DEBOUNCE_MS)
+            {
+                watched->changedAtMs = 0.0;
+                settled.push_back(watched->file);
+            }
+        }
+    }
+
+    for (const auto &file : settled)
+    {
+        // Empty while an editor truncates and rewrites; the write that follows brings the content
+        auto content = file.loadFileAsString();
+        if (content.isEmpty())
+            continue;
+
+        auto findWatched = [this, &file]() -> WatchedFile *
+        {
+            for (auto &watched : files)
+                if (watched->file == file)
+                    return watched.get();
+
+            return nullptr;
+        };
+
+        {
+            const juce::ScopedLock sl(lock);
+            auto *watched = findWatched();
+            if (watched == nullptr || content == watched->lastContent)
+                continue;
+
+            watched->lastContent = content;
+        }
+
+        // Parsed once here for every instance following the file
+        MidiMap map;
+        auto result = MidiMapSerializer::deserialize(content, map);
+        if (result.failed())
+        {
+            KADMIUM_LOG(warning, "MIDI map {} not reloaded: {}", file.getFileName(), result.getErrorMessage());
+            continue;
+        }
+
+        KADMIUM_LOG(info, "MIDI map {} changed, reloading", file.getFileName());
+
+        const juce::ScopedLock sl(lock);
+        if (auto *watched = findWatched())
+            for (auto *listener : watched->listeners)
+                listener->midiMapFileChanged(file, map);
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <memory>
+#include <vector>
+#include "MidiMap.h"
+
+//==============================================================================
+/**
+ * Follows MIDI map files on disk for every instance in the process.
+ *
+ * One thread serves all instances, and each file is watched and read once
+ * however many instances follow it: an edit is parsed once and the parsed
+ * map handed to each listener. Changes are debounced, since editors save in
+ * several writes or by replacing the file, and a save that leaves the content
+ * unchanged is ignored. On Linux the file's directory is watched with
+ * inotify, so replaced files are seen too; elsewhere the modification time is
+ * polled. The thread starts with the first file followed.
+ */
+class MidiMapFileWatcher : private juce::Thread
+{
+public:
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        // Watcher thread: the file was edited and parsed cleanly
+        virtual void midiMapFileChanged(const juce::File &file, const MidiMap &map) = 0;
+    };
+
+    MidiMapFileWatcher();
+    ~MidiMapFileWatcher() override;
+
+    // Follow a file (one per listener; this replaces any other it followed)
+    void addListener(const juce::File &file, Listener *listener);
+
+    // Stop following; once this returns the listener gets no more callbacks
+    void removeListener(Listener *listener);
+
+    static constexpr int DEBOUNCE_MS = 100;
+    static constexpr int POLL_INTERVAL_MS = 250;
+
+private:
+    struct WatchedFile
+    {
+        juce::File file;
+        juce::Array<Listener *> listeners;
+        juce::String lastContent;
+        juce::Time lastModified;
+        juce::int64 lastSize = 0;
+        double changedAtMs = 0.0; // when the last unhandled change was seen, 0 for none
+        int watchDescriptor = -1; // inotify watch on the parent directory
+    };
+
+    void run() override;
+    void waitForChanges(int timeoutMs);
+    void reloadSettledFiles();
+    void unwatch(WatchedFile &watched);
+
+    // Guards the watched files and their listeners; held while calling back,
+    // so removeListener() waits for a callback in progress
+    juce::CriticalSection lock;
+    std::vector<std::unique_ptr<WatchedFile>> files;
+    int inotifyDescriptor = -1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiMapFileWatcher)
+};
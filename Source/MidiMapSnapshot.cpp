@@ -0,0 +1,347 @@
+#include "MidiMapSnapshot.h"
+#include "MemoryFootprint.h"
+#include "TraceEvents.h"
+
+namespace
+{
+    std::atomic<juce::uint32> nextGeneration{1};
+
+    int findIndex(const std::map<juce::String, int> &indices, const juce::String &key)
+    {
+        auto found = indices.find(key);
+        return found != indices.end() ? found->second : -1;
+    }
+} // namespace
+
+//==============================================================================
+std::unique_ptr<const MidiMapSnapshot> MidiMapSnapshot::compile(MidiMap newMap, FixtureProfileLibrary &fixtureProfiles,
+                                                                NameTable &names, const juce::File &dataDirectory)
+{
+    KADMIUM_TRACE_SPAN("MidiMapSnapshot::compile");
+
+    auto snapshot = std::make_unique<MidiMapSnapshot>();
+    auto &map = snapshot->map;
+    map = std::move(newMap);
+
+    // Parsed strings own their buffers; swap them for the shared copies
+    for (auto *pairs : {&map.groups, &map.attributes})
+    {
+        for (auto &pair : *pairs)
+        {
+            pair.first = names.intern(pair.first);
+            pair.second = names.intern(pair.second);
+        }
+    }
+
+    snapshot->generation = nextGeneration.fetch_add(1, std::memory_order_relaxed);
+    snapshot->numGroups = (int)map.groups.size();
+    snapshot->numAttributes = (int)map.attributes.size();
+
+    // Lookups; the first group or attribute wins if IDs or names repeat
+    for (int group = 0; group < snapshot->numGroups; ++group)
+    {
+        snapshot->groupIdIndices.emplace(map.groups[(size_t)group].first, group);
+        snapshot->groupNameIndices.emplace(map.groups[(size_t)group].second.toLowerCase(), group);
+        snapshot->groupMidiChannels.push_back(juce::jlimit(1, 16, map.groups[(size_t)group].first.getIntValue() + 1)); // 1-based MIDI channel
+    }
+
+    for (int attribute = 0; attribute < snapshot->numAttributes; ++attribute)
+    {
+        const juce::String &attributeId = map.attributes[(size_t)attribute].first;
+        const juce::String &attributeName = map.attributes[(size_t)attribute].second;
+        snapshot->attributeIdIndices.emplace(attributeId, attribute);
+        snapshot->attributeNameIndices.emplace(attributeName.toLowerCase(), attribute);
+        snapshot->parameterIds.add(names.intern(attributeName.toLowerCase().removeCharacters(" ")));
+
+        auto ccNumber = juce::jlimit(0, 127, attributeId.getIntValue());
+        snapshot->attributeCCNumbers.push_back(ccNumber);
+
+        // Pick the encoder specialised for this attribute's type
+        auto encoding = AttributeTypes::createEncoding(map.getAttributeType(attributeId), ccNumber);
+        snapshot->attributeEncodings.push_back(encoding);
+        snapshot->attributeEncoders.push_back(AttributeTypes::getEncodeFunction(encoding.kind));
+
+        if (snapshot->hueAttributeIndex < 0 && encoding.kind == AttributeKind::hue)
+            snapshot->hueAttributeIndex = attribute;
+        else if (snapshot->saturationAttributeIndex < 0 && attributeName.containsIgnoreCase("saturation"))
+            snapshot->saturationAttributeIndex = attribute;
+        else if (snapshot->brightnessAttributeIndex < 0 && encoding.kind == AttributeKind::dimmer)
+            snapshot->brightnessAttributeIndex = attribute;
+    }
+
+    // Topics for every cell, so publishing a change doesn't build strings
+    for (const auto &groupPair : map.groups)
+    {
+        for (const auto &attributePair : map.attributes)
+            snapshot->attributeTopics.add(names.intern("dmx/" + groupPair.second + "/" + attributePair.second));
+    }
+
+    // Fixture profiles; a group whose profile fails to load sends its attributes directly
+    snapshot->groupFixtureIndices.assign((size_t)snapshot->numGroups, -1);
+    for (const auto &fixturePair : map.fixtures)
+    {
+        auto groupIndex = snapshot->getGroupIndex(fixturePair.first);
+        if (groupIndex < 0)
+            continue;
+
+        juce::String errorMessage;
+        auto profile = fixtureProfiles.getProfile(fixturePair.second.profile, fixturePair.second.mode, errorMessage);
+        if (profile == nullptr)
+        {
+            DBG("Failed to load fixture profile for group " + fixturePair.first + ": " + errorMessage);
+            continue;
+        }
+
+        FixtureOutput fixture;
+        fixture.profile = std::move(profile);
+        fixture.groupIndex = groupIndex;
+        fixture.startCC = fixturePair.second.startCC;
+        fixture.firstCell = snapshot->getNumGridCells() + (int)snapshot->fixtureChannelRoutes.size();
+
+        auto midiChannel = snapshot->groupMidiChannels[(size_t)groupIndex];
+        for (size_t channel = 0; channel < fixture.profile->channels.size(); ++channel)
+            snapshot->fixtureChannelRoutes.push_back({midiChannel, juce::jmin(127, fixture.startCC + (int)channel)});
+
+        snapshot->maxFixtureChannels = juce::jmax(snapshot->maxFixtureChannels, fixture.profile->channels.size());
+        snapshot->groupFixtureIndices[(size_t)groupIndex] = (int)snapshot->fixtureOutputs.size();
+        snapshot->fixtureOutputs.push_back(std::move(fixture));
+    }
+
+    // The colour cells of profiled groups are rendered through the profile instead
+    snapshot->fixtureColourCells.assign((size_t)snapshot->getNumGridCells(), 0);
+    for (const auto &fixture : snapshot->fixtureOutputs)
+    {
+        for (auto attribute : {snapshot->hueAttributeIndex, snapshot->saturationAttributeIndex, snapshot->brightnessAttributeIndex})
+        {
+            if (attribute >= 0)
+                snapshot->fixtureColourCells[(size_t)snapshot->getCellIndex(fixture.groupIndex, attribute)] = 1;
+        }
+    }
+
+    // Audio modulation routes, by attribute ID, plus the pixel chase rate
+    for (const auto &modulationPair : map.modulation)
+    {
+        ModulationRoute route;
+        route.source = (AudioAnalyser::Source)juce::jmax(0, AudioAnalyser::getSourceFromName(modulationPair.second.source));
+        route.depth = modulationPair.second.depth;
+        route.additive = modulationPair.second.mode == "add";
+
+        if (modulationPair.first == "chaseRate")
+        {
+            snapshot->chaseRateModulation = route;
+            snapshot->hasChaseRateModulation = true;
+            continue;
+        }
+
+        route.attributeIndex = findIndex(snapshot->attributeIdIndices, modulationPair.first);
+        if (route.attributeIndex >= 0)
+            snapshot->modulationRoutes.push_back(route);
+    }
+
+    // Pixel geometries, with images relative to the data directory
+    for (const auto &pixelPair : map.pixels)
+    {
+        auto groupIndex = snapshot->getGroupIndex(pixelPair.first);
+        if (groupIndex < 0)
+            continue;
+
+        const auto &mapping = pixelPair.second;
+        PixelGeometry geometry;
+        geometry.groupIndex = groupIndex;
+        geometry.width = mapping.width;
+        geometry.height = mapping.height;
+        geometry.serpentine = mapping.serpentine;
+        geometry.universe = mapping.universe;
+        geometry.address = mapping.address;
+        geometry.channelOrder = mapping.order;
+
+        auto &effect = geometry.effect;
+        effect.type = PixelEffect::getTypeFromName(mapping.effect);
+        effect.secondColour = juce::Colour(0xff000000 | (juce::uint32)mapping.colour.trimCharactersAtStart("#").getHexValue32());
+        effect.speed = mapping.speed;
+        effect.scale = mapping.scale;
+        effect.angle = mapping.angle;
+        effect.width = mapping.bandWidth;
+
+        if (effect.type == PixelEffect::Type::image)
+        {
+            auto imageFile = juce::File::isAbsolutePath(mapping.image) ? juce::File(mapping.image) : dataDirectory.getChildFile(mapping.image);
+            effect.image = juce::ImageCache::getFromFile(imageFile); // shared by every snapshot using the file
+            if (!effect.image.isValid())
+                DBG("Failed to load pixel map image for group " + pixelPair.first + ": " + imageFile.getFullPathName());
+        }
+
+        snapshot->pixelGeometries.push_back(std::move(geometry));
+    }
+
+    return snapshot;
+}
+
+size_t MidiMapSnapshot::getMemoryUsage() const
+{
+    using MF = MemoryFootprint;
+
+    // Interned strings are counted by the name table, so the map's groups and attributes only
+    // cost their pairs; tree nodes are counted as their key and value plus three links and a colour
+    constexpr size_t nodeOverhead = 4 * sizeof(void *);
+
+    auto bytes = sizeof(*this) + MF::getHeapBytes(map.groups) + MF::getHeapBytes(map.attributes)
+                 + MF::getHeapBytes(groupMidiChannels) + MF::getHeapBytes(attributeCCNumbers)
+                 + MF::getHeapBytes(attributeEncodings) + MF::getHeapBytes(attributeEncoders)
+                 + MF::getHeapBytes(fixtureOutputs) + MF::getHeapBytes(groupFixtureIndices)
+                 + MF::getHeapBytes(fixtureColourCells) + MF::getHeapBytes(fixtureChannelRoutes)
+                 + MF::getHeapBytes(modulationRoutes) + MF::getHeapBytes(pixelGeometries)
+                 + MF::getHeapBytes(parameterIds) + MF::getHeapBytes(attributeTopics);
+
+    for (const auto *indices : {&groupIdIndices, &groupNameIndices, &attributeIdIndices, &attributeNameIndices})
+    {
+        for (const auto &entry : *indices)
+            bytes += nodeOverhead + sizeof(entry) + MF::getHeapBytes(entry.first);
+    }
+
+    return bytes;
+}
+
+int MidiMapSnapshot::getGroupIndex(const juce::String &groupId) const
+{
+    return findIndex(groupIdIndices, groupId);
+}
+
+int MidiMapSnapshot::findGroup(const juce::String &idOrName) const
+{
+    auto index = findIndex(groupIdIndices, idOrName);
+    return index >= 0 ? index : findIndex(groupNameIndices, idOrName.toLowerCase());
+}
+
+int MidiMapSnapshot::findAttribute(const juce::String &idOrName) const
+{
+    auto index = findIndex(attributeIdIndices, idOrName);
+    return index >= 0 ? index : findIndex(attributeNameIndices, idOrName.toLowerCase());
+}
+
+//==============================================================================
+MidiMapLoader::MidiMapLoader(Callback onLoadedCallback)
+    : juce::Thread("MIDI map loader"),
+      onLoaded(std::move(onLoadedCallback))
+{
+}
+
+MidiMapLoader::~MidiMapLoader()
+{
+    cancelPendingUpdate();
+    signalThreadShouldExit();
+    loadRequested.signal();
+    stopThread(5000);
+}
+
+void MidiMapLoader::loadAsync(const juce::String &jsonString)
+{
+    {
+        const juce::ScopedLock lock(pendingLock);
+        pendingJson = jsonString;
+        hasPendingJson = true;
+        pendingMap.reset();
+        ++requestGeneration;
+
+        // Most instances never load a map from MQTT, so the thread starts with the first one
+        if (!isThreadRunning())
+            startThread(juce::Thread::Priority::background);
+    }
+
+    loadRequested.signal();
+}
+
+void MidiMapLoader::loadAsync(MidiMap map)
+{
+    {
+        const juce::ScopedLock lock(pendingLock);
+        pendingMap = std::move(map);
+        pendingJson = {};
+        hasPendingJson = false;
+        ++requestGeneration;
+
+        if (!isThreadRunning())
+            startThread(juce::Thread::Priority::background);
+    }
+
+    loadRequested.signal();
+}
+
+void MidiMapLoader::cancelPending()
+{
+    const juce::ScopedLock lock(pendingLock);
+    pendingJson = {};
+    hasPendingJson = false;
+    pendingMap.reset();
+    loadedSnapshot.reset();
+    hasLoadedResult = false;
+    ++requestGeneration;
+}
+
+std::unique_ptr<const MidiMapSnapshot> MidiMapLoader::compile(MidiMap map)
+{
+    const juce::ScopedLock lock(sharedResources->compileLock);
+    return MidiMapSnapshot::compile(std::move(map), sharedResources->fixtureProfiles, *names, sharedResources->dataDirectory);
+}
+
+void MidiMapLoader::run()
+{
+    while (!threadShouldExit())
+    {
+        loadRequested.wait();
+
+        juce::String jsonString;
+        std::optional<MidiMap> parsedMap;
+        juce::uint32 generation = 0;
+        {
+            const juce::ScopedLock lock(pendingLock);
+            if (!hasPendingJson && !pendingMap.has_value())
+                continue;
+
+            jsonString = std::move(pendingJson);
+            pendingJson = {};
+            hasPendingJson = false;
+            parsedMap.swap(pendingMap);
+            generation = requestGeneration;
+        }
+
+        MidiMap map;
+        auto result = juce::Result::ok();
+        if (parsedMap.has_value())
+            map = std::move(*parsedMap);
+        else
+            result = MidiMapSerializer::deserialize(jsonString, map);
+        std::unique_ptr<const MidiMapSnapshot> snapshot;
+        if (result.wasOk())
+            snapshot = compile(std::move(map));
+
+        {
+            const juce::ScopedLock lock(pendingLock);
+            if (generation != requestGeneration)
+                continue; // Cancelled, or a newer request is already waiting
+
+            loadedSnapshot = std::move(snapshot);
+            loadedResult = result;
+            hasLoadedResult = true;
+        }
+
+        triggerAsyncUpdate();
+    }
+}
+
+void MidiMapLoader::handleAsyncUpdate()
+{
+    std::unique_ptr<const MidiMapSnapshot> snapshot;
+    auto result = juce::Result::ok();
+    {
+        const juce::ScopedLock lock(pendingLock);
+        if (!hasLoadedResult)
+            return;
+
+        snapshot = std::move(loadedSnapshot);
+        result = loadedResult;
+        hasLoadedResult = false;
+    }
+
+    onLoaded(std::move(snapshot), result);
+}
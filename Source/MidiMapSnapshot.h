@@ -0,0 +1,175 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "AttributeTypes.h"
+#include "AudioAnalyser.h"
+#include "FixtureProfile.h"
+#include "MidiMap.h"
+#include "NameTable.h"
+#include "PixelMapEngine.h"
+
+//==============================================================================
+/**
+ * A MIDI map compiled into everything the output paths read: MIDI routing,
+ * fixture profiles, modulation routes, pixel geometries and the MQTT topic
+ * and lookup caches.
+ *
+ * Snapshots are built in full, then published through an RcuPointer and
+ * never modified again, so any thread can read one without locking. Names,
+ * IDs and topics are interned in the process-wide NameTable, so instances
+ * running the same map share one copy of each.
+ * Grids sized from a snapshot record its generation; readers compare
+ * generations to tell whether the two belong together.
+ */
+struct MidiMapSnapshot
+{
+    // Groups with a fixture profile send the profile's channels (scheduler cells after
+    // the grid) in place of their hue, saturation and brightness CCs
+    struct FixtureOutput
+    {
+        std::shared_ptr<const FixtureProfile> profile;
+        int groupIndex = 0;
+        int startCC = 0;
+        int firstCell = 0; // scheduler cell of the profile's first channel
+    };
+
+    struct FixtureChannelRoute
+    {
+        int midiChannel = 1;
+        int ccNumber = 0;
+    };
+
+    struct ModulationRoute
+    {
+        int attributeIndex = 0;
+        AudioAnalyser::Source source = AudioAnalyser::level;
+        float depth = 1.0f;
+        bool additive = false;
+    };
+
+    MidiMap map;
+    juce::uint32 generation = 0; // unique per compiled snapshot
+
+    int numGroups = 0;
+    int numAttributes = 0;
+    int getCellIndex(int group, int attribute) const noexcept { return group * numAttributes + attribute; }
+    int getNumGridCells() const noexcept { return numGroups * numAttributes; }
+
+    // Output routing
+    std::vector<int> groupMidiChannels;                            // per group index
+    std::vector<int> attributeCCNumbers;                           // per attribute index
+    std::vector<AttributeEncoding> attributeEncodings;             // per attribute index
+    std::vector<AttributeTypes::EncodeFunction> attributeEncoders; // per attribute index, specialised per kind
+    int hueAttributeIndex = -1;
+    int saturationAttributeIndex = -1;
+    int brightnessAttributeIndex = -1;
+
+    // Fixture profiles
+    std::vector<FixtureOutput> fixtureOutputs;
+    std::vector<int> groupFixtureIndices;                  // per group index, -1 without a profile
+    std::vector<juce::uint8> fixtureColourCells;           // per grid cell, 1 when a profile renders it
+    std::vector<FixtureChannelRoute> fixtureChannelRoutes; // per scheduler cell after the grid
+    size_t maxFixtureChannels = 0;
+    int getNumOutputCells() const noexcept { return getNumGridCells() + (int)fixtureChannelRoutes.size(); }
+
+    // Audio modulation routes, by attribute, plus the pixel chase rate
+    std::vector<ModulationRoute> modulationRoutes;
+    ModulationRoute chaseRateModulation;
+    bool hasChaseRateModulation = false;
+
+    // Pixel-mapped groups, with their images loaded
+    std::vector<PixelGeometry> pixelGeometries;
+
+    // Parameter ID per attribute index: the name, lowercased without spaces
+    juce::StringArray parameterIds;
+
+    // MQTT caches: dmx/<group name>/<attribute name> per grid cell, and command lookups
+    juce::StringArray attributeTopics;
+    int getGroupIndex(const juce::String &groupId) const;  // -1 if unknown
+    int findGroup(const juce::String &idOrName) const;     // ID, then case-insensitive name
+    int findAttribute(const juce::String &idOrName) const; // ID, then case-insensitive name
+
+    // Heap bytes held, counting the object itself but not the shared names, profiles and images
+    size_t getMemoryUsage() const;
+
+    // Compile a parsed map. Loads fixture profiles and pixel images, so it may touch the disk.
+    static std::unique_ptr<const MidiMapSnapshot> compile(MidiMap map, FixtureProfileLibrary &fixtureProfiles,
+                                                          NameTable &names, const juce::File &dataDirectory);
+
+private:
+    std::map<juce::String, int> groupIdIndices, groupNameIndices;
+    std::map<juce::String, int> attributeIdIndices, attributeNameIndices;
+};
+
+//==============================================================================
+/**
+ * Parses and compiles MIDI maps off the message thread.
+ *
+ * loadAsync() may be called from any thread (e.g. the MQTT callback). The
+ * JSON (or an already parsed map) is compiled on the loader's own thread, and the finished
+ * snapshot is handed to the callback on the message thread. A map still
+ * waiting to be parsed, or a result not yet delivered, is replaced by a
+ * newer one, so a burst of maps costs one compile. The thread is started by
+ * the first loadAsync(). Every loader in the process compiles against the
+ * same fixture profile library and name table.
+ */
+class MidiMapLoader : private juce::Thread,
+                      private juce::AsyncUpdater
+{
+public:
+    // Message thread: the compiled map, or a failed result and no snapshot
+    using Callback = std::function<void(std::unique_ptr<const MidiMapSnapshot> snapshot, const juce::Result &result)>;
+
+    explicit MidiMapLoader(Callback onLoaded);
+    ~MidiMapLoader() override;
+
+    // Queue a JSON map for the background thread (any thread)
+    void loadAsync(const juce::String &jsonString);
+
+    // Queue a map parsed elsewhere, e.g. once for every instance following a file (any thread)
+    void loadAsync(MidiMap map);
+
+    // Drop the queued map, any compile in progress and any result not yet delivered,
+    // e.g. once a map has been loaded some other way (any thread)
+    void cancelPending();
+
+    // Compile on the calling thread, e.g. for maps loaded from the editor or the constructor
+    std::unique_ptr<const MidiMapSnapshot> compile(MidiMap map);
+
+private:
+    void run() override;
+    void handleAsyncUpdate() override;
+
+    Callback onLoaded;
+
+    // Shared by every loader, so each profile is parsed and held once. The profile
+    // library caches and is not thread-safe, so compiles are serialised.
+    struct SharedResources
+    {
+        FixtureProfileLibrary fixtureProfiles;
+        juce::File dataDirectory{juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory).getChildFile("KadmiumDMX")};
+        juce::CriticalSection compileLock;
+    };
+    juce::SharedResourcePointer<SharedResources> sharedResources;
+    juce::SharedResourcePointer<NameTable> names;
+
+    // Newest request and newest result, each replaced by the next. Each request and
+    // cancellation bumps the generation, so a compile started before it is dropped.
+    juce::CriticalSection pendingLock;
+    juce::uint32 requestGeneration = 0;
+    juce::String pendingJson;
+    bool hasPendingJson = false;
+    std::optional<MidiMap> pendingMap;
+    std::unique_ptr<const MidiMapSnapshot> loadedSnapshot;
+    juce::Result loadedResult = juce::Result::ok();
+    bool hasLoadedResult = false;
+    juce::WaitableEvent loadRequested;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiMapLoader)
+};
@@ -0,0 +1,91 @@
+#include "MidiOutputScheduler.h"
+#include "MemoryFootprint.h"
+
+//==============================================================================
+void MidiOutputScheduler::prepare(int numCells)
+{
+    numCells = juce::jmax(0, numCells);
+
+    pending.assign((size_t)numCells, 0);
+    cellPriorities.assign((size_t)numCells, (juce::uint8)normalPriority);
+    messageCounts.assign((size_t)numCells, 1);
+    values.assign((size_t)numCells, 0);
+    originStamps.assign((size_t)numCells, 0);
+
+    for (auto &queue : queues)
+    {
+        queue.cells.assign((size_t)numCells, 0);
+        queue.head = 0;
+        queue.size = 0;
+    }
+
+    numPending = 0;
+    busyUntilSeconds = 0.0;
+}
+
+void MidiOutputScheduler::setCellPriority(int cell, Priority priority)
+{
+    if (cell >= 0 && cell < (int)cellPriorities.size() && priority >= 0 && priority < numPriorities)
+        cellPriorities[(size_t)cell] = (juce::uint8)priority;
+}
+
+void MidiOutputScheduler::setCellMessageCount(int cell, int numMessages)
+{
+    if (cell >= 0 && cell < (int)messageCounts.size())
+        messageCounts[(size_t)cell] = (juce::uint8)juce::jlimit(1, 255, numMessages);
+}
+
+//==============================================================================
+bool MidiOutputScheduler::enqueue(int cell, int value, juce::int64 originTicks) noexcept
+{
+    if (cell < 0 || cell >= (int)pending.size())
+        return false;
+
+    values[(size_t)cell] = value;
+
+    // Already waiting: the new value takes its place in the queue
+    if (pending[(size_t)cell] != 0)
+        return true;
+
+    // Latency is measured from the first change the event carries
+    originStamps[(size_t)cell] = originTicks;
+
+    auto priority = cellPriorities[(size_t)cell];
+    auto &queue = queues[(size_t)priority];
+    queue.cells[(size_t)((queue.head + queue.size) % (int)queue.cells.size())] = cell;
+    ++queue.size;
+
+    pending[(size_t)cell] = 1;
+    ++numPending;
+    return false;
+}
+
+void MidiOutputScheduler::occupyLink(int numEvents) noexcept
+{
+    if (bytesPerSecond > 0.0 && numEvents > 0)
+        busyUntilSeconds += numEvents * bytesPerControlChange / bytesPerSecond;
+}
+
+int MidiOutputScheduler::pop(int priority) noexcept
+{
+    auto &queue = queues[(size_t)priority];
+    auto cell = queue.cells[(size_t)queue.head];
+    queue.head = (queue.head + 1) % (int)queue.cells.size();
+    --queue.size;
+
+    pending[(size_t)cell] = 0;
+    --numPending;
+    return cell;
+}
+
+size_t MidiOutputScheduler::getMemoryUsage() const
+{
+    using MF = MemoryFootprint;
+    auto bytes = MF::getHeapBytes(pending) + MF::getHeapBytes(cellPriorities) + MF::getHeapBytes(messageCounts)
+                 + MF::getHeapBytes(values) + MF::getHeapBytes(originStamps);
+
+    for (const auto &queue : queues)
+        bytes += MF::getHeapBytes(queue.cells);
+
+    return bytes;
+}
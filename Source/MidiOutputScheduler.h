@@ -0,0 +1,113 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <vector>
+
+//==============================================================================
+/**
+ * Paces CC output to the bandwidth of the MIDI link.
+ *
+ * A 31.25 kbaud DIN link carries 3125 bytes a second (10 bits per byte), so
+ * about a thousand 3-byte CCs. Each output cell (group x attribute) has at
+ * most one pending value: enqueuing a cell that is still waiting replaces its
+ * value in place, so superseded values never reach the wire. Every block,
+ * pending cells are sent highest priority first, oldest first within a
+ * priority, only as long as the modelled link is free, and each event is
+ * placed at the sample where the link becomes free so bursts are spread out.
+ *
+ * Single-threaded: owned and driven by the audio thread (under the owner's
+ * lock for reconfiguration).
+ */
+class MidiOutputScheduler
+{
+public:
+    enum Priority
+    {
+        lowPriority,
+        normalPriority,
+        highPriority,
+        numPriorities
+    };
+
+    static constexpr double dinBytesPerSecond = 31250.0 / 10.0;
+    static constexpr int bytesPerControlChange = 3;
+
+    MidiOutputScheduler() = default;
+
+    // Configuration
+    void prepare(int numCells);
+    void setCellPriority(int cell, Priority priority);
+    void setCellMessageCount(int cell, int numMessages); // CCs one value takes (2 for 14-bit)
+    void setBytesPerSecond(double newBytesPerSecond) { bytesPerSecond = newBytesPerSecond; } // 0 = unlimited
+    double getBytesPerSecond() const { return bytesPerSecond; }
+
+    // Queue a value for a cell. Returns true if it replaced a value still waiting.
+    bool enqueue(int cell, int value, juce::int64 originTicks) noexcept;
+
+    // Account for CCs sent at the start of the block outside the scheduler
+    void occupyLink(int numEvents) noexcept;
+
+    // Send as much as the link allows in this block. emit(cell, value,
+    // originTicks, samplePosition) is called for every event, in time order.
+    // Returns the time the link was busy during the block, in seconds.
+    template <typename EmitFunction>
+    double render(int numSamples, double sampleRate, EmitFunction &&emit) noexcept;
+
+    int getNumPending() const { return numPending; }
+
+    // Heap bytes held, not counting the object itself (message thread)
+    size_t getMemoryUsage() const;
+
+private:
+    int pop(int priority) noexcept;
+
+    double bytesPerSecond = dinBytesPerSecond;
+    double busyUntilSeconds = 0.0; // relative to the start of the next block
+
+    // Per-cell state
+    std::vector<juce::uint8> pending;
+    std::vector<juce::uint8> cellPriorities;
+    std::vector<juce::uint8> messageCounts;
+    std::vector<int> values;
+    std::vector<juce::int64> originStamps;
+
+    // One FIFO of cell indices per priority; each cell appears at most once
+    struct CellQueue
+    {
+        std::vector<int> cells;
+        int head = 0;
+        int size = 0;
+    };
+    std::array<CellQueue, numPriorities> queues;
+    int numPending = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiOutputScheduler)
+};
+
+//==============================================================================
+template <typename EmitFunction>
+double MidiOutputScheduler::render(int numSamples, double sampleRate, EmitFunction &&emit) noexcept
+{
+    if (numSamples <= 0 || sampleRate <= 0.0)
+        return 0.0;
+
+    auto blockSeconds = (double)numSamples / sampleRate;
+    auto secondsPerEvent = bytesPerSecond > 0.0 ? bytesPerControlChange / bytesPerSecond : 0.0;
+
+    for (int priority = numPriorities - 1; priority >= 0; --priority)
+    {
+        while (queues[(size_t)priority].size > 0 && busyUntilSeconds < blockSeconds)
+        {
+            auto cell = pop(priority);
+            auto samplePosition = juce::jlimit(0, numSamples - 1, (int)(busyUntilSeconds * sampleRate));
+            emit(cell, values[(size_t)cell], originStamps[(size_t)cell], samplePosition);
+            busyUntilSeconds += secondsPerEvent * messageCounts[(size_t)cell];
+        }
+    }
+
+    // Events go back to back from the start of the block, so the busy time is one span
+    auto busySeconds = juce::jmin(busyUntilSeconds, blockSeconds);
+    busyUntilSeconds = juce::jmax(0.0, busyUntilSeconds - blockSeconds);
+    return busySeconds;
+}
@@ -1,9 +1,24 @@
 #include "MqttClient.h"
+#include "EventLog.h"
+#include "TraceEvents.h"
+
+namespace
+{
+    // Paho calls back on threads of its own, which JUCE can't name
+    void nameCallbackThread()
+    {
+        if (TraceEvents::isEnabled())
+            TraceEvents::nameCurrentThread("Paho MQTT callbacks");
+    }
+} // namespace
 
 //==============================================================================
 MqttClient::MqttClient() : juce::Thread("MqttClient"), client(nullptr)
 {
-    DBG("MqttClient created (Eclipse Paho C implementation)");
+    for (auto &delivery : pendingDeliveries)
+        delivery.owner = this;
+
+    KADMIUM_LOG(debug, "MqttClient created (Eclipse Paho C implementation)");
 }
 
 MqttClient::~MqttClient()
@@ -30,7 +45,7 @@ void MqttClient::connect(const juce::String &brokerUrl,
 
     shouldConnect = true;
 
-    DBG("MQTT Connect requested to: " + brokerUrl);
+    KADMIUM_LOG(info, "MQTT Connect requested to: {}", brokerUrl);
 
     if (!isThreadRunning())
     {
@@ -50,14 +65,15 @@ void MqttClient::disconnect()
         isConnected = false;
     }
 
-    DBG("MQTT Disconnect requested");
+    KADMIUM_LOG(info, "MQTT Disconnect requested");
 }
 
 void MqttClient::subscribe(const juce::String &topic)
 {
     if (!isConnected.load() || !client)
     {
-        DBG("MQTT not connected, cannot subscribe to: " + topic);
+        countEvent(RuntimeMetrics::Counter::mqttSubscribeErrors);
+        KADMIUM_LOG(warning, "MQTT not connected, cannot subscribe to: {}", topic);
         return;
     }
 
@@ -66,13 +82,14 @@ void MqttClient::subscribe(const juce::String &topic)
 
     if (rc == MQTTASYNC_SUCCESS)
     {
-        DBG("MQTT subscribed to: " + topic);
+        KADMIUM_LOG(info, "MQTT subscribed to: {}", topic);
         juce::ScopedLock lock(subscriptionsMutex);
         subscribedTopics.add(topic);
     }
     else
     {
-        DBG("MQTT subscribe error: " + juce::String(rc));
+        countEvent(RuntimeMetrics::Counter::mqttSubscribeErrors);
+        KADMIUM_LOG(error, "MQTT subscribe error: {}", rc);
     }
 }
 
@@ -86,21 +103,25 @@ void MqttClient::unsubscribe(const juce::String &topic)
 
     if (rc == MQTTASYNC_SUCCESS)
     {
-        DBG("MQTT unsubscribed from: " + topic);
+        KADMIUM_LOG(info, "MQTT unsubscribed from: {}", topic);
         juce::ScopedLock lock(subscriptionsMutex);
         subscribedTopics.removeString(topic);
     }
     else
     {
-        DBG("MQTT unsubscribe error: " + juce::String(rc));
+        KADMIUM_LOG(error, "MQTT unsubscribe error: {}", rc);
     }
 }
 
-void MqttClient::publish(const juce::String &topic, const juce::String &message, int qos, bool retain)
+void MqttClient::publish(const juce::String &topic, const juce::String &message, int qos, bool retain,
+                         juce::int64 originTicks)
 {
+    KADMIUM_TRACE_SPAN("MqttClient::publish");
+
     if (!isConnected.load() || !client)
     {
-        DBG("MQTT not connected, cannot publish to: " + topic);
+        countEvent(RuntimeMetrics::Counter::mqttPublishFailures);
+        KADMIUM_LOG(debug, "MQTT not connected, cannot publish to: {}", topic);
         return;
     }
 
@@ -113,15 +134,50 @@ void MqttClient::publish(const juce::String &topic, const juce::String &message,
     pubmsg.qos = qos;
     pubmsg.retained = retain ? 1 : 0;
 
+    // Claim a delivery slot so the response callback can time the round trip
+    PendingDelivery *delivery = nullptr;
+    juce::uint32 sequence = 0;
+    if (latencyMonitor != nullptr)
+    {
+        auto count = nextPendingDelivery.fetch_add(1, std::memory_order_relaxed);
+        delivery = &pendingDeliveries[count % (juce::uint32)MAX_PENDING_DELIVERIES];
+        sequence = count + 1 != 0 ? count + 1 : 1;
+
+        // Retire the slot's previous use before overwriting its times. The time stores
+        // are releases so a reader that sees a new time also sees the retired sequence.
+        auto sentTicks = LatencyMonitor::now();
+        delivery->sequence.store(0, std::memory_order_relaxed);
+        delivery->token.store(0, std::memory_order_relaxed);
+        delivery->originTicks.store(originTicks, std::memory_order_release);
+        delivery->sentTicks.store(sentTicks, std::memory_order_release);
+        delivery->sequence.store(sequence, std::memory_order_release);
+
+        latencyMonitor->record(LatencyMonitor::Stage::parameterToMqttSend, originTicks, sentTicks);
+
+        opts.onSuccess = onPublishSuccess;
+        opts.context = delivery;
+    }
+
     int rc = MQTTAsync_sendMessage(client, topic.toRawUTF8(), &pubmsg, &opts);
 
     if (rc == MQTTASYNC_SUCCESS)
     {
-        DBG("MQTT published to '" + topic + "': " + message);
+        if (delivery != nullptr)
+            delivery->token.store(opts.token, std::memory_order_release);
+
+        countEvent(RuntimeMetrics::Counter::mqttPublishes);
+
+        KADMIUM_LOG(debug, "MQTT published to '{}': {}", topic, message);
     }
     else
     {
-        DBG("MQTT publish error: " + juce::String(rc));
+        // Leave the slot alone if a newer publish has already taken it
+        if (delivery != nullptr)
+            delivery->sequence.compare_exchange_strong(sequence, 0, std::memory_order_acq_rel);
+
+        countEvent(RuntimeMetrics::Counter::mqttPublishFailures);
+
+        KADMIUM_LOG(warning, "MQTT publish error: {}", rc);
     }
 }
 
@@ -145,12 +201,13 @@ juce::StringArray MqttClient::getSubscribedTopics() const
 //==============================================================================
 void MqttClient::run()
 {
-    DBG("MQTT Client thread started (Eclipse Paho C implementation)");
+    KADMIUM_LOG(debug, "MQTT Client thread started (Eclipse Paho C implementation)");
 
     while (!threadShouldExit())
     {
         if (shouldConnect.load() && !isConnected.load())
         {
+            countEvent(RuntimeMetrics::Counter::mqttReconnectAttempts);
             attemptConnection();
         }
 
@@ -158,7 +215,7 @@ void MqttClient::run()
         wait(1000);
     }
 
-    DBG("MQTT Client thread stopped");
+    KADMIUM_LOG(debug, "MQTT Client thread stopped");
 }
 
 void MqttClient::attemptConnection()
@@ -171,7 +228,7 @@ void MqttClient::attemptConnection()
     int rc = MQTTAsync_create(&client, brokerUrl.toRawUTF8(), clientId.toRawUTF8(), MQTTCLIENT_PERSISTENCE_NONE, nullptr);
     if (rc != MQTTASYNC_SUCCESS)
     {
-        DBG("MQTT Client creation failed: " + juce::String(rc));
+        KADMIUM_LOG(error, "MQTT Client creation failed: {}", rc);
         handleConnectionResult(false, "Client creation failed: " + juce::String(rc));
         return;
     }
@@ -196,11 +253,11 @@ void MqttClient::attemptConnection()
         }
     }
 
-    DBG("MQTT attempting connection to: " + brokerUrl);
+    KADMIUM_LOG(info, "MQTT attempting connection to: {}", brokerUrl);
     rc = MQTTAsync_connect(client, &conn_opts);
     if (rc != MQTTASYNC_SUCCESS)
     {
-        DBG("MQTT connection attempt failed: " + juce::String(rc));
+        KADMIUM_LOG(warning, "MQTT connection attempt failed: {}", rc);
         handleConnectionResult(false, "Connection attempt failed: " + juce::String(rc));
     }
 }
@@ -209,11 +266,14 @@ void MqttClient::attemptConnection()
 // Static callback functions
 void MqttClient::onConnectionLost(void *context, char *cause)
 {
+    KADMIUM_TRACE_SPAN("MqttClient::onConnectionLost");
+    nameCallbackThread();
+
     auto *mqttClient = static_cast<MqttClient *>(context);
     if (mqttClient)
     {
         juce::String causeStr = cause ? juce::String(cause) : "Unknown reason";
-        DBG("MQTT connection lost: " + causeStr);
+        KADMIUM_LOG(warning, "MQTT connection lost: {}", causeStr);
         mqttClient->isConnected = false;
         mqttClient->handleConnectionResult(false, "Connection lost: " + causeStr);
     }
@@ -221,13 +281,17 @@ void MqttClient::onConnectionLost(void *context, char *cause)
 
 int MqttClient::onMessageArrived(void *context, char *topicName, int topicLen, MQTTAsync_message *message)
 {
+    KADMIUM_TRACE_SPAN("MqttClient::onMessageArrived");
+    nameCallbackThread();
+
     auto *mqttClient = static_cast<MqttClient *>(context);
     if (mqttClient && topicName && message)
     {
         juce::String topic(topicName, topicLen > 0 ? topicLen : strlen(topicName));
         juce::String msg(static_cast<char *>(message->payload), message->payloadlen);
 
-        DBG("MQTT message received on '" + topic + "': " + msg);
+        KADMIUM_LOG(debug, "MQTT message received on '{}': {}", topic, msg);
+        mqttClient->countEvent(RuntimeMetrics::Counter::mqttMessagesReceived);
         mqttClient->handleMessage(topic, msg);
 
         MQTTAsync_freeMessage(&message);
@@ -238,15 +302,45 @@ int MqttClient::onMessageArrived(void *context, char *topicName, int topicLen, M
 
 void MqttClient::onDeliveryComplete(void *context, MQTTAsync_token token)
 {
-    DBG("MQTT message delivery complete (token: " + juce::String(token) + ")");
+    KADMIUM_TRACE_SPAN("MqttClient::onDeliveryComplete");
+    nameCallbackThread();
+
+    // Only fires for QoS > 0; QoS 0 publishes complete through onPublishSuccess
+    auto *mqttClient = static_cast<MqttClient *>(context);
+    if (mqttClient && mqttClient->latencyMonitor != nullptr)
+    {
+        for (auto &delivery : mqttClient->pendingDeliveries)
+        {
+            if (delivery.sequence.load(std::memory_order_acquire) != 0 && delivery.token.load(std::memory_order_acquire) == token)
+            {
+                mqttClient->completeDelivery(delivery, token);
+                break;
+            }
+        }
+    }
+}
+
+void MqttClient::onPublishSuccess(void *context, MQTTAsync_successData *response)
+{
+    KADMIUM_TRACE_SPAN("MqttClient::onPublishSuccess");
+    nameCallbackThread();
+
+    auto *delivery = static_cast<PendingDelivery *>(context);
+    if (delivery && delivery->owner)
+    {
+        delivery->owner->completeDelivery(*delivery, response != nullptr ? response->token : 0);
+    }
 }
 
 void MqttClient::onConnectSuccess(void *context, MQTTAsync_successData *response)
 {
+    KADMIUM_TRACE_SPAN("MqttClient::onConnectSuccess");
+    nameCallbackThread();
+
     auto *mqttClient = static_cast<MqttClient *>(context);
     if (mqttClient)
     {
-        DBG("MQTT connection successful");
+        KADMIUM_LOG(info, "MQTT connection successful");
         mqttClient->isConnected = true;
         mqttClient->handleConnectionResult(true);
     }
@@ -254,11 +348,14 @@ void MqttClient::onConnectSuccess(void *context, MQTTAsync_successData *response
 
 void MqttClient::onConnectFailure(void *context, MQTTAsync_failureData *response)
 {
+    KADMIUM_TRACE_SPAN("MqttClient::onConnectFailure");
+    nameCallbackThread();
+
     auto *mqttClient = static_cast<MqttClient *>(context);
     if (mqttClient)
     {
         juce::String error = response ? "Error code: " + juce::String(response->code) : "Unknown error";
-        DBG("MQTT connection failed: " + error);
+        KADMIUM_LOG(warning, "MQTT connection failed: {}", error);
         mqttClient->handleConnectionResult(false, error);
     }
 }
@@ -279,3 +376,35 @@ void MqttClient::handleMessage(const juce::String &topic, const juce::String &me
         messageCallback(topic, message);
     }
 }
+
+void MqttClient::completeDelivery(PendingDelivery &delivery, MQTTAsync_token token)
+{
+    // A token that doesn't match belongs to an earlier use of the slot (the token may
+    // not be stored yet when the success callback is quick)
+    auto sequence = delivery.sequence.load(std::memory_order_acquire);
+    auto slotToken = delivery.token.load(std::memory_order_acquire);
+    if (sequence == 0 || (token != 0 && slotToken != 0 && token != slotToken))
+        return;
+
+    auto originTicks = delivery.originTicks.load(std::memory_order_acquire);
+    auto sentTicks = delivery.sentTicks.load(std::memory_order_acquire);
+
+    // Whichever of the delivery callbacks arrives first claims the slot. This fails if a
+    // newer publish reused it meanwhile: acquiring a time it wrote makes its reset of the
+    // sequence visible to the exchange below.
+    if (!delivery.sequence.compare_exchange_strong(sequence, 0, std::memory_order_acq_rel))
+        return;
+
+    if (latencyMonitor != nullptr)
+    {
+        auto deliveredTicks = LatencyMonitor::now();
+        latencyMonitor->record(LatencyMonitor::Stage::mqttSendToDelivery, sentTicks, deliveredTicks);
+        latencyMonitor->record(LatencyMonitor::Stage::parameterToMqttDelivery, originTicks, deliveredTicks);
+    }
+}
+
+void MqttClient::countEvent(RuntimeMetrics::Counter counter)
+{
+    if (runtimeMetrics != nullptr)
+        runtimeMetrics->increment(counter);
+}
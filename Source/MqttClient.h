@@ -1,9 +1,12 @@
 #pragma once
 
 #include <juce_core/juce_core.h>
+#include <array>
 #include <functional>
 #include <memory>
 #include <MQTTAsync.h>
+#include "LatencyMonitor.h"
+#include "RuntimeMetrics.h"
 
 //==============================================================================
 /**
@@ -30,8 +33,9 @@ public:
                  const juce::String &password = "");
     void disconnect();
 
-    // Publishing
-    void publish(const juce::String &topic, const juce::String &message, int qos = 0, bool retain = false);
+    // Publishing (originTicks is the LatencyMonitor timestamp of the change that caused the publish)
+    void publish(const juce::String &topic, const juce::String &message, int qos = 0, bool retain = false,
+                 juce::int64 originTicks = 0);
 
     // Subscription
     void subscribe(const juce::String &topic);
@@ -41,6 +45,12 @@ public:
     void setConnectionCallback(ConnectionCallback callback);
     void setMessageCallback(MessageCallback callback);
 
+    // Latency instrumentation (the monitor must outlive this client)
+    void setLatencyMonitor(LatencyMonitor *monitor) { latencyMonitor = monitor; }
+
+    // Runtime counters (the metrics object must outlive this client)
+    void setRuntimeMetrics(RuntimeMetrics *metrics) { runtimeMetrics = metrics; }
+
     // Status
     bool getConnectionStatus() const { return isConnected.load(); }
     juce::StringArray getSubscribedTopics() const;
@@ -70,10 +80,29 @@ private:
     juce::StringArray subscribedTopics;
     mutable juce::CriticalSection subscriptionsMutex;
 
+    // In-flight publishes, tracked so delivery can be timed against the send. Slots are
+    // reused round the ring; each use gets a new sequence (0 when idle), so a late
+    // completion for an earlier use fails to claim the slot and is dropped.
+    struct PendingDelivery
+    {
+        MqttClient *owner = nullptr;
+        std::atomic<juce::uint32> sequence{0};
+        std::atomic<MQTTAsync_token> token{0};
+        std::atomic<juce::int64> originTicks{0};
+        std::atomic<juce::int64> sentTicks{0};
+    };
+
+    static constexpr int MAX_PENDING_DELIVERIES = 1024;
+    std::array<PendingDelivery, MAX_PENDING_DELIVERIES> pendingDeliveries;
+    std::atomic<juce::uint32> nextPendingDelivery{0};
+    LatencyMonitor *latencyMonitor = nullptr;
+    RuntimeMetrics *runtimeMetrics = nullptr;
+
     // Paho C callback functions (static)
     static void onConnectionLost(void *context, char *cause);
     static int onMessageArrived(void *context, char *topicName, int topicLen, MQTTAsync_message *message);
     static void onDeliveryComplete(void *context, MQTTAsync_token token);
+    static void onPublishSuccess(void *context, MQTTAsync_successData *response);
 
     // Connection callback handlers
     static void onConnectSuccess(void *context, MQTTAsync_successData *response);
@@ -83,6 +112,8 @@ private:
     void attemptConnection();
     void handleConnectionResult(bool success, const juce::String &error = "");
     void handleMessage(const juce::String &topic, const juce::String &message);
+    void completeDelivery(PendingDelivery &delivery, MQTTAsync_token token);
+    void countEvent(RuntimeMetrics::Counter counter);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MqttClient)
 };
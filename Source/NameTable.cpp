@@ -0,0 +1,45 @@
+#include "NameTable.h"
+#include "MemoryFootprint.h"
+
+//==============================================================================
+juce::String NameTable::intern(const juce::String &text)
+{
+    // The shared empty string needs no pooling
+    if (text.isEmpty())
+        return {};
+
+    const juce::ScopedLock scopedLock(lock);
+    return *names.insert(text).first;
+}
+
+void NameTable::purge()
+{
+    const juce::ScopedLock scopedLock(lock);
+    for (auto it = names.begin(); it != names.end();)
+    {
+        // A count of one is the pool's own reference
+        if (it->getReferenceCount() == 1)
+            it = names.erase(it);
+        else
+            ++it;
+    }
+}
+
+int NameTable::getNumNames() const
+{
+    const juce::ScopedLock scopedLock(lock);
+    return (int)names.size();
+}
+
+size_t NameTable::getMemoryUsage() const
+{
+    // Each entry is a tree node holding one String, plus the buffer it owns
+    constexpr size_t nodeOverhead = 4 * sizeof(void *);
+
+    const juce::ScopedLock scopedLock(lock);
+    size_t bytes = sizeof(*this);
+    for (const auto &name : names)
+        bytes += nodeOverhead + sizeof(juce::String) + MemoryFootprint::getHeapBytes(name);
+
+    return bytes;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <set>
+
+//==============================================================================
+/**
+ * Process-wide pool of the names every instance refers to: group and
+ * attribute names and IDs, parameter IDs and MQTT topics.
+ *
+ * juce::String copies share one reference-counted buffer, so a name interned
+ * here is stored once however many instances, maps and parameters hold it.
+ * Share the pool with juce::SharedResourcePointer<NameTable>. intern() and
+ * purge() are thread-safe; interned strings are never modified.
+ */
+class NameTable
+{
+public:
+    NameTable() = default;
+
+    // The pooled copy of text (adding it if it's new)
+    juce::String intern(const juce::String &text);
+
+    // Drop the names only the pool still refers to
+    void purge();
+
+    // Names held, and the bytes of their buffers
+    int getNumNames() const;
+    size_t getMemoryUsage() const;
+
+private:
+    mutable juce::CriticalSection lock;
+    std::set<juce::String> names;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NameTable)
+};
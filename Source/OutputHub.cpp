@@ -0,0 +1,252 @@
+#include "OutputHub.h"
+#include "EventLog.h"
+#include "MemoryFootprint.h"
+#include "TraceEvents.h"
+
+//==============================================================================
+OutputHub::OutputHub()
+    : juce::Thread("KadmiumDMX OutputHub")
+{
+    mqttClient.setLatencyMonitor(&latencyMonitor);
+    mqttClient.setRuntimeMetrics(&runtimeMetrics);
+
+    mqttClient.setConnectionCallback([this](bool connected, const juce::String &error)
+                                     { handleConnectionChanged(connected, error); });
+
+    mqttClient.setMessageCallback([this](const juce::String &topic, const juce::String &message)
+                                  { handleMessage(topic, message); });
+
+    // Every instance listens for DMX commands
+    subscriptions.add(COMMAND_TOPIC);
+
+    DBG("OutputHub created");
+}
+
+OutputHub::~OutputHub()
+{
+    stopTimer();
+    signalThreadShouldExit();
+    notify();
+    stopThread(5000);
+
+    if (traceFile != juce::File())
+    {
+        TraceEvents::setEnabled(false);
+        auto result = TraceEvents::exportToFile(traceFile);
+        DBG(result.wasOk() ? "Trace written to " + traceFile.getFullPathName() : result.getErrorMessage());
+    }
+
+    DBG("OutputHub destroyed");
+}
+
+//==============================================================================
+int OutputHub::registerInstance(Instance *instance)
+{
+    const juce::ScopedLock lock(instancesLock);
+
+    // Hosts scanning plugins create hubs that never see an instance register,
+    // so the queues, sender thread and refresh timer wait for the first one
+    if (!started.load(std::memory_order_relaxed))
+    {
+        publishQueue.resize((size_t)PUBLISH_QUEUE_SIZE);
+        publishBatch.reserve((size_t)PUBLISH_QUEUE_SIZE);
+        started.store(true, std::memory_order_release);
+
+        // $KADMIUM_TRACE_FILE traces every instance until the last one is gone
+        auto tracePath = juce::SystemStats::getEnvironmentVariable(TRACE_FILE_VARIABLE, {});
+        if (juce::File::isAbsolutePath(tracePath))
+        {
+            traceFile = juce::File(tracePath);
+            TraceEvents::setEnabled(true);
+        }
+
+        startThread();
+        startTimer(REFRESH_INTERVAL_MS);
+    }
+
+    instances.addIfNotAlreadyThere(instance);
+    return nextInstanceId++;
+}
+
+void OutputHub::unregisterInstance(Instance *instance)
+{
+    // Blocks until any in-flight dispatch to this instance has finished
+    const juce::ScopedLock lock(instancesLock);
+    instances.removeFirstMatchingValue(instance);
+}
+
+int OutputHub::getNumInstances() const
+{
+    const juce::ScopedLock lock(instancesLock);
+    return instances.size();
+}
+
+size_t OutputHub::getMemoryUsage() const
+{
+    using MF = MemoryFootprint;
+
+    // Paho's own buffers aren't visible from here, so the client counts as its object
+    auto bytes = sizeof(*this) + MF::getHeapBytes(publishQueue) + MF::getHeapBytes(publishBatch)
+                 + (size_t)getNumInstances() * sizeof(Instance *);
+
+    const juce::ScopedLock lock(subscriptionsLock);
+    bytes += MF::getHeapBytes(subscriptions);
+    for (const auto &topic : subscriptions)
+        bytes += MF::getHeapBytes(topic);
+
+    // Retained maps can be large, so the last messages are counted in full
+    for (const auto &key : lastMessages.getAllKeys())
+        bytes += MF::getHeapBytes(key) + MF::getHeapBytes(lastMessages[key]);
+
+    return bytes;
+}
+
+//==============================================================================
+void OutputHub::connect(const juce::String &newBrokerUrl)
+{
+    if (newBrokerUrl == brokerUrl)
+        return;
+
+    brokerUrl = newBrokerUrl;
+    mqttClient.connect(brokerUrl, "KadmiumDMXPlugin_" + juce::Uuid().toString());
+}
+
+void OutputHub::subscribe(const juce::String &topic, Instance *requester)
+{
+    juce::String cachedMessage;
+    bool alreadySubscribed = false;
+
+    {
+        const juce::ScopedLock lock(subscriptionsLock);
+        alreadySubscribed = subscriptions.contains(topic);
+
+        if (!alreadySubscribed)
+            subscriptions.add(topic);
+        else
+            cachedMessage = lastMessages[topic];
+    }
+
+    if (!alreadySubscribed)
+    {
+        if (isConnected())
+            mqttClient.subscribe(topic);
+    }
+    else if (requester != nullptr && cachedMessage.isNotEmpty())
+    {
+        // Another instance already holds this subscription: hand over what it saw
+        requester->hubMessageReceived(topic, cachedMessage);
+    }
+}
+
+void OutputHub::publish(const juce::String &topic, const juce::String &payload, juce::int64 originTicks)
+{
+    if (!started.load(std::memory_order_acquire))
+        return;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(publishWriteLock);
+        auto scope = publishFifo.write(1);
+        if (scope.blockSize1 == 0)
+        {
+            runtimeMetrics.increment(RuntimeMetrics::Counter::mqttPublishesDropped);
+            return;
+        }
+
+        auto &pending = publishQueue[(size_t)scope.startIndex1];
+        pending.topic = topic;
+        pending.payload = payload;
+        pending.originTicks = originTicks;
+    }
+
+    notify();
+}
+
+//==============================================================================
+void OutputHub::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(-1);
+        sendPendingPublishes();
+    }
+}
+
+void OutputHub::sendPendingPublishes()
+{
+    KADMIUM_TRACE_SPAN("OutputHub::sendPendingPublishes");
+
+    publishBatch.clear();
+    publishFifo.read(publishFifo.getNumReady()).forEach([this](int index)
+                                                        { publishBatch.push_back(std::move(publishQueue[(size_t)index])); });
+
+    if (publishBatch.empty())
+        return;
+
+    // Merge the batch: only the latest value per topic goes out, in arrival order
+    latestIndexByTopic.clear();
+    for (int i = 0; i < (int)publishBatch.size(); ++i)
+        latestIndexByTopic.set(publishBatch[(size_t)i].topic, i);
+
+    for (int i = 0; i < (int)publishBatch.size(); ++i)
+    {
+        const auto &pending = publishBatch[(size_t)i];
+
+        if (latestIndexByTopic[pending.topic] != i)
+        {
+            runtimeMetrics.increment(RuntimeMetrics::Counter::mqttPublishesCoalesced);
+            continue;
+        }
+
+        if (isConnected())
+            mqttClient.publish(pending.topic, pending.payload, 0, false, pending.originTicks);
+    }
+}
+
+void OutputHub::timerCallback()
+{
+    const juce::ScopedLock lock(instancesLock);
+
+    for (auto *instance : instances)
+        instance->hubRefresh();
+}
+
+//==============================================================================
+void OutputHub::handleConnectionChanged(bool connected, const juce::String &error)
+{
+    if (connected)
+    {
+        KADMIUM_LOG(info, "OutputHub connected, subscribing to shared topics");
+
+        juce::StringArray topics;
+        {
+            const juce::ScopedLock lock(subscriptionsLock);
+            topics = subscriptions;
+        }
+
+        for (const auto &topic : topics)
+            mqttClient.subscribe(topic);
+    }
+    else
+    {
+        KADMIUM_LOG(warning, "OutputHub connection failed: {}", error);
+    }
+
+    const juce::ScopedLock lock(instancesLock);
+
+    for (auto *instance : instances)
+        instance->hubConnectionChanged(connected, error);
+}
+
+void OutputHub::handleMessage(const juce::String &topic, const juce::String &message)
+{
+    {
+        const juce::ScopedLock lock(subscriptionsLock);
+        if (subscriptions.contains(topic))
+            lastMessages.set(topic, message);
+    }
+
+    const juce::ScopedLock lock(instancesLock);
+
+    for (auto *instance : instances)
+        instance->hubMessageReceived(topic, message);
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <juce_events/juce_events.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "LatencyMonitor.h"
+#include "MqttClient.h"
+#include "RuntimeMetrics.h"
+
+//==============================================================================
+/**
+ * Process-wide output hub shared by every plugin instance.
+ *
+ * Held through juce::SharedResourcePointer, so it is created by the first
+ * instance and destroyed with the last. It owns the single MQTT connection,
+ * one sender thread that drains and coalesces every instance's publishes,
+ * and one refresh timer that drives the periodic output of all instances.
+ * Inbound messages are fanned out to the registered instances. The thread,
+ * timer and publish queue start when the first instance registers.
+ */
+class OutputHub : private juce::Thread,
+                  private juce::Timer
+{
+public:
+    //==============================================================================
+    // Implemented by each plugin instance that registers with the hub
+    class Instance
+    {
+    public:
+        virtual ~Instance() = default;
+
+        // Periodic refresh (message thread, every REFRESH_INTERVAL_MS)
+        virtual void hubRefresh() = 0;
+
+        // Inbound MQTT message (MQTT callback thread, or the caller of subscribe for cached replays)
+        virtual void hubMessageReceived(const juce::String &topic, const juce::String &message) = 0;
+
+        // Connection state changes (MQTT callback thread)
+        virtual void hubConnectionChanged(bool connected, const juce::String &error) { juce::ignoreUnused(connected, error); }
+    };
+
+    //==============================================================================
+    OutputHub();
+    ~OutputHub() override;
+
+    // Registration returns a small id, unique for the lifetime of the hub.
+    // The first registration starts the hub.
+    int registerInstance(Instance *instance);
+    void unregisterInstance(Instance *instance);
+    int getNumInstances() const;
+
+    // Connection (the first request wins; later requests for the same broker are no-ops)
+    void connect(const juce::String &brokerUrl);
+    bool isConnected() const { return mqttClient.getConnectionStatus(); }
+
+    // Subscriptions are shared; the last message seen on a subscribed topic is
+    // replayed to instances that subscribe after it arrived
+    void subscribe(const juce::String &topic, Instance *requester = nullptr);
+
+    // Queue a publish for the sender thread (any thread). Publishes to the same
+    // topic that are still queued are coalesced so only the latest is sent.
+    // Ignored until the hub has started.
+    void publish(const juce::String &topic, const juce::String &payload, juce::int64 originTicks = 0);
+
+    // Hand a message to every instance as if it had come from the broker (any thread).
+    // Lets tools drive inbound traffic without a broker.
+    void deliverMessage(const juce::String &topic, const juce::String &message) { handleMessage(topic, message); }
+
+    // Shared connection instrumentation
+    const LatencyMonitor &getLatencyMonitor() const { return latencyMonitor; }
+    const RuntimeMetrics &getRuntimeMetrics() const { return runtimeMetrics; }
+
+    // Bytes held by the hub, including itself
+    size_t getMemoryUsage() const;
+
+    static constexpr int REFRESH_INTERVAL_MS = 5000;
+    static constexpr const char *COMMAND_TOPIC = "dmx/+/command";
+
+private:
+    // juce::Thread (sender) and juce::Timer (refresh scheduler)
+    void run() override;
+    void timerCallback() override;
+
+    void sendPendingPublishes();
+    void handleConnectionChanged(bool connected, const juce::String &error);
+    void handleMessage(const juce::String &topic, const juce::String &message);
+
+    // Declared before the client so they outlive it
+    LatencyMonitor latencyMonitor;
+    RuntimeMetrics runtimeMetrics;
+
+    MqttClient mqttClient;
+    juce::String brokerUrl;
+
+    // Registered instances
+    juce::Array<Instance *> instances;
+    juce::CriticalSection instancesLock;
+    int nextInstanceId = 0;
+    std::atomic<bool> started{false};
+
+    // Span tracing for the whole process, written out when the hub goes away
+    static constexpr const char *TRACE_FILE_VARIABLE = "KADMIUM_TRACE_FILE";
+    juce::File traceFile;
+
+    // Shared subscriptions and the last message seen on each
+    juce::StringArray subscriptions;
+    juce::StringPairArray lastMessages;
+    juce::CriticalSection subscriptionsLock;
+
+    // Publish queue: many producers (spin-locked), one consumer (the sender thread)
+    struct PendingPublish
+    {
+        juce::String topic;
+        juce::String payload;
+        juce::int64 originTicks = 0;
+    };
+
+    static constexpr int PUBLISH_QUEUE_SIZE = 4096;
+    juce::AbstractFifo publishFifo{PUBLISH_QUEUE_SIZE};
+    std::vector<PendingPublish> publishQueue;
+    juce::SpinLock publishWriteLock;
+
+    // Sender-thread scratch space
+    std::vector<PendingPublish> publishBatch;
+    juce::HashMap<juce::String, int> latestIndexByTopic;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutputHub)
+};
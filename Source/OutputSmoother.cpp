@@ -0,0 +1,174 @@
+#include "OutputSmoother.h"
+#include "MemoryFootprint.h"
+#include <cmath>
+
+//==============================================================================
+void OutputSmoother::prepare(int newNumGroups, int newNumAttributes)
+{
+    numGroups = juce::jmax(0, newNumGroups);
+    numAttributes = juce::jmax(0, newNumAttributes);
+
+    attributeModes.assign((size_t)numAttributes, SmoothingMode::none);
+    attributeTimes.assign((size_t)numAttributes, 0.0f);
+
+    auto numCells = (size_t)(numGroups * numAttributes);
+    target.assign(numCells, 0.0f);
+    current.assign(numCells, 0.0f);
+    wasActive.assign(numCells, 0.0f);
+    coefficients.assign(numCells, 1.0f);
+    slewRates.assign(numCells, unlimitedRate);
+    wraps.assign(numCells, 0.0f);
+    anyWraps = false;
+
+    delta.assign(numCells, 0.0f);
+    maxSteps.assign(numCells, 0.0f);
+    minSteps.assign(numCells, 0.0f);
+
+    coefficientBlockSeconds = -1.0;
+    settled = true;
+}
+
+void OutputSmoother::setAttributeSmoothing(int attributeIndex, SmoothingMode mode, float timeMs)
+{
+    if (attributeIndex < 0 || attributeIndex >= numAttributes)
+        return;
+
+    auto timeSeconds = juce::jmax(0.0f, timeMs) / 1000.0f;
+    if (timeSeconds <= 0.0f)
+        mode = SmoothingMode::none;
+
+    attributeModes[(size_t)attributeIndex] = mode;
+    attributeTimes[(size_t)attributeIndex] = timeSeconds;
+
+    // Maximum slew is a fixed rate; linear ramps get theirs whenever the target moves
+    auto rate = mode == SmoothingMode::maxSlew ? 1.0f / timeSeconds : unlimitedRate;
+    for (int group = 0; group < numGroups; ++group)
+        slewRates[(size_t)(group * numAttributes + attributeIndex)] = rate;
+
+    coefficientBlockSeconds = -1.0;
+}
+
+void OutputSmoother::setAttributeWraps(int attributeIndex, bool attributeWraps)
+{
+    if (attributeIndex < 0 || attributeIndex >= numAttributes)
+        return;
+
+    for (int group = 0; group < numGroups; ++group)
+        wraps[(size_t)(group * numAttributes + attributeIndex)] = attributeWraps ? 1.0f : 0.0f;
+
+    anyWraps = anyWraps || attributeWraps;
+}
+
+SmoothingMode OutputSmoother::getModeFromName(const juce::String &name)
+{
+    if (name == "onePole")
+        return SmoothingMode::onePole;
+    if (name == "linear")
+        return SmoothingMode::linearRamp;
+    if (name == "maxSlew")
+        return SmoothingMode::maxSlew;
+
+    return SmoothingMode::none;
+}
+
+//==============================================================================
+void OutputSmoother::setTargets(const float *targets, const float *active) noexcept
+{
+    for (size_t cell = 0; cell < target.size(); ++cell)
+    {
+        auto attribute = (size_t)((int)cell % numAttributes);
+
+        // A newly held cell has nothing to fade from
+        if (active[cell] > 0.5f && wasActive[cell] < 0.5f)
+            current[cell] = targets[cell];
+
+        if (attributeModes[attribute] == SmoothingMode::linearRamp && targets[cell] != target[cell])
+        {
+            auto distance = targets[cell] - current[cell];
+            if (wraps[cell] != 0.0f)
+                distance -= std::round(distance);
+
+            distance = std::abs(distance);
+            slewRates[cell] = juce::jmax(distance / attributeTimes[attribute], 1.0e-6f);
+        }
+
+        target[cell] = targets[cell];
+        wasActive[cell] = active[cell];
+    }
+
+    settled = false;
+}
+
+void OutputSmoother::updateCoefficients(double blockSeconds) noexcept
+{
+    coefficientBlockSeconds = blockSeconds;
+
+    for (int attribute = 0; attribute < numAttributes; ++attribute)
+    {
+        auto coefficient = 1.0f;
+        if (attributeModes[(size_t)attribute] == SmoothingMode::onePole)
+            coefficient = 1.0f - (float)std::exp(-blockSeconds / (double)attributeTimes[(size_t)attribute]);
+
+        for (int group = 0; group < numGroups; ++group)
+            coefficients[(size_t)(group * numAttributes + attribute)] = coefficient;
+    }
+}
+
+bool OutputSmoother::process(double blockSeconds) noexcept
+{
+    using FVO = juce::FloatVectorOperations;
+
+    auto numCells = (int)current.size();
+    if (settled || numCells == 0)
+        return false;
+
+    if (blockSeconds != coefficientBlockSeconds)
+        updateCoefficients(blockSeconds);
+
+    // step = clamp(coefficient * (target - current), -rate * dt, rate * dt)
+    FVO::multiply(maxSteps.data(), slewRates.data(), (float)blockSeconds, numCells);
+    FVO::negate(minSteps.data(), maxSteps.data(), numCells);
+
+    FVO::subtract(delta.data(), target.data(), current.data(), numCells);
+
+    // Hue takes the short way round, e.g. 350 to 10 degrees through red
+    if (anyWraps)
+    {
+        for (size_t cell = 0; cell < (size_t)numCells; ++cell)
+            if (wraps[cell] != 0.0f)
+                delta[cell] -= std::round(delta[cell]);
+    }
+
+    FVO::multiply(delta.data(), coefficients.data(), numCells);
+    FVO::min(delta.data(), delta.data(), maxSteps.data(), numCells);
+    FVO::max(delta.data(), delta.data(), minSteps.data(), numCells);
+    FVO::add(current.data(), delta.data(), numCells);
+
+    if (anyWraps)
+    {
+        for (size_t cell = 0; cell < (size_t)numCells; ++cell)
+            if (wraps[cell] != 0.0f)
+                current[cell] -= std::floor(current[cell]);
+    }
+
+    // Snap the tails so exponential approaches finish
+    settled = true;
+    for (size_t cell = 0; cell < (size_t)numCells; ++cell)
+    {
+        if (std::abs(getDistance(cell, current[cell])) < snapThreshold)
+            current[cell] = target[cell];
+        else
+            settled = false;
+    }
+
+    return true;
+}
+
+size_t OutputSmoother::getMemoryUsage() const
+{
+    using MF = MemoryFootprint;
+    return MF::getHeapBytes(attributeModes) + MF::getHeapBytes(attributeTimes) + MF::getHeapBytes(target)
+           + MF::getHeapBytes(current) + MF::getHeapBytes(wasActive) + MF::getHeapBytes(coefficients)
+           + MF::getHeapBytes(slewRates) + MF::getHeapBytes(wraps) + MF::getHeapBytes(delta)
+           + MF::getHeapBytes(maxSteps) + MF::getHeapBytes(minSteps);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <cmath>
+#include <vector>
+
+//==============================================================================
+/**
+ * How an attribute moves towards a new target value.
+ */
+enum class SmoothingMode
+{
+    none,       // Jump straight to the target
+    onePole,    // Exponential approach with the given time constant
+    linearRamp, // Constant-rate ramp that arrives after the given time
+    maxSlew     // Follow the target, but never faster than full range per given time
+};
+
+//==============================================================================
+/**
+ * Control-rate smoothing for the merged output grid.
+ *
+ * Every mode is expressed as the same per-cell step,
+ * clamp(coefficient * (target - current), -maxStep, maxStep), so one block
+ * advances every cell with a handful of juce::FloatVectorOperations calls
+ * whatever mix of modes the map asks for. Cells snap to their target once
+ * they are within a fraction of a MIDI step, and process() is free once
+ * everything has settled. Wrapping attributes (hue) move the short way round:
+ * their distance to the target is taken modulo a full turn, and the output
+ * is wrapped back into [0, 1).
+ */
+class OutputSmoother
+{
+public:
+    OutputSmoother() = default;
+
+    // Configuration (not thread-safe: call under the owner's lock)
+    void prepare(int numGroups, int numAttributes);
+    void setAttributeSmoothing(int attributeIndex, SmoothingMode mode, float timeMs);
+    void setAttributeWraps(int attributeIndex, bool wraps);
+
+    // Take a new merged frame. Cells that just became active start at their target.
+    void setTargets(const float *targets, const float *active) noexcept;
+
+    // Advance by one block. Returns false (and leaves the output untouched)
+    // when every cell has already settled. Allocation-free.
+    bool process(double blockSeconds) noexcept;
+
+    const float *getOutputValues() const { return current.data(); }
+    bool isSettled() const { return settled; }
+
+    // Heap bytes held, not counting the object itself (message thread)
+    size_t getMemoryUsage() const;
+
+    static SmoothingMode getModeFromName(const juce::String &name);
+
+private:
+    void updateCoefficients(double blockSeconds) noexcept;
+
+    // Distance from value to target, the short way round a turn of 1 for wrapping cells
+    float getDistance(size_t cell, float value) const noexcept
+    {
+        auto distance = target[cell] - value;
+        return wraps[cell] != 0.0f ? distance - std::round(distance) : distance;
+    }
+
+    static constexpr float unlimitedRate = 1.0e6f;
+    static constexpr float snapThreshold = 0.25f / 127.0f; // well inside one quantised MIDI step
+
+    int numGroups = 0;
+    int numAttributes = 0;
+
+    std::vector<SmoothingMode> attributeModes;
+    std::vector<float> attributeTimes; // seconds
+
+    // Per-cell state (structure of arrays)
+    std::vector<float> target;
+    std::vector<float> current;
+    std::vector<float> wasActive;
+    std::vector<float> coefficients; // one-pole coefficient for the current block length, 1 = no filtering
+    std::vector<float> slewRates;    // full-range units per second
+    std::vector<float> wraps;        // 1 for cells of wrapping attributes
+    bool anyWraps = false;
+
+    // Scratch
+    std::vector<float> delta;
+    std::vector<float> maxSteps;
+    std::vector<float> minSteps;
+
+    double coefficientBlockSeconds = -1.0;
+    bool settled = true;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutputSmoother)
+};
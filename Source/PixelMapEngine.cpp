@@ -0,0 +1,501 @@
+#include "PixelMapEngine.h"
+#include "MemoryFootprint.h"
+#include <cmath>
+#include <cstring>
+#include <map>
+
+namespace
+{
+    using FVO = juce::FloatVectorOperations;
+
+    // values = values - floor(values)
+    void wrapToUnit(float *values, int num) noexcept
+    {
+        for (int i = 0; i < num; ++i)
+            values[i] -= std::floor(values[i]);
+    }
+
+    // dest = (x cos a + y sin a) * scale + offset
+    void project(float *dest, const float *xs, const float *ys, float angleDegrees, float scale, float offset, int num) noexcept
+    {
+        auto radians = juce::degreesToRadians(angleDegrees);
+        FVO::multiply(dest, xs, std::cos(radians) * scale, num);
+        FVO::addWithMultiply(dest, ys, std::sin(radians) * scale, num);
+        FVO::add(dest, offset, num);
+    }
+
+    // dest = from + t * (to - from), per channel
+    void blend(float *red, float *green, float *blue, const float *t,
+               juce::Colour from, juce::Colour to, int num) noexcept
+    {
+        auto blendChannel = [t, num](float *dest, float fromValue, float toValue)
+        {
+            FVO::multiply(dest, t, toValue - fromValue, num);
+            FVO::add(dest, fromValue, num);
+        };
+
+        blendChannel(red, from.getFloatRed(), to.getFloatRed());
+        blendChannel(green, from.getFloatGreen(), to.getFloatGreen());
+        blendChannel(blue, from.getFloatBlue(), to.getFloatBlue());
+    }
+
+    // Value noise over a 256 x 256 lattice of fixed random values
+    struct NoiseLattice
+    {
+        std::array<float, 256> values;
+        std::array<juce::uint8, 256> permutation;
+
+        NoiseLattice()
+        {
+            juce::Random random(0x4b444d58);
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                values[i] = random.nextFloat();
+                permutation[i] = (juce::uint8)i;
+            }
+
+            for (size_t i = permutation.size() - 1; i > 0; --i)
+                std::swap(permutation[i], permutation[(size_t)random.nextInt((int)i + 1)]);
+        }
+
+        float at(int x, int y) const noexcept
+        {
+            return values[(size_t)permutation[(size_t)((x + permutation[(size_t)(y & 255)]) & 255)]];
+        }
+    };
+
+    const NoiseLattice &getNoiseLattice()
+    {
+        static const NoiseLattice lattice;
+        return lattice;
+    }
+
+    // dest = smooth value noise at (xs * scale + offset, ys * scale)
+    void sampleNoise(float *dest, const float *xs, const float *ys, float scale, float offset, int num) noexcept
+    {
+        const auto &lattice = getNoiseLattice();
+
+        for (int i = 0; i < num; ++i)
+        {
+            auto x = xs[i] * scale + offset;
+            auto y = ys[i] * scale;
+            auto x0 = std::floor(x);
+            auto y0 = std::floor(y);
+            auto fx = x - x0;
+            auto fy = y - y0;
+            fx = fx * fx * (3.0f - 2.0f * fx);
+            fy = fy * fy * (3.0f - 2.0f * fy);
+
+            auto ix = (int)x0;
+            auto iy = (int)y0;
+            auto top = lattice.at(ix, iy) + fx * (lattice.at(ix + 1, iy) - lattice.at(ix, iy));
+            auto bottom = lattice.at(ix, iy + 1) + fx * (lattice.at(ix + 1, iy + 1) - lattice.at(ix, iy + 1));
+            dest[i] = top + fy * (bottom - top);
+        }
+    }
+
+    std::array<int, PixelMapEngine::CHANNELS_PER_PIXEL> getChannelOffsets(const juce::String &order)
+    {
+        std::array<int, PixelMapEngine::CHANNELS_PER_PIXEL> offsets{0, 1, 2};
+        auto upper = order.toUpperCase();
+
+        if (upper.length() == PixelMapEngine::CHANNELS_PER_PIXEL)
+        {
+            for (size_t i = 0; i < offsets.size(); ++i)
+            {
+                auto index = upper.indexOfChar("RGB"[i]);
+                if (index < 0)
+                    return {0, 1, 2};
+                offsets[i] = index;
+            }
+        }
+
+        return offsets;
+    }
+} // namespace
+
+//==============================================================================
+PixelEffect::Type PixelEffect::getTypeFromName(const juce::String &name)
+{
+    if (name == "gradient")
+        return Type::gradient;
+    if (name == "noise")
+        return Type::noise;
+    if (name == "chase")
+        return Type::chase;
+    if (name == "image")
+        return Type::image;
+
+    return Type::solid;
+}
+
+//==============================================================================
+void PixelMapEngine::prepare(const std::vector<PixelGeometry> &geometries)
+{
+    groups.clear();
+    xs.clear();
+    ys.clear();
+    rows.clear();
+
+    // Universe and address of every pixel, in pixel order
+    std::vector<std::pair<int, int>> pixelAddresses;
+    std::map<int, int> universeIndices;
+
+    for (const auto &geometry : geometries)
+    {
+        GroupState group;
+        group.geometry = geometry;
+        group.geometry.width = juce::jmax(1, geometry.width);
+        group.geometry.height = juce::jmax(1, geometry.height);
+        group.firstPixel = (int)xs.size();
+        group.numPixels = group.geometry.getNumPixels();
+        group.channelOffsets = getChannelOffsets(geometry.channelOrder);
+
+        auto width = group.geometry.width;
+        auto height = group.geometry.height;
+        auto universe = juce::jmax(1, geometry.universe);
+        auto address = juce::jlimit(1, UNIVERSE_SIZE, geometry.address);
+
+        for (int pixel = 0; pixel < group.numPixels; ++pixel)
+        {
+            auto row = pixel / width;
+            auto column = pixel % width;
+            if (group.geometry.serpentine && (row & 1) != 0)
+                column = width - 1 - column;
+
+            xs.push_back(width > 1 ? (float)column / (float)(width - 1) : 0.0f);
+            ys.push_back(height > 1 ? (float)row / (float)(height - 1) : 0.0f);
+            rows.push_back(row);
+
+            if (address + CHANNELS_PER_PIXEL - 1 > UNIVERSE_SIZE)
+            {
+                ++universe;
+                address = 1;
+            }
+
+            pixelAddresses.push_back({universe, address});
+            universeIndices[universe] = 0;
+            address += CHANNELS_PER_PIXEL;
+        }
+
+        // Resample the image once, so rendering it is a table lookup per pixel
+        if (geometry.effect.type == PixelEffect::Type::image && geometry.effect.image.isValid())
+        {
+            const auto &image = geometry.effect.image;
+            group.imageTable.resize((size_t)(imageColumns * height * 3));
+
+            for (int row = 0; row < height; ++row)
+            {
+                auto imageY = juce::jmin(image.getHeight() - 1, row * image.getHeight() / height);
+                for (int column = 0; column < imageColumns; ++column)
+                {
+                    auto colour = image.getPixelAt(column * image.getWidth() / imageColumns, imageY);
+                    auto *entry = group.imageTable.data() + (size_t)((row * imageColumns + column) * 3);
+                    entry[0] = colour.getFloatRed();
+                    entry[1] = colour.getFloatGreen();
+                    entry[2] = colour.getFloatBlue();
+                }
+            }
+        }
+
+        groups.push_back(std::move(group));
+    }
+
+    universeNumbers.clear();
+    for (auto &universe : universeIndices)
+    {
+        universe.second = (int)universeNumbers.size();
+        universeNumbers.push_back(universe.first);
+    }
+
+    pixelOffsets.clear();
+    for (const auto &pixelAddress : pixelAddresses)
+        pixelOffsets.push_back(universeIndices[pixelAddress.first] * UNIVERSE_SIZE + pixelAddress.second - 1);
+
+    auto numPixels = xs.size();
+    red.assign(numPixels, 0.0f);
+    green.assign(numPixels, 0.0f);
+    blue.assign(numPixels, 0.0f);
+    scratch.assign(numPixels, 0.0f);
+
+    universeData.assign(universeNumbers.size() * UNIVERSE_SIZE, 0);
+
+    // Jobs: each group in runs of at most JOB_SIZE pixels, so one large group still spreads over the pool
+    jobs.clear();
+    for (int i = 0; i < (int)groups.size(); ++i)
+    {
+        const auto &group = groups[(size_t)i];
+        for (int offset = 0; offset < group.numPixels; offset += JOB_SIZE)
+            jobs.push_back({i, group.firstPixel + offset, juce::jmin(JOB_SIZE, group.numPixels - offset)});
+    }
+}
+
+//==============================================================================
+void PixelMapEngine::advance(double deltaSeconds, float chaseRateScale) noexcept
+{
+    // Phases accumulate, so speed changes don't make the effect jump
+    for (auto &group : groups)
+    {
+        const auto &effect = group.geometry.effect;
+        auto rate = (double)effect.speed * (effect.type == PixelEffect::Type::chase ? (double)chaseRateScale : 1.0);
+        group.phase += deltaSeconds * rate;
+        group.phase -= std::floor(group.phase);
+    }
+}
+
+void PixelMapEngine::render(const GroupColourSnapshot &groupColours, RenderPool *pool) noexcept
+{
+    auto runJob = [this, &groupColours](int jobIndex)
+    {
+        const auto &job = jobs[(size_t)jobIndex];
+        renderJob(job, groupColours.getColour(groups[(size_t)job.groupIndex].geometry.groupIndex));
+        packJob(job);
+    };
+
+    if (pool != nullptr)
+    {
+        pool->parallelFor((int)jobs.size(), runJob);
+        return;
+    }
+
+    for (int i = 0; i < (int)jobs.size(); ++i)
+        runJob(i);
+}
+
+void PixelMapEngine::renderJob(const RenderJob &job, juce::uint32 groupColour) noexcept
+{
+    const auto &group = groups[(size_t)job.groupIndex];
+    const auto &effect = group.geometry.effect;
+    auto first = (size_t)job.firstPixel;
+    auto num = job.numPixels;
+
+    auto *r = red.data() + first;
+    auto *g = green.data() + first;
+    auto *b = blue.data() + first;
+    auto *t = scratch.data() + first;
+    const auto *x = xs.data() + first;
+    const auto *y = ys.data() + first;
+
+    auto colour = juce::Colour(groupColour);
+    auto phase = (float)group.phase;
+
+    switch (effect.type)
+    {
+    case PixelEffect::Type::gradient:
+        // Triangle wave along the angle, so a moving gradient has no seam
+        project(t, x, y, effect.angle, effect.scale, phase, num);
+        wrapToUnit(t, num);
+        FVO::multiply(t, 2.0f, num);
+        FVO::add(t, -1.0f, num);
+        FVO::abs(t, t, num);
+        FVO::negate(t, t, num);
+        FVO::add(t, 1.0f, num);
+        blend(r, g, b, t, colour, effect.secondColour, num);
+        break;
+
+    case PixelEffect::Type::noise:
+        sampleNoise(t, x, y, 4.0f * effect.scale, phase * 256.0f, num);
+        blend(r, g, b, t, effect.secondColour, colour, num);
+        break;
+
+    case PixelEffect::Type::chase:
+        // Each band is lit at its head and fades over its width
+        project(t, x, y, effect.angle, effect.scale, -phase, num);
+        wrapToUnit(t, num);
+        FVO::multiply(t, -1.0f / juce::jmax(0.001f, effect.width), num);
+        FVO::add(t, 1.0f, num);
+        FVO::clip(t, t, 0.0f, 1.0f, num);
+        blend(r, g, b, t, effect.secondColour, colour, num);
+        break;
+
+    case PixelEffect::Type::image:
+        if (!group.imageTable.empty())
+        {
+            const auto *row = rows.data() + first;
+            FVO::add(t, x, phase, num);
+            wrapToUnit(t, num);
+
+            for (int i = 0; i < num; ++i)
+            {
+                auto column = juce::jmin(imageColumns - 1, (int)(t[i] * (float)imageColumns));
+                const auto *entry = group.imageTable.data() + (size_t)((row[i] * imageColumns + column) * 3);
+                r[i] = entry[0];
+                g[i] = entry[1];
+                b[i] = entry[2];
+            }
+
+            // The group's brightness still dims the image
+            auto level = colour.getBrightness();
+            FVO::multiply(r, level, num);
+            FVO::multiply(g, level, num);
+            FVO::multiply(b, level, num);
+            break;
+        }
+        [[fallthrough]];
+
+    case PixelEffect::Type::solid:
+        FVO::fill(r, colour.getFloatRed(), num);
+        FVO::fill(g, colour.getFloatGreen(), num);
+        FVO::fill(b, colour.getFloatBlue(), num);
+        break;
+    }
+}
+
+void PixelMapEngine::packJob(const RenderJob &job) noexcept
+{
+    const auto &group = groups[(size_t)job.groupIndex];
+    auto first = (size_t)job.firstPixel;
+    auto num = job.numPixels;
+
+    // Scale to 0-255 with rounding, then truncate on the way into the universe
+    float *channels[] = {red.data() + first, green.data() + first, blue.data() + first};
+    for (auto *channel : channels)
+    {
+        FVO::clip(channel, channel, 0.0f, 1.0f, num);
+        FVO::multiply(channel, 255.0f, num);
+        FVO::add(channel, 0.5f, num);
+    }
+
+    const auto *offsets = pixelOffsets.data() + first;
+    auto *data = universeData.data();
+
+    for (int i = 0; i < num; ++i)
+    {
+        auto *pixel = data + offsets[i];
+        pixel[group.channelOffsets[0]] = (juce::uint8)channels[0][i];
+        pixel[group.channelOffsets[1]] = (juce::uint8)channels[1][i];
+        pixel[group.channelOffsets[2]] = (juce::uint8)channels[2][i];
+    }
+}
+
+size_t PixelMapEngine::getMemoryUsage() const
+{
+    using MF = MemoryFootprint;
+    auto bytes = MF::getHeapBytes(groups) + MF::getHeapBytes(jobs) + MF::getHeapBytes(xs) + MF::getHeapBytes(ys)
+                 + MF::getHeapBytes(rows) + MF::getHeapBytes(red) + MF::getHeapBytes(green) + MF::getHeapBytes(blue)
+                 + MF::getHeapBytes(scratch) + MF::getHeapBytes(pixelOffsets) + MF::getHeapBytes(universeNumbers)
+                 + MF::getHeapBytes(universeData);
+
+    // Images are shared through the image cache, so only the resampled tables count
+    for (const auto &group : groups)
+        bytes += MF::getHeapBytes(group.imageTable);
+
+    return bytes;
+}
+
+//==============================================================================
+class PixelMapRenderer::SenderThread : public juce::Thread
+{
+public:
+    explicit SenderThread(PixelMapRenderer &ownerRenderer)
+        : juce::Thread("Pixel map sender"), owner(ownerRenderer)
+    {
+    }
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            owner.frameReady.wait(100);
+            owner.sendLatestFrame();
+        }
+    }
+
+private:
+    PixelMapRenderer &owner;
+};
+
+//==============================================================================
+PixelMapRenderer::PixelMapRenderer(const GroupColourSnapshot &colours, UniverseCallback callback)
+    : juce::Thread("Pixel map renderer"), groupColours(colours), onUniverseChanged(std::move(callback)),
+      senderThread(std::make_unique<SenderThread>(*this))
+{
+}
+
+PixelMapRenderer::~PixelMapRenderer()
+{
+    stopThread(1000);
+    senderThread->signalThreadShouldExit();
+    frameReady.signal();
+    senderThread->stopThread(1000);
+}
+
+void PixelMapRenderer::setGeometries(const std::vector<PixelGeometry> &geometries)
+{
+    stopThread(1000);
+    senderThread->signalThreadShouldExit();
+    frameReady.signal();
+    senderThread->stopThread(1000);
+
+    engine.prepare(geometries);
+
+    universeNumbers.clear();
+    for (int i = 0; i < engine.getNumUniverses(); ++i)
+        universeNumbers.push_back(engine.getUniverseNumber(i));
+
+    auto frameSize = universeNumbers.size() * PixelMapEngine::UNIVERSE_SIZE;
+    frames.forEachBuffer([frameSize](std::vector<juce::uint8> &frame)
+                         { frame.assign(frameSize, 0); });
+    frames.reset();
+    lastSentFrame.assign(frameSize, 0);
+    sentAnyFrame = false;
+
+    if (engine.getNumPixels() > 0)
+    {
+        senderThread->startThread();
+        startThread();
+    }
+}
+
+size_t PixelMapRenderer::getMemoryUsage() const
+{
+    // The triple-buffered frames and the last sent frame are all the same size
+    return engine.getMemoryUsage() + MemoryFootprint::getHeapBytes(universeNumbers) + 4 * MemoryFootprint::getHeapBytes(lastSentFrame);
+}
+
+void PixelMapRenderer::run()
+{
+    auto frameMs = 1000.0 / frameRate;
+    auto lastFrameMs = juce::Time::getMillisecondCounterHiRes();
+    auto nextFrameMs = lastFrameMs;
+
+    while (!threadShouldExit())
+    {
+        auto nowMs = juce::Time::getMillisecondCounterHiRes();
+        engine.advance((nowMs - lastFrameMs) / 1000.0, chaseRateScale.load(std::memory_order_relaxed));
+        engine.render(groupColours, renderPool.getObject());
+        lastFrameMs = nowMs;
+
+        // Hand the frame over; the sender always picks up the latest one
+        auto &frame = frames.getWriteBuffer();
+        std::memcpy(frame.data(), engine.getUniverseData(0), frame.size());
+        frames.publish();
+        frameReady.signal();
+
+        // Drop frames rather than bunch them up after a stall
+        nextFrameMs = juce::jmax(nextFrameMs + frameMs, juce::Time::getMillisecondCounterHiRes());
+        wait(juce::jmax(1, (int)(nextFrameMs - juce::Time::getMillisecondCounterHiRes())));
+    }
+}
+
+void PixelMapRenderer::sendLatestFrame()
+{
+    if (!frames.acquire())
+        return;
+
+    // Compared against what was last sent, not the previous frame, so skipped frames lose nothing
+    const auto &frame = frames.getReadBuffer();
+    for (size_t i = 0; i < universeNumbers.size(); ++i)
+    {
+        const auto *data = frame.data() + i * PixelMapEngine::UNIVERSE_SIZE;
+        auto *lastSent = lastSentFrame.data() + i * PixelMapEngine::UNIVERSE_SIZE;
+
+        if (sentAnyFrame && std::memcmp(data, lastSent, PixelMapEngine::UNIVERSE_SIZE) == 0)
+            continue;
+
+        std::memcpy(lastSent, data, PixelMapEngine::UNIVERSE_SIZE);
+        onUniverseChanged(universeNumbers[i], data, PixelMapEngine::UNIVERSE_SIZE);
+    }
+
+    sentAnyFrame = true;
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_graphics/juce_graphics.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "GroupColourSnapshot.h"
+#include "RenderPool.h"
+#include "TripleBuffer.h"
+
+//==============================================================================
+/**
+ * An effect rendered across every pixel of a group. The group's current output
+ * colour is the primary colour; the effect blends it with a second colour.
+ */
+struct PixelEffect
+{
+    enum class Type
+    {
+        solid,    // Every pixel at the group colour
+        gradient, // Group colour to second colour along the angle
+        noise,    // Drifting value noise between the two colours
+        chase,    // Bands of the group colour travelling over the second colour
+        image     // Image scrolled along x, scaled by the group brightness
+    };
+
+    Type type = Type::solid;
+    juce::Colour secondColour = juce::Colours::black;
+    float speed = 0.0f;  // cycles per second
+    float scale = 1.0f;  // repeats across the geometry
+    float angle = 0.0f;  // direction of gradients and chases, degrees
+    float width = 0.25f; // chase: lit fraction of each band
+    juce::Image image;
+
+    static Type getTypeFromName(const juce::String &name);
+};
+
+//==============================================================================
+/**
+ * Where a group's pixels sit, both physically (a width x height matrix, strips
+ * being one row) and in the DMX address space. Pixels take three consecutive
+ * channels and never straddle a universe; a group that runs past the end of
+ * a universe continues at address 1 of the next one.
+ */
+struct PixelGeometry
+{
+    int groupIndex = 0;
+    int width = 1;
+    int height = 1;
+    bool serpentine = false;       // odd rows run backwards
+    int universe = 1;              // first universe
+    int address = 1;               // 1-based start address in the first universe
+    juce::String channelOrder = "RGB";
+    PixelEffect effect;
+
+    int getNumPixels() const { return width * height; }
+};
+
+//==============================================================================
+/**
+ * Renders pixel-mapped groups and packs them into DMX universes.
+ *
+ * Pixel state is kept as structure-of-arrays (positions, red, green, blue),
+ * contiguous per group, so every effect is a short run of vector kernels
+ * (juce::FloatVectorOperations, or plain loops the compiler vectorises)
+ * over a span of pixels. Packing goes through offsets precomputed by
+ * prepare().
+ *
+ * A frame is split into jobs of up to JOB_SIZE pixels of one group. Jobs
+ * touch disjoint pixels and channels, so they can run on a RenderPool in
+ * any order. That needs groups whose channels don't overlap; maps with
+ * overlapping pixel groups are rejected when they are parsed.
+ *
+ * prepare() allocates; render() does not. One thread drives the engine.
+ */
+class PixelMapEngine
+{
+public:
+    static constexpr int UNIVERSE_SIZE = 512;
+    static constexpr int CHANNELS_PER_PIXEL = 3;
+
+    PixelMapEngine() = default;
+
+    void prepare(const std::vector<PixelGeometry> &geometries);
+
+    // Move every effect on by deltaSeconds; chases run at chaseRateScale times their speed
+    void advance(double deltaSeconds, float chaseRateScale = 1.0f) noexcept;
+
+    // Render and pack every group, with each group's colour from the snapshot.
+    // Jobs are spread over the pool when one is given.
+    void render(const GroupColourSnapshot &groupColours, RenderPool *pool = nullptr) noexcept;
+
+    int getNumGeometries() const { return (int)groups.size(); }
+    int getNumPixels() const { return (int)red.size(); }
+    int getNumJobs() const { return (int)jobs.size(); }
+    int getNumUniverses() const { return (int)universeNumbers.size(); }
+    int getUniverseNumber(int index) const { return universeNumbers[(size_t)index]; }
+
+    // Universes are contiguous, UNIVERSE_SIZE bytes each, in getUniverseNumber() order
+    const juce::uint8 *getUniverseData(int index) const { return universeData.data() + (size_t)index * UNIVERSE_SIZE; }
+
+    // Heap bytes held, not counting the object itself. Fixed between prepare() calls.
+    size_t getMemoryUsage() const;
+
+    static constexpr int JOB_SIZE = 512;
+
+private:
+    struct RenderJob
+    {
+        int groupIndex = 0;
+        int firstPixel = 0;
+        int numPixels = 0;
+    };
+
+    void renderJob(const RenderJob &job, juce::uint32 groupColour) noexcept;
+    void packJob(const RenderJob &job) noexcept;
+
+    struct GroupState
+    {
+        PixelGeometry geometry;
+        int firstPixel = 0;
+        int numPixels = 0;
+        std::array<int, CHANNELS_PER_PIXEL> channelOffsets{0, 1, 2}; // red, green, blue within a pixel
+        double phase = 0.0;            // effect position, in cycles (0-1)
+        std::vector<float> imageTable; // image: imageColumns x height RGB, resampled at prepare
+    };
+
+    static constexpr int imageColumns = 256;
+
+    std::vector<GroupState> groups;
+    std::vector<RenderJob> jobs;
+
+    // Per pixel, contiguous per group
+    std::vector<float> xs, ys;            // normalised position
+    std::vector<int> rows;                // matrix row
+    std::vector<float> red, green, blue;  // rendered colour, 0-1
+    std::vector<float> scratch;           // effect parameter per pixel
+    std::vector<int> pixelOffsets;        // byte offset of the pixel's first channel in universeData
+
+    std::vector<int> universeNumbers;
+    std::vector<juce::uint8> universeData;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PixelMapEngine)
+};
+
+//==============================================================================
+/**
+ * Drives a PixelMapEngine at a fixed frame rate on its own thread, with the
+ * jobs spread over the process-wide RenderPool. Finished frames go through a
+ * lock-free triple buffer to a sender thread. The sender hands every universe
+ * that differs from what it last sent to the callback (on the sender thread),
+ * so a slow callback never holds up rendering.
+ */
+class PixelMapRenderer : private juce::Thread
+{
+public:
+    using UniverseCallback = std::function<void(int universeNumber, const juce::uint8 *data, int size)>;
+
+    PixelMapRenderer(const GroupColourSnapshot &groupColours, UniverseCallback onUniverseChanged);
+    ~PixelMapRenderer() override;
+
+    // Stops rendering, rebuilds the engine and restarts if there is anything to render (message thread)
+    void setGeometries(const std::vector<PixelGeometry> &geometries);
+
+    // Chase speed multiplier, e.g. from audio modulation (any thread)
+    void setChaseRateScale(float scale) noexcept { chaseRateScale.store(scale, std::memory_order_relaxed); }
+
+    // Heap bytes held by the engine and the frames in flight, not counting the object itself (message thread)
+    size_t getMemoryUsage() const;
+
+    static constexpr double DEFAULT_FRAME_RATE = 44.0; // DMX refresh rate for a full universe
+
+private:
+    class SenderThread;
+
+    void run() override;
+    void sendLatestFrame();
+
+    const GroupColourSnapshot &groupColours;
+    UniverseCallback onUniverseChanged;
+    PixelMapEngine engine;
+    juce::SharedResourcePointer<RenderPool> renderPool;
+    double frameRate = DEFAULT_FRAME_RATE;
+    std::atomic<float> chaseRateScale{1.0f};
+
+    // Render thread -> sender thread
+    TripleBuffer<std::vector<juce::uint8>> frames;
+    juce::WaitableEvent frameReady;
+    std::unique_ptr<SenderThread> senderThread;
+
+    // Sender thread only (fixed while it runs)
+    std::vector<int> universeNumbers;
+    std::vector<juce::uint8> lastSentFrame;
+    bool sentAnyFrame = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PixelMapRenderer)
+};
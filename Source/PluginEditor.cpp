@@ -24,6 +24,9 @@ void ColorPreviewComponent::paint(juce::Graphics &g)
 
 void ColorPreviewComponent::setHSB(float hue, float saturation, float brightness)
 {
+    if (hue == currentHue && saturation == currentSaturation && brightness == currentBrightness)
+        return;
+
     currentHue = hue;
     currentSaturation = saturation;
     currentBrightness = brightness;
@@ -32,11 +35,46 @@ void ColorPreviewComponent::setHSB(float hue, float saturation, float brightness
 
 //==============================================================================
 KadmiumDMXAudioProcessorEditor::KadmiumDMXAudioProcessorEditor(KadmiumDMXAudioProcessor &p)
-    : AudioProcessorEditor(&p), audioProcessor(p)
+    : AudioProcessorEditor(&p), audioProcessor(p), rigVisualiser(p.getGroupColourSnapshot()), logView(p.getEventLog())
 {
     // Set up the color preview
     addAndMakeVisible(colorPreview);
 
+    // Set up the rig view (hidden until toggled)
+    addChildComponent(rigVisualiser);
+    rigViewButton.setButtonText("Rig View");
+    rigViewButton.onClick = [this]()
+    {
+        rigViewVisible = !rigViewVisible;
+        rigViewButton.setButtonText(rigViewVisible ? "Group View" : "Rig View");
+        updateViewVisibility();
+    };
+    addAndMakeVisible(rigViewButton);
+
+    // Set up the log view (hidden until toggled)
+    addChildComponent(logView);
+    logViewButton.setButtonText("Log");
+    logViewButton.setClickingTogglesState(true);
+    logViewButton.onClick = [this]()
+    {
+        logViewVisible = logViewButton.getToggleState();
+        updateViewVisibility();
+    };
+    addAndMakeVisible(logViewButton);
+
+    // Set up MIDI learn
+    midiLearnButton.setButtonText("MIDI Learn");
+    midiLearnButton.setClickingTogglesState(true);
+    midiLearnButton.onClick = [this]()
+    {
+        if (!midiLearnButton.getToggleState())
+        {
+            audioProcessor.cancelMidiLearn();
+            midiLearnArmed = false;
+        }
+    };
+    addAndMakeVisible(midiLearnButton);
+
     // Set up the toggle button
     toggleSlidersButton.setButtonText("Hide Controls");
     toggleSlidersButton.onClick = [this]()
@@ -60,6 +98,13 @@ KadmiumDMXAudioProcessorEditor::KadmiumDMXAudioProcessorEditor(KadmiumDMXAudioPr
     mqttStatusLabel.setJustificationType(juce::Justification::centred);
     addAndMakeVisible(mqttStatusLabel);
 
+    // Set up runtime metrics readout
+    metricsLabel.setJustificationType(juce::Justification::centred);
+    metricsLabel.setFont(juce::FontOptions(12.0f));
+    addAndMakeVisible(metricsLabel);
+    lastMetricsSnapshot = audioProcessor.getRuntimeMetrics().getSnapshot();
+    lastNetworkSnapshot = audioProcessor.getNetworkMetrics().getSnapshot();
+
     // Set up group selection dropdown
     groupSelectionLabel.setText("Group:", juce::dontSendNotification);
     groupSelectionLabel.attachToComponent(&groupSelectionCombo, true);
@@ -72,6 +117,7 @@ KadmiumDMXAudioProcessorEditor::KadmiumDMXAudioProcessorEditor(KadmiumDMXAudioPr
         {
             juce::String groupId = juce::String(selectedId - 1); // Convert back to 0-based
             audioProcessor.setSelectedGroup(groupId);
+            rigVisualiser.setSelectedGroupIndex(audioProcessor.getSelectedGroupIndex());
         }
     };
     addAndMakeVisible(groupSelectionCombo);
@@ -82,14 +128,15 @@ KadmiumDMXAudioProcessorEditor::KadmiumDMXAudioProcessorEditor(KadmiumDMXAudioPr
     // Create parameter sliders dynamically
     createParameterSliders();
 
-    // Start timer to update color preview
-    startTimer(50); // Update at 20 FPS
+    // Bind the colour preview and start the refresh timer (20 FPS, only while showing)
+    bindColourParameters();
+    updateTimerState();
 
     // Register as change listener for MIDI map changes
     audioProcessor.addChangeListener(this);
 
     // Set the editor's size
-    setSize(400, 550);
+    setSize(400, 575);
 }
 
 void KadmiumDMXAudioProcessorEditor::createParameterSliders()
@@ -118,6 +165,16 @@ void KadmiumDMXAudioProcessorEditor::createParameterSliders()
         paramSlider.label->attachToComponent(paramSlider.slider.get(), false);
         addAndMakeVisible(*paramSlider.label);
 
+        // In MIDI learn mode, touching the slider picks it as the learn target
+        paramSlider.slider->onDragStart = [this, paramId = paramDef.id]()
+        {
+            if (midiLearnButton.getToggleState())
+            {
+                audioProcessor.startMidiLearn(paramId);
+                midiLearnArmed = audioProcessor.isMidiLearnActive();
+            }
+        };
+
         // Create attachment to the processor
         paramSlider.attachment.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(
             apvts, paramDef.id, *paramSlider.slider));
@@ -145,27 +202,37 @@ void KadmiumDMXAudioProcessorEditor::resized()
     auto bounds = getLocalBounds();
     auto margin = 10;
 
-    // Toggle button at top
-    toggleSlidersButton.setBounds(bounds.removeFromTop(30).reduced(margin));
+    // Toggle buttons at top
+    auto topArea = bounds.removeFromTop(30).reduced(margin);
+    logViewButton.setBounds(topArea.removeFromRight(60));
+    topArea.removeFromRight(margin);
+    toggleSlidersButton.setBounds(topArea);
     bounds.removeFromTop(margin);
 
     // MQTT controls
-    auto mqttArea = bounds.removeFromTop(60).reduced(margin);
+    auto mqttArea = bounds.removeFromTop(85).reduced(margin);
     loadMidiMapButton.setBounds(mqttArea.removeFromTop(30));
     mqttStatusLabel.setBounds(mqttArea.removeFromTop(25));
+    metricsLabel.setBounds(mqttArea.removeFromTop(25));
     bounds.removeFromTop(margin);
 
-    // Group selection dropdown
+    // Group selection dropdown and rig view toggle
     auto groupArea = bounds.removeFromTop(30).reduced(margin);
     groupArea.removeFromLeft(60); // Space for label
+    rigViewButton.setBounds(groupArea.removeFromRight(90));
+    groupArea.removeFromRight(margin);
+    midiLearnButton.setBounds(groupArea.removeFromRight(90));
+    groupArea.removeFromRight(margin);
     groupSelectionCombo.setBounds(groupArea);
     bounds.removeFromTop(margin);
 
-    // Color preview in center-top
+    // Color preview in center-top, rig view across the full width
     auto previewSize = 200;
     auto previewBounds = juce::Rectangle<int>(previewSize, previewSize);
     previewBounds.setCentre(bounds.getCentreX(), bounds.getY() + previewSize / 2 + margin);
     colorPreview.setBounds(previewBounds);
+    rigVisualiser.setBounds(bounds.getX() + margin, previewBounds.getY(), bounds.getWidth() - margin * 2, previewSize);
+    logView.setBounds(rigVisualiser.getBounds());
 
     // Move bounds below the preview
     bounds.removeFromTop(previewSize + margin * 2);
@@ -189,8 +256,8 @@ void KadmiumDMXAudioProcessorEditor::resized()
         }
 
         // Adjust window height to accommodate sliders
-        if (getHeight() < 550)
-            setSize(getWidth(), 550);
+        if (getHeight() < 575)
+            setSize(getWidth(), 575);
     }
     else
     {
@@ -202,72 +269,126 @@ void KadmiumDMXAudioProcessorEditor::resized()
         }
 
         // Adjust window height to be more compact
-        setSize(getWidth(), 320);
+        setSize(getWidth(), 345);
     }
 }
 
-void KadmiumDMXAudioProcessorEditor::timerCallback()
+void KadmiumDMXAudioProcessorEditor::updateViewVisibility()
 {
-    // Update color preview with current parameter values
-    auto &apvts = audioProcessor.getValueTreeState();
+    colorPreview.setVisible(!rigViewVisible && !logViewVisible);
+    rigVisualiser.setVisible(rigViewVisible && !logViewVisible);
+    logView.setVisible(logViewVisible);
+    resized();
+}
+
+void KadmiumDMXAudioProcessorEditor::bindColourParameters()
+{
+    // Read the generation first so a rebuild during binding triggers another rebind
+    boundLayoutGeneration = audioProcessor.getParameterLayoutGeneration();
 
-    // Look for HSB parameters dynamically
-    float hue = 0.0f, saturation = 100.0f, brightness = 100.0f;
+    auto colourParameters = audioProcessor.getColourParameters();
+    hueValue = colourParameters.hue;
+    saturationValue = colourParameters.saturation;
+    brightnessValue = colourParameters.brightness;
 
-    // Try to find hue parameter
-    auto hueParam = apvts.getRawParameterValue("hue");
-    if (!hueParam)
+    // Force the next tick to refresh the preview
+    lastChangeSequence = audioProcessor.getParameterChangeSequence() - 1;
+}
+
+void KadmiumDMXAudioProcessorEditor::updateTimerState()
+{
+    // Detached or explicitly hidden: nothing to refresh until we're shown again
+    auto attached = isVisible() && (getParentComponent() != nullptr || isOnDesktop());
+    if (!attached)
     {
-        // Try alternative names
-        for (const auto &paramId : audioProcessor.getAllParameterIDs())
-        {
-            if (paramId.containsIgnoreCase("hue"))
-            {
-                hueParam = apvts.getRawParameterValue(paramId);
-                break;
-            }
-        }
+        stopTimer();
+        return;
     }
 
-    // Try to find saturation parameter
-    auto saturationParam = apvts.getRawParameterValue("saturation");
-    if (!saturationParam)
+    // Attached but not on screen (e.g. minimised host window): poll slowly for it to reappear
+    auto interval = isShowing() ? REFRESH_INTERVAL_MS : HIDDEN_POLL_INTERVAL_MS;
+    if (getTimerInterval() != interval)
+        startTimer(interval);
+}
+
+void KadmiumDMXAudioProcessorEditor::visibilityChanged()
+{
+    updateTimerState();
+}
+
+void KadmiumDMXAudioProcessorEditor::parentHierarchyChanged()
+{
+    updateTimerState();
+}
+
+void KadmiumDMXAudioProcessorEditor::timerCallback()
+{
+    updateTimerState();
+    if (!isShowing())
+        return;
+
+    // The APVTS was rebuilt since we bound to it: the cached pointers are stale
+    if (audioProcessor.getParameterLayoutGeneration() != boundLayoutGeneration)
+        bindColourParameters();
+
+    // Only touch the preview when a parameter has actually changed
+    auto changeSequence = audioProcessor.getParameterChangeSequence();
+    if (changeSequence != lastChangeSequence)
     {
-        for (const auto &paramId : audioProcessor.getAllParameterIDs())
-        {
-            if (paramId.containsIgnoreCase("saturation"))
-            {
-                saturationParam = apvts.getRawParameterValue(paramId);
-                break;
-            }
-        }
+        lastChangeSequence = changeSequence;
+
+        auto hue = hueValue != nullptr ? hueValue->load(std::memory_order_relaxed) : 0.0f;
+        auto saturation = saturationValue != nullptr ? saturationValue->load(std::memory_order_relaxed) : 100.0f;
+        auto brightness = brightnessValue != nullptr ? brightnessValue->load(std::memory_order_relaxed) : 100.0f;
+        colorPreview.setHSB(hue, saturation, brightness);
     }
 
-    // Try to find brightness parameter
-    auto brightnessParam = apvts.getRawParameterValue("brightness");
-    if (!brightnessParam)
+    // Leave MIDI learn once the processor has taken its event
+    if (midiLearnArmed && !audioProcessor.isMidiLearnActive())
     {
-        for (const auto &paramId : audioProcessor.getAllParameterIDs())
-        {
-            if (paramId.containsIgnoreCase("brightness"))
-            {
-                brightnessParam = apvts.getRawParameterValue(paramId);
-                break;
-            }
-        }
+        midiLearnArmed = false;
+        midiLearnButton.setToggleState(false, juce::dontSendNotification);
     }
 
-    if (hueParam)
-        hue = *hueParam;
-    if (saturationParam)
-        saturation = *saturationParam;
-    if (brightnessParam)
-        brightness = *brightnessParam;
+    // Update MQTT status when the connection state flips
+    auto mqttConnected = audioProcessor.isMqttConnected();
+    if (mqttConnected != lastMqttConnected)
+    {
+        lastMqttConnected = mqttConnected;
+        mqttStatusLabel.setText(audioProcessor.getMqttStatus(), juce::dontSendNotification);
+    }
 
-    colorPreview.setHSB(hue, saturation, brightness);
+    // Update runtime metrics once per second
+    if (--metricsRefreshCountdown <= 0)
+    {
+        metricsRefreshCountdown = 20;
+        updateMetricsLabel();
+    }
+}
 
-    // Update MQTT status
-    mqttStatusLabel.setText(audioProcessor.getMqttStatus(), juce::dontSendNotification);
+void KadmiumDMXAudioProcessorEditor::updateMetricsLabel()
+{
+    using Counter = RuntimeMetrics::Counter;
+
+    // MIDI counters are per instance, MQTT counters belong to the shared hub
+    auto snapshot = audioProcessor.getRuntimeMetrics().getSnapshot();
+    auto networkSnapshot = audioProcessor.getNetworkMetrics().getSnapshot();
+
+    double ccsPerSecond = 0.0;
+    for (int channel = 1; channel <= RuntimeMetrics::numMidiChannels; ++channel)
+        ccsPerSecond += RuntimeMetrics::getChannelRate(snapshot, lastMetricsSnapshot, channel);
+
+    metricsLabel.setText("CC/s " + juce::String(ccsPerSecond, 1) +
+                             "  Pub/s " + juce::String(RuntimeMetrics::getRate(networkSnapshot, lastNetworkSnapshot, Counter::mqttPublishes), 1) +
+                             "  Fail " + juce::String(networkSnapshot.get(Counter::mqttPublishFailures)) +
+                             "  Link " + juce::String(RuntimeMetrics::getRate(snapshot, lastMetricsSnapshot, Counter::midiLinkBusyMicros) / 10000.0, 0) + "%" +
+                             "  Drop " + juce::String(snapshot.get(Counter::midiEventsDropped)) +
+                             "/" + juce::String(snapshot.get(Counter::midiEventsSuperseded)) +
+                             "  Reconn " + juce::String(networkSnapshot.get(Counter::mqttReconnectAttempts)),
+                         juce::dontSendNotification);
+
+    lastMetricsSnapshot = snapshot;
+    lastNetworkSnapshot = networkSnapshot;
 }
 
 void KadmiumDMXAudioProcessorEditor::updateGroupSelection()
@@ -287,6 +408,14 @@ void KadmiumDMXAudioProcessorEditor::updateGroupSelection()
     // Select current group
     juce::String currentGroup = audioProcessor.getSelectedGroup();
     groupSelectionCombo.setSelectedId(currentGroup.getIntValue() + 1);
+
+    // Label the rig view in map order
+    juce::StringArray groupNames;
+    for (const auto &group : midiMap.groups)
+        groupNames.add(group.second);
+
+    rigVisualiser.setGroupNames(groupNames);
+    rigVisualiser.setSelectedGroupIndex(audioProcessor.getSelectedGroupIndex());
 }
 
 void KadmiumDMXAudioProcessorEditor::recreateUIFromMidiMap()
@@ -296,6 +425,9 @@ void KadmiumDMXAudioProcessorEditor::recreateUIFromMidiMap()
     // Recreate parameter sliders based on new MIDI map
     createParameterSliders();
 
+    // Rebind the colour preview to the new parameters
+    bindColourParameters();
+
     // Update group selection dropdown
     updateGroupSelection();
 
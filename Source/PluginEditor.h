@@ -1,7 +1,9 @@
 #pragma once
 
 #include <juce_gui_basics/juce_gui_basics.h>
+#include "LogViewComponent.h"
 #include "PluginProcessor.h"
+#include "RigVisualiserComponent.h"
 
 //==============================================================================
 class ColorPreviewComponent : public juce::Component
@@ -10,6 +12,8 @@ public:
     ColorPreviewComponent();
 
     void paint(juce::Graphics &g) override;
+
+    // Repaints only if the colour actually changed
     void setHSB(float hue, float saturation, float brightness);
 
 private:
@@ -31,6 +35,8 @@ public:
     void paint(juce::Graphics &) override;
     void resized() override;
     void timerCallback() override;
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
 
     // ChangeListener callback
     void changeListenerCallback(juce::ChangeBroadcaster *source) override;
@@ -42,6 +48,14 @@ private:
     // Component layout
     void layoutComponents();
 
+    // Bind the colour preview to the processor's raw parameter values
+    void bindColourParameters();
+
+    // Run the refresh timer only while the editor is on screen
+    void updateTimerState();
+    static constexpr int REFRESH_INTERVAL_MS = 50;        // 20 FPS
+    static constexpr int HIDDEN_POLL_INTERVAL_MS = 500;
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     KadmiumDMXAudioProcessor &audioProcessor;
@@ -49,6 +63,31 @@ private:
     // UI Components
     ColorPreviewComponent colorPreview;
 
+    // Whole-rig view, shown in place of the single colour preview
+    RigVisualiserComponent rigVisualiser;
+    juce::TextButton rigViewButton;
+    bool rigViewVisible = false;
+
+    // Live log, shown in place of either view
+    LogViewComponent logView;
+    juce::TextButton logViewButton;
+    bool logViewVisible = false;
+
+    // Show whichever of the preview, rig view and log is selected
+    void updateViewVisibility();
+
+    // MIDI learn: while toggled on, touching a slider arms learning for it
+    juce::TextButton midiLearnButton;
+    bool midiLearnArmed = false;
+
+    // Cached raw parameter values, rebound when the parameter layout changes
+    std::atomic<float> *hueValue = nullptr;
+    std::atomic<float> *saturationValue = nullptr;
+    std::atomic<float> *brightnessValue = nullptr;
+    juce::uint32 boundLayoutGeneration = 0;
+    juce::uint32 lastChangeSequence = 0;
+    bool lastMqttConnected = false;
+
     juce::TextButton toggleSlidersButton;
     bool slidersVisible = true;
 
@@ -56,6 +95,13 @@ private:
     juce::TextButton loadMidiMapButton;
     juce::Label mqttStatusLabel;
 
+    // Runtime metrics readout, refreshed once per second
+    juce::Label metricsLabel;
+    RuntimeMetrics::Snapshot lastMetricsSnapshot;
+    RuntimeMetrics::Snapshot lastNetworkSnapshot;
+    int metricsRefreshCountdown = 0;
+    void updateMetricsLabel();
+
     // Group selection dropdown
     juce::ComboBox groupSelectionCombo;
     juce::Label groupSelectionLabel;
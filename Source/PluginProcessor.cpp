@@ -1,5 +1,6 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "TraceEvents.h"
 
 //==============================================================================
 KadmiumDMXAudioProcessor::KadmiumDMXAudioProcessor()
@@ -22,35 +23,59 @@ KadmiumDMXAudioProcessor::KadmiumDMXAudioProcessor()
     // Then create the APVTS with the layout
     apvts.reset(new juce::AudioProcessorValueTreeState(*this, nullptr, "Parameters", createParameterLayout()));
 
+    // One merge layer per output source; equal priorities arbitrate per attribute
+    hostLayerIndex = mergeEngine.addLayer("host", DEFAULT_MERGE_PRIORITY);
+    commandLayerIndex = mergeEngine.addLayer("command", DEFAULT_MERGE_PRIORITY);
+    inputLayerIndex = mergeEngine.addLayer("midiInput", DEFAULT_MERGE_PRIORITY);
+    sceneLayerIndex = mergeEngine.addLayer("scene", DEFAULT_MERGE_PRIORITY);
+
+    // Bound before listening, so parameter changes always find their bindings
+    bindParameters();
+
     // Register as listener for parameter changes
     for (const auto &paramPair : parameterDefinitions)
     {
         apvts->addParameterListener(paramPair.second.id, this);
     }
 
-    // Start the MIDI blast timer (every 5 seconds)
-    startTimer(MIDI_BLAST_INTERVAL_MS);
+    updateGroupState();
 
-    // Initialize MQTT client with callbacks
-    mqttClient.setConnectionCallback([this](bool connected, const juce::String &error)
-                                     {
-        if (connected) {
-            DBG("MQTT connected successfully");
-            // Subscribe to DMX command topics
-            mqttClient.subscribe("dmx/+/command");
-        } else {
-            DBG("MQTT connection failed: " + error);
-        } });
+    // Networking, timers and render threads wait for startRuntime(), so hosts
+    // scanning or validating the plugin only pay for the parameters
+}
+
+void KadmiumDMXAudioProcessor::startRuntime()
+{
+    if (runtimeStarted.exchange(true))
+        return;
 
-    mqttClient.setMessageCallback([this](const juce::String &topic, const juce::String &message)
-                                  {
-        // Handle incoming DMX commands
-        handleMqttMessage(topic, message); });
+    eventLog->start();
+
+    lastPublishedMetrics = runtimeMetrics.getSnapshot();
+    lastPublishedNetworkMetrics = outputHub->getRuntimeMetrics().getSnapshot();
+
+    // Join the shared output hub: it drives the periodic MIDI refresh and
+    // delivers DMX commands from its shared MQTT connection
+    hubInstanceId = outputHub->registerInstance(this);
+
+    pixelRenderer.setGeometries(midiMapSnapshot.getForWriter()->pixelGeometries);
+
+    // Capture from the start when asked to; one trace per instance
+    auto traceFile = juce::SystemStats::getEnvironmentVariable(INPUT_TRACE_VARIABLE, {});
+    if (juce::File::isAbsolutePath(traceFile))
+    {
+        juce::File file(traceFile);
+        auto result = startInputRecording(file.getSiblingFile(file.getFileNameWithoutExtension() + "-" + juce::String(hubInstanceId) + file.getFileExtension()));
+        if (result.failed())
+            KADMIUM_LOG(error, "Input recording failed: {}", result.getErrorMessage());
+    }
 }
 
 KadmiumDMXAudioProcessor::~KadmiumDMXAudioProcessor()
 {
-    stopTimer();
+    stopFollowingMidiMapFile();
+    pixelRenderer.setGeometries({});
+    outputHub->unregisterInstance(this);
 
     // Remove parameter listeners
     if (apvts)
@@ -65,10 +90,12 @@ KadmiumDMXAudioProcessor::~KadmiumDMXAudioProcessor()
 //==============================================================================
 void KadmiumDMXAudioProcessor::initializeParameterDefinitions()
 {
+    auto &names = *nameTable;
+
     // Define our current parameters - this is where you'd modify to add/remove parameters
-    parameterDefinitions.push_back({"hue", ParameterDefinition("hue", "Hue", 0.0f, 360.0f, 0.0f, juce::String::fromUTF8(u8"°"))});
-    parameterDefinitions.push_back({"saturation", ParameterDefinition("saturation", "Saturation", 0.0f, 100.0f, 100.0f, "%")});
-    parameterDefinitions.push_back({"brightness", ParameterDefinition("brightness", "Brightness", 0.0f, 100.0f, 100.0f, "%")});
+    parameterDefinitions.push_back({names.intern("hue"), ParameterDefinition(names.intern("hue"), names.intern("Hue"), 0.0f, 360.0f, 0.0f, names.intern(juce::String::fromUTF8(u8"°")))});
+    parameterDefinitions.push_back({names.intern("saturation"), ParameterDefinition(names.intern("saturation"), names.intern("Saturation"), 0.0f, 100.0f, 100.0f, names.intern("%"))});
+    parameterDefinitions.push_back({names.intern("brightness"), ParameterDefinition(names.intern("brightness"), names.intern("Brightness"), 0.0f, 100.0f, 100.0f, names.intern("%"))});
 
     // You could easily add more parameters here:
     // parameterDefinitions.push_back({"intensity", ParameterDefinition("intensity", "Intensity", 0.0f, 100.0f, 100.0f, "%")});
@@ -77,57 +104,303 @@ void KadmiumDMXAudioProcessor::initializeParameterDefinitions()
 
 void KadmiumDMXAudioProcessor::recreateParametersFromMidiMap()
 {
-    // Clear existing parameter definitions
-    parameterDefinitions.clear();
+    KADMIUM_TRACE_SPAN("recreateParametersFromMidiMap");
+    auto rebuildStartTicks = juce::Time::getHighResolutionTicks();
+
+    // Replace the parameter definitions with the map's
+    parameterDefinitions = createParameterDefinitions(*midiMapSnapshot.getForWriter());
+    parameterDefinitions.shrink_to_fit();
+
+    // Recreate APVTS with new parameters (pollers holding raw values must rebind)
+    parameterLayoutGeneration.fetch_add(1, std::memory_order_acq_rel);
+    apvts.reset(new juce::AudioProcessorValueTreeState(*this, nullptr, "Parameters", createParameterLayout()));
+    bindParameters();
 
-    // Create parameters from MIDI map attributes
-    for (const auto &attributePair : currentMidiMap.attributes)
+    // Re-register parameter listeners for the new parameters
+    for (const auto &paramPair : parameterDefinitions)
     {
-        const juce::String &attributeId = attributePair.first;
-        const juce::String &attributeName = attributePair.second;
+        apvts->addParameterListener(paramPair.second.id, this);
+    }
+
+    updateGroupState();
+
+    auto rebuildTicks = juce::Time::getHighResolutionTicks() - rebuildStartTicks;
+    runtimeMetrics.recordParameterRebuild((juce::int64)(juce::Time::highResolutionTicksToSeconds(rebuildTicks) * 1000000.0));
 
-        // Determine parameter range based on attribute name
-        float minValue = 0.0f;
-        float maxValue = 100.0f;
-        float defaultValue = 0.0f;
-        juce::String unit = "";
+    // Notify listeners (including the editor) that the MIDI map has changed
+    sendChangeMessage();
+}
 
-        if (attributeName.containsIgnoreCase("hue"))
+std::vector<std::pair<juce::String, KadmiumDMXAudioProcessor::ParameterDefinition>>
+KadmiumDMXAudioProcessor::createParameterDefinitions(const MidiMapSnapshot &snapshot)
+{
+    // Create parameters from MIDI map attributes. IDs, names and units come from the
+    // shared name table, so every instance's parameters point at the same strings.
+    std::vector<std::pair<juce::String, ParameterDefinition>> definitions;
+    for (int attribute = 0; attribute < snapshot.numAttributes; ++attribute)
+    {
+        const juce::String &attributeId = snapshot.map.attributes[(size_t)attribute].first;
+        const juce::String &attributeName = snapshot.map.attributes[(size_t)attribute].second;
+
+        // Parameter range comes from the attribute's declared (or inferred) type
+        auto range = AttributeTypes::getParameterRange(snapshot.map.getAttributeType(attributeId));
+
+        // Lowercase ID without spaces, precompiled with the snapshot
+        const juce::String &paramId = snapshot.parameterIds[attribute];
+        definitions.push_back({paramId, ParameterDefinition(
+                                            paramId, attributeName, range.minValue, range.maxValue, range.defaultValue,
+                                            nameTable->intern(range.unit), range.interval)});
+    }
+
+    return definitions;
+}
+
+void KadmiumDMXAudioProcessor::bindParameters()
+{
+    const auto &snapshot = *midiMapSnapshot.getForWriter();
+    auto bindings = std::make_unique<ParameterBindings>();
+
+    for (size_t parameter = 0; parameter < parameterDefinitions.size(); ++parameter)
+    {
+        const auto &paramId = parameterDefinitions[parameter].first;
+        BoundParameter bound{apvts->getParameter(paramId), apvts->getRawParameterValue(paramId)};
+
+        // Resolve parameter -> attribute once, by the exact ID the map compiled for it,
+        // so the change path doesn't match names ("panfine" must not drive "Pan")
+        bound.attributeIndex = snapshot.parameterIds.indexOf(paramId);
+
+        bindings->parameters.push_back(bound);
+        bindings->indices.set(paramId, (int)parameter);
+    }
+
+    parameterBindings.publish(std::move(bindings));
+    bindColourParameters();
+}
+
+void KadmiumDMXAudioProcessor::bindColourParameters()
+{
+    // Prefer the exact ID, then fall back to the first ID containing the name
+    auto findRawValue = [this](const juce::String &name) -> std::atomic<float> *
+    {
+        if (auto *rawValue = apvts->getRawParameterValue(name))
+            return rawValue;
+
+        for (const auto &paramPair : parameterDefinitions)
         {
-            maxValue = 360.0f;
-            unit = juce::String::fromUTF8(u8"°");
+            if (paramPair.first.containsIgnoreCase(name))
+                return apvts->getRawParameterValue(paramPair.first);
         }
-        else if (attributeName.containsIgnoreCase("saturation") ||
-                 attributeName.containsIgnoreCase("brightness") ||
-                 attributeName.containsIgnoreCase("intensity"))
+
+        return nullptr;
+    };
+
+    colourParameters.hue = findRawValue("hue");
+    colourParameters.saturation = findRawValue("saturation");
+    colourParameters.brightness = findRawValue("brightness");
+}
+
+void KadmiumDMXAudioProcessor::updateGroupState(bool keepLayerValues)
+{
+    const auto &snapshot = *midiMapSnapshot.getForWriter();
+    groupColours.setNumGroups(snapshot.numGroups);
+    selectedGroupIndex = snapshot.getGroupIndex(selectedGroupId);
+    midiInputMap.compile(snapshot.map);
+
+    prepareMergeEngine(keepLayerValues);
+
+    if (runtimeStarted.load())
+        pixelRenderer.setGeometries(snapshot.pixelGeometries);
+}
+
+void KadmiumDMXAudioProcessor::publishUniverse(int universe, const juce::uint8 *data, int size)
+{
+    if (!outputHub->isConnected())
+        return;
+
+    outputHub->publish(UNIVERSE_TOPIC_PREFIX + juce::String(universe), juce::Base64::toBase64(data, (size_t)size));
+}
+
+void KadmiumDMXAudioProcessor::prepareMergeEngine(bool keepLayerValues)
+{
+    const auto &snapshot = *midiMapSnapshot.getForWriter();
+    const juce::SpinLock::ScopedLockType lock(mergeLock);
+
+    auto numGroups = snapshot.numGroups;
+    auto numAttributes = snapshot.numAttributes;
+    mergeEngine.prepare(numGroups, numAttributes, keepLayerValues);
+    outputSmoother.prepare(numGroups, numAttributes);
+    sceneFader.prepare(numGroups, numAttributes);
+
+    // Profile channels get their own scheduler cells after the grid
+    auto numOutputCells = snapshot.getNumOutputCells();
+    midiScheduler.prepare(numOutputCells);
+    fixtureChannelValues.assign(snapshot.maxFixtureChannels, 0.0f);
+
+    for (const auto &fixture : snapshot.fixtureOutputs)
+    {
+        for (size_t channel = 0; channel < fixture.profile->channels.size(); ++channel)
         {
-            maxValue = 100.0f;
-            defaultValue = 100.0f;
-            unit = "%";
+            auto isIntensity = fixture.profile->channels[channel].role == FixtureProfile::ChannelRole::intensity;
+            midiScheduler.setCellPriority(fixture.firstCell + (int)channel,
+                                          isIntensity ? MidiOutputScheduler::highPriority : MidiOutputScheduler::normalPriority);
         }
-        else if (attributeName.containsIgnoreCase("strobe"))
+    }
+
+    // Attribute -> parameter range and default, in one pass over the bindings for this map.
+    // Copied here under the merge lock, so command threads never read parameterDefinitions.
+    attributeRanges.assign((size_t)numAttributes, {});
+    attributeDefaults.assign((size_t)numAttributes, 0.0f);
+
+    const auto &bindings = *parameterBindings.getForWriter();
+    for (size_t parameter = 0; parameter < bindings.parameters.size(); ++parameter)
+    {
+        auto attribute = bindings.parameters[parameter].attributeIndex;
+        if (!juce::isPositiveAndBelow(attribute, numAttributes) || !attributeRanges[(size_t)attribute].isEmpty())
+            continue;
+
+        const auto &def = parameterDefinitions[parameter].second;
+        attributeRanges[(size_t)attribute] = {def.minValue, def.maxValue};
+        attributeDefaults[(size_t)attribute] = (def.defaultValue - def.minValue) / (def.maxValue - def.minValue);
+    }
+
+    for (int attribute = 0; attribute < numAttributes; ++attribute)
+    {
+        const juce::String &attributeId = snapshot.map.attributes[(size_t)attribute].first;
+        const auto &encoding = snapshot.attributeEncodings[(size_t)attribute];
+
+        auto isIntensity = encoding.kind == AttributeKind::dimmer;
+        auto isHue = encoding.kind == AttributeKind::hue;
+
+        // Intensity-like attributes default to HTP, everything else to LTP
+        auto mergeMode = snapshot.map.getMergeMode(attributeId);
+        if (mergeMode.isEmpty())
+            mergeMode = isIntensity ? "htp" : "ltp";
+        mergeEngine.setAttributeMode(attribute, mergeMode == "htp" ? MergeMode::htp : MergeMode::ltp);
+
+        // Intensity goes out first when the link is saturated, hue last
+        auto priority = MidiOutputScheduler::normalPriority;
+        if (isIntensity)
+            priority = MidiOutputScheduler::highPriority;
+        else if (isHue)
+            priority = MidiOutputScheduler::lowPriority;
+
+        for (int group = 0; group < numGroups; ++group)
         {
-            maxValue = 20.0f;
-            unit = "Hz";
+            auto cell = mergeEngine.getCellIndex(group, attribute);
+            midiScheduler.setCellPriority(cell, priority);
+            midiScheduler.setCellMessageCount(cell, AttributeTypes::getNumMessages(encoding.kind));
         }
 
-        // Create parameter with lowercase ID for consistency
-        juce::String paramId = attributeName.toLowerCase().removeCharacters(" ");
-        parameterDefinitions.push_back({paramId, ParameterDefinition(
-                                                     paramId, attributeName, minValue, maxValue, defaultValue, unit)});
+        // Hue crossfades and smoothing take the short way round the colour wheel
+        sceneFader.setAttributeWraps(attribute, isHue);
+        outputSmoother.setAttributeWraps(attribute, isHue);
+
+        auto smoothing = snapshot.map.getSmoothing(attributeId);
+        outputSmoother.setAttributeSmoothing(attribute, OutputSmoother::getModeFromName(smoothing.mode), smoothing.timeMs);
     }
 
-    // Recreate APVTS with new parameters
-    apvts.reset(new juce::AudioProcessorValueTreeState(*this, nullptr, "Parameters", createParameterLayout()));
+    modulatedValues.assign((size_t)mergeEngine.getNumCells(), 0.0f);
+    lastSentMidiValues.assign((size_t)numOutputCells, -1);
+    lastSentStamps.assign((size_t)numOutputCells, 0);
 
-    // Re-register parameter listeners for the new parameters
-    for (const auto &paramPair : parameterDefinitions)
+    // The audio thread renders again once grids and snapshot agree
+    preparedGeneration = snapshot.generation;
+}
+
+int KadmiumDMXAudioProcessor::getAttributeIndexForParameter(const juce::String &parameterID) const
+{
+    const RcuPointer<ParameterBindings>::ReadScope bindings(parameterBindings);
+    auto parameterIndex = bindings->getIndex(parameterID);
+    return parameterIndex >= 0 ? bindings->parameters[(size_t)parameterIndex].attributeIndex : -1;
+}
+
+void KadmiumDMXAudioProcessor::setMidiLinkBytesPerSecond(double bytesPerSecond)
+{
+    const juce::SpinLock::ScopedLockType lock(mergeLock);
+    midiScheduler.setBytesPerSecond(bytesPerSecond);
+}
+
+void KadmiumDMXAudioProcessor::setMergeSourcePriority(MergeSource source, int priority)
+{
+    const juce::SpinLock::ScopedLockType lock(mergeLock);
+    auto layerIndex = source == MergeSource::host        ? hostLayerIndex
+                      : source == MergeSource::command   ? commandLayerIndex
+                      : source == MergeSource::midiInput ? inputLayerIndex
+                                                         : sceneLayerIndex;
+    mergeEngine.setLayerPriority(layerIndex, priority);
+}
+
+juce::Result KadmiumDMXAudioProcessor::captureScene(const juce::String &name)
+{
+    Scene scene;
+    scene.name = name;
+
+    const RcuPointer<MidiMapSnapshot>::ReadScope snapshot(midiMapSnapshot);
+    for (const auto &groupPair : snapshot->map.groups)
+        scene.groupIds.add(groupPair.first);
+
+    for (const auto &attributePair : snapshot->map.attributes)
+        scene.attributeIds.add(attributePair.first);
+
+    // Allocate outside the lock the audio thread tries for
+    auto numCells = (size_t)snapshot->getNumGridCells();
+    scene.values.resize(numCells);
+    scene.active.resize(numCells);
+
+    // Snapshot what is being sent right now
     {
-        apvts->addParameterListener(paramPair.second.id, this);
+        const juce::SpinLock::ScopedLockType lock(mergeLock);
+        if (snapshot->generation != preparedGeneration)
+            return juce::Result::fail("The MIDI map changed while capturing " + name);
+
+        std::copy_n(outputSmoother.getOutputValues(), numCells, scene.values.begin());
+        std::copy_n(mergeEngine.getOutputActive(), numCells, scene.active.begin());
     }
 
-    // Notify listeners (including the editor) that the MIDI map has changed
-    sendChangeMessage();
+    sceneLibrary.store(std::move(scene));
+    DBG("Captured scene: " + name);
+    return juce::Result::ok();
+}
+
+juce::Result KadmiumDMXAudioProcessor::recallScene(const juce::String &name, double fadeSeconds)
+{
+    const RcuPointer<MidiMapSnapshot>::ReadScope snapshot(midiMapSnapshot);
+    juce::StringArray groupIds, attributeIds;
+    for (const auto &groupPair : snapshot->map.groups)
+        groupIds.add(groupPair.first);
+
+    for (const auto &attributePair : snapshot->map.attributes)
+        attributeIds.add(attributePair.first);
+
+    std::vector<float> values, active;
+    auto result = sceneLibrary.getFrame(name, groupIds, attributeIds, values, active);
+    if (result.failed())
+        return result;
+
+    auto ticks = LatencyMonitor::now();
+    const juce::SpinLock::ScopedLockType lock(mergeLock);
+    if (snapshot->generation != preparedGeneration)
+        return juce::Result::fail("The MIDI map changed while recalling " + name);
+
+    // Fade from what is being sent right now; processBlock advances the fade
+    sceneFader.start(values.data(), active.data(), outputSmoother.getOutputValues(), mergeEngine.getOutputActive(), fadeSeconds, ticks);
+    return juce::Result::ok();
+}
+
+void KadmiumDMXAudioProcessor::releaseScene()
+{
+    const juce::SpinLock::ScopedLockType lock(mergeLock);
+    sceneFader.stop();
+    mergeEngine.getLayer(sceneLayerIndex).releaseAll();
+}
+
+void KadmiumDMXAudioProcessor::startMidiLearn(const juce::String &parameterID)
+{
+    auto groupIndex = selectedGroupIndex.load();
+    auto attributeIndex = getAttributeIndexForParameter(parameterID);
+
+    if (groupIndex >= 0 && attributeIndex >= 0)
+        midiLearnTarget = (juce::int32)(groupIndex << 16 | attributeIndex);
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout KadmiumDMXAudioProcessor::createParameterLayout()
@@ -142,7 +415,7 @@ juce::AudioProcessorValueTreeState::ParameterLayout KadmiumDMXAudioProcessor::cr
         layout.add(std::make_unique<juce::AudioParameterFloat>(
             def.id,
             def.name,
-            juce::NormalisableRange<float>(def.minValue, def.maxValue, 1.0f),
+            juce::NormalisableRange<float>(def.minValue, def.maxValue, def.interval),
             def.defaultValue,
             juce::AudioParameterFloatAttributes().withLabel(def.unit)));
     }
@@ -151,50 +424,38 @@ juce::AudioProcessorValueTreeState::ParameterLayout KadmiumDMXAudioProcessor::cr
 }
 
 //==============================================================================
-float KadmiumDMXAudioProcessor::getParameterValue(const juce::String &parameterID) const
+int KadmiumDMXAudioProcessor::getParameterIndex(const juce::String &parameterID) const
 {
-    auto *param = apvts->getParameter(parameterID);
-    if (param != nullptr)
-        return param->getValue();
-    return 0.0f;
+    const RcuPointer<ParameterBindings>::ReadScope bindings(parameterBindings);
+    return bindings->getIndex(parameterID);
 }
 
-void KadmiumDMXAudioProcessor::setParameterValue(const juce::String &parameterID, float value)
+float KadmiumDMXAudioProcessor::getParameterValue(int parameterIndex) const
 {
-    auto *param = apvts->getParameter(parameterID);
-    if (param != nullptr)
-    {
-        param->setValueNotifyingHost(value);
+    const RcuPointer<ParameterBindings>::ReadScope bindings(parameterBindings);
+    if (!juce::isPositiveAndBelow(parameterIndex, (int)bindings->parameters.size()))
+        return 0.0f;
 
-        // Send MIDI CC when parameter changes
-        if (currentMidiMap.hasGroup(selectedGroupId))
-        {
-            // Find corresponding attribute ID in MIDI map
-            for (const auto &attributePair : currentMidiMap.attributes)
-            {
-                const juce::String &attributeId = attributePair.first;
-                const juce::String &attributeName = attributePair.second;
+    const auto &bound = bindings->parameters[(size_t)parameterIndex];
+    return bound.parameter->convertTo0to1(bound.rawValue->load(std::memory_order_relaxed));
+}
 
-                // Match parameter to attribute (case-insensitive)
-                if (parameterID.containsIgnoreCase(attributeName) ||
-                    attributeName.toLowerCase().removeCharacters(" ") == parameterID)
-                {
-                    // Get parameter definition for value conversion
-                    auto paramDef = getParameterDefinition(parameterID);
-
-                    // Normalize to 0-1 range, then scale to 0-127
-                    float normalizedValue = (value - paramDef.minValue) / (paramDef.maxValue - paramDef.minValue);
-                    int midiValue = juce::roundToInt(normalizedValue * 127.0f);
-
-                    // Send MIDI CC
-                    int midiChannel = selectedGroupId.getIntValue() + 1; // Convert to 1-based MIDI channel
-                    int ccNumber = attributeId.getIntValue();
-                    sendMidiCC(midiChannel, ccNumber, midiValue);
-                    break;
-                }
-            }
-        }
-    }
+void KadmiumDMXAudioProcessor::setParameterValue(int parameterIndex, float value)
+{
+    // parameterChanged routes the new value into the host merge layer
+    const RcuPointer<ParameterBindings>::ReadScope bindings(parameterBindings);
+    if (juce::isPositiveAndBelow(parameterIndex, (int)bindings->parameters.size()))
+        bindings->parameters[(size_t)parameterIndex].parameter->setValueNotifyingHost(value);
+}
+
+float KadmiumDMXAudioProcessor::getParameterValue(const juce::String &parameterID) const
+{
+    return getParameterValue(getParameterIndex(parameterID));
+}
+
+void KadmiumDMXAudioProcessor::setParameterValue(const juce::String &parameterID, float value)
+{
+    setParameterValue(getParameterIndex(parameterID), value);
 }
 
 juce::StringArray KadmiumDMXAudioProcessor::getAllParameterIDs() const
@@ -209,14 +470,9 @@ juce::StringArray KadmiumDMXAudioProcessor::getAllParameterIDs() const
 
 KadmiumDMXAudioProcessor::ParameterDefinition KadmiumDMXAudioProcessor::getParameterDefinition(const juce::String &parameterID) const
 {
-    for (const auto &paramPair : parameterDefinitions)
-    {
-        if (paramPair.first == parameterID)
-            return paramPair.second;
-    }
-
-    // Return empty definition if not found
-    return ParameterDefinition();
+    // Empty definition if not found
+    auto parameterIndex = getParameterIndex(parameterID);
+    return parameterIndex >= 0 ? parameterDefinitions[(size_t)parameterIndex].second : ParameterDefinition();
 }
 
 std::vector<KadmiumDMXAudioProcessor::ParameterDefinition> KadmiumDMXAudioProcessor::getAllParameterDefinitions() const
@@ -297,9 +553,18 @@ void KadmiumDMXAudioProcessor::changeProgramName(int index, const juce::String &
 //==============================================================================
 void KadmiumDMXAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    // Use this method as the place to do any pre-playback
-    // initialisation that you need..
-    juce::ignoreUnused(sampleRate, samplesPerBlock);
+    // Smoothing runs per block, so it needs the block duration
+    if (sampleRate > 0.0)
+        currentSampleRate = sampleRate;
+
+    // Thru events are collected in this scratch on the audio thread, so reserve room up front
+    thruMidiBuffer.ensureSize((size_t)THRU_BUFFER_BYTES);
+
+    startRuntime();
+
+    audioAnalyser.prepare(currentSampleRate, samplesPerBlock);
+
+    inputRecorder.recordPrepare(sampleRate, samplesPerBlock);
 }
 
 void KadmiumDMXAudioProcessor::releaseResources()
@@ -335,6 +600,20 @@ void KadmiumDMXAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                                             juce::MidiBuffer &midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    KADMIUM_TRACE_SPAN("processBlock");
+    if (TraceEvents::isEnabled())
+        TraceEvents::nameCurrentThread("Audio thread");
+
+    // Claims the log ring with a literal name the first time, before anything logs here
+    EventLog::nameCurrentThread("Audio thread");
+
+    // Capture the block before anything consumes its MIDI
+    if (inputRecorder.isRecording())
+    {
+        auto *playHead = getPlayHead();
+        inputRecorder.recordBlock(buffer.getNumSamples(), playHead != nullptr ? playHead->getPosition() : juce::Optional<juce::AudioPlayHead::PositionInfo>(), midiMessages);
+    }
+
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -342,17 +621,316 @@ void KadmiumDMXAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
+    // Translate incoming MIDI; what is left in the buffer is the thru output
+    handleMidiInput(midiMessages);
+
     // Add any pending MIDI output messages
-    midiMessages.addEvents(midiOutputBuffer, 0, buffer.getNumSamples(), 0);
-    midiOutputBuffer.clear();
+    auto drainTicks = LatencyMonitor::now();
+    auto numPending = midiQueueFifo.getNumReady();
+    runtimeMetrics.setMidiQueueDepth(numPending);
+
+    midiQueueFifo.read(numPending).forEach([&](int index)
+                                           {
+        const auto &event = midiQueue[(size_t)index];
+        midiMessages.addEvent(juce::MidiMessage::controllerEvent(event.channel, event.ccNumber, event.value), 0);
+        runtimeMetrics.countMidiEvent(event.channel);
+        latencyMonitor.record(LatencyMonitor::Stage::parameterToMidiDrain, event.originTicks, drainTicks); });
+
+    // Analyse the input first, so modulation reacts within this block. Audio passes through untouched.
+    audioInputActive = totalNumInputChannels > 0 && buffer.getNumSamples() > 0;
+    if (audioInputActive)
+        audioAnalyser.process(buffer);
+
+    // Merge every source and send what changed
+    renderMergedOutput(midiMessages, buffer.getNumSamples(), numPending);
+}
+
+void KadmiumDMXAudioProcessor::handleMidiInput(juce::MidiBuffer &midiMessages)
+{
+    KADMIUM_TRACE_SPAN("handleMidiInput");
+    if (midiMessages.isEmpty())
+        return;
+
+    auto thruMode = getMidiThruMode();
+    auto originTicks = LatencyMonitor::now();
+    thruMidiBuffer.clear();
+
+    for (const auto metadata : midiMessages)
+    {
+        auto message = metadata.getMessage();
+        auto isController = message.isController();
+        auto isNoteOn = message.isNoteOn();
+        auto isNoteOff = message.isNoteOff();
+
+        MidiInputMap::Target target;
+        if (isController || isNoteOn || isNoteOff)
+        {
+            auto type = isController ? MidiInputMap::EventType::controller : MidiInputMap::EventType::note;
+            auto number = isController ? message.getControllerNumber() : message.getNoteNumber();
+
+            // MIDI learn claims the first CC or note-on
+            auto learnTarget = midiLearnTarget.load();
+            if (learnTarget >= 0 && !isNoteOff && midiLearnTarget.compare_exchange_strong(learnTarget, -1))
+                midiInputMap.learn(type, message.getChannel(), number, {learnTarget >> 16, learnTarget & 0xffff});
+
+            target = midiInputMap.lookup(type, message.getChannel(), number);
+        }
+
+        if (target.isValid())
+        {
+            runtimeMetrics.increment(RuntimeMetrics::Counter::midiInputEvents);
+
+            // CCs set the value, notes hold it at their velocity until released
+            auto value = isController ? (float)message.getControllerValue() / 127.0f
+                                      : (isNoteOn ? message.getFloatVelocity() : -1.0f);
+
+            if (numPendingInputs < MAX_PENDING_INPUTS)
+                pendingInputs[(size_t)numPendingInputs++] = {target.groupIndex, target.attributeIndex, value, originTicks};
+            else
+                runtimeMetrics.increment(RuntimeMetrics::Counter::midiEventsDropped);
+        }
+
+        if (thruMode == MidiThruMode::unmapped && !target.isValid())
+            thruMidiBuffer.addEvent(metadata.data, metadata.numBytes, metadata.samplePosition);
+    }
+
+    // Everything passes through as it is
+    if (thruMode == MidiThruMode::all)
+        return;
+
+    // Copied back rather than swapped, so the scratch keeps the storage prepareToPlay
+    // reserved. The thru events are a subset of the input, so the host's buffer has room.
+    midiMessages.clear();
+    midiMessages.addEvents(thruMidiBuffer, 0, -1, 0);
+}
+
+void KadmiumDMXAudioProcessor::queueHostWrite(const PendingInput &write)
+{
+    const juce::SpinLock::ScopedLockType lock(pendingHostWriteLock);
+    if (numPendingHostWrites < MAX_PENDING_HOST_WRITES)
+        pendingHostWrites[(size_t)numPendingHostWrites++] = write;
+    else
+        runtimeMetrics.increment(RuntimeMetrics::Counter::midiEventsDropped);
+}
+
+void KadmiumDMXAudioProcessor::applyPendingHostWrites()
+{
+    const juce::SpinLock::ScopedLockType lock(pendingHostWriteLock);
+    auto &hostLayer = mergeEngine.getLayer(hostLayerIndex);
+
+    for (int i = 0; i < numPendingHostWrites; ++i)
+    {
+        const auto &write = pendingHostWrites[(size_t)i];
+        if (write.groupIndex < mergeEngine.getNumGroups() && write.attributeIndex < mergeEngine.getNumAttributes())
+            hostLayer.set(mergeEngine.getCellIndex(write.groupIndex, write.attributeIndex), write.value, write.originTicks);
+    }
+    numPendingHostWrites = 0;
+}
+
+void KadmiumDMXAudioProcessor::renderMergedOutput(juce::MidiBuffer &midiMessages, int numSamples, int numDirectEvents)
+{
+    KADMIUM_TRACE_SPAN("renderMergedOutput");
+    const juce::SpinLock::ScopedTryLockType lock(mergeLock);
+    if (!lock.isLocked())
+        return; // A writer holds the grid; the next block picks its change up
+
+    // Between a map swap and the grids being resized for it, hold the output as it is
+    const RcuPointer<MidiMapSnapshot>::ReadScope snapshot(midiMapSnapshot);
+    if (snapshot->generation != preparedGeneration)
+        return;
+
+    // Apply the host writes that arrived while a writer held the grid, then the
+    // incoming MIDI collected by handleMidiInput
+    applyPendingHostWrites();
+
+    auto &inputLayer = mergeEngine.getLayer(inputLayerIndex);
+    for (int i = 0; i < numPendingInputs; ++i)
+    {
+        const auto &input = pendingInputs[(size_t)i];
+        if (input.groupIndex >= mergeEngine.getNumGroups() || input.attributeIndex >= mergeEngine.getNumAttributes())
+            continue;
+
+        auto cell = mergeEngine.getCellIndex(input.groupIndex, input.attributeIndex);
+        if (input.value < 0.0f)
+            inputLayer.release(cell);
+        else
+            inputLayer.set(cell, input.value, input.originTicks);
+    }
+    numPendingInputs = 0;
+
+    auto blockSeconds = (double)numSamples / currentSampleRate;
+    sceneFader.process(blockSeconds, mergeEngine.getLayer(sceneLayerIndex));
+
+    // Modulated frames change every block, so they are retargeted even when no source changed
+    auto fullRefresh = fullMidiRefreshRequested.exchange(false);
+    auto modulated = audioInputActive && !snapshot->modulationRoutes.empty();
+    if (mergeEngine.process() || modulated || modulationApplied)
+        outputSmoother.setTargets(modulated ? applyAudioModulation(*snapshot) : mergeEngine.getOutputValues(), mergeEngine.getOutputActive());
+    modulationApplied = modulated;
+
+    if (audioInputActive && snapshot->hasChaseRateModulation)
+    {
+        const auto &chaseRate = snapshot->chaseRateModulation;
+        auto source = audioAnalyser.getValue(chaseRate.source) * chaseRate.depth;
+        pixelRenderer.setChaseRateScale(chaseRate.additive ? 1.0f + source : 1.0f - chaseRate.depth + source);
+    }
+
+    // Queue changed cells; nothing changes once every cell has settled, unless a refresh is due
+    if (outputSmoother.process(blockSeconds) || fullRefresh)
+    {
+        const auto *values = outputSmoother.getOutputValues();
+        const auto *active = mergeEngine.getOutputActive();
+        const auto *stamps = mergeEngine.getOutputStamps();
+        auto numAttributes = mergeEngine.getNumAttributes();
+
+        for (int group = 0; group < mergeEngine.getNumGroups(); ++group)
+        {
+            for (int attribute = 0; attribute < numAttributes; ++attribute)
+            {
+                auto cell = (size_t)mergeEngine.getCellIndex(group, attribute);
+
+                // Cells no source holds keep their last output
+                if (active[cell] < 0.5f || snapshot->fixtureColourCells[cell] != 0)
+                {
+                    lastSentMidiValues[cell] = -1;
+                    continue;
+                }
+
+                // Dispatch through the encoder compiled for this attribute's type
+                auto midiValue = snapshot->attributeEncoders[(size_t)attribute](values[cell], snapshot->attributeEncodings[(size_t)attribute]);
+                if (midiValue == lastSentMidiValues[cell] && !fullRefresh)
+                    continue;
+
+                lastSentMidiValues[cell] = midiValue;
+                if (midiScheduler.enqueue((int)cell, midiValue, stamps[cell]))
+                    runtimeMetrics.increment(RuntimeMetrics::Counter::midiEventsSuperseded);
+            }
 
-    // Audio processing (if needed)
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+            // Rig visualiser colour from the merged output (black until a colour attribute is held)
+            auto anyColourActive = false;
+            auto getColourComponent = [&](int attribute, float fallback)
+            {
+                if (attribute < 0)
+                    return fallback;
+
+                auto cell = (size_t)mergeEngine.getCellIndex(group, attribute);
+                if (active[cell] < 0.5f)
+                    return attributeDefaults[(size_t)attribute];
+
+                anyColourActive = true;
+                return values[cell];
+            };
+
+            auto hue = getColourComponent(snapshot->hueAttributeIndex, 0.0f);
+            auto saturation = getColourComponent(snapshot->saturationAttributeIndex, 1.0f);
+            auto brightness = getColourComponent(snapshot->brightnessAttributeIndex, 1.0f);
+
+            groupColours.setColour(group, anyColourActive ? juce::Colour::fromHSV(hue, saturation, brightness, 1.0f).getARGB()
+                                                          : juce::Colours::black.getARGB());
+
+            // Profiled groups: the colour goes out through the profile's curves and mixing
+            auto fixtureIndex = snapshot->groupFixtureIndices[(size_t)group];
+            if (fixtureIndex >= 0)
+            {
+                const auto &fixture = snapshot->fixtureOutputs[(size_t)fixtureIndex];
+                auto numChannels = (int)fixture.profile->channels.size();
+
+                juce::int64 colourStamp = 0;
+                for (auto attribute : {snapshot->hueAttributeIndex, snapshot->saturationAttributeIndex, snapshot->brightnessAttributeIndex})
+                {
+                    if (attribute >= 0)
+                        colourStamp = juce::jmax(colourStamp, stamps[(size_t)mergeEngine.getCellIndex(group, attribute)]);
+                }
+
+                if (anyColourActive)
+                    fixture.profile->render(hue, saturation, brightness, fixtureChannelValues.data());
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    auto cell = (size_t)(fixture.firstCell + channel);
+                    if (!anyColourActive)
+                    {
+                        lastSentMidiValues[cell] = -1;
+                        continue;
+                    }
+
+                    auto midiValue = juce::roundToInt(fixtureChannelValues[(size_t)channel] * 127.0f);
+                    if (midiValue == lastSentMidiValues[cell] && !fullRefresh)
+                        continue;
+
+                    lastSentMidiValues[cell] = midiValue;
+                    if (midiScheduler.enqueue((int)cell, midiValue, colourStamp))
+                        runtimeMetrics.increment(RuntimeMetrics::Counter::midiEventsSuperseded);
+                }
+            }
+        }
+    }
+
+    // Send what the link has room for, spread across the block
+    midiScheduler.occupyLink(numDirectEvents);
+
+    auto blockStartTicks = LatencyMonitor::now();
+    auto ticksPerSample = (double)juce::Time::getHighResolutionTicksPerSecond() / currentSampleRate;
+    auto numAttributes = juce::jmax(1, mergeEngine.getNumAttributes());
+    auto numGridCells = mergeEngine.getNumCells();
+
+    auto busySeconds = midiScheduler.render(numSamples, currentSampleRate, [&](int cell, int value, juce::int64 originTicks, int samplePosition)
+                                            {
+        auto attribute = (size_t)(cell % numAttributes);
+        auto midiChannel = 1;
+
+        if (cell >= numGridCells)
+        {
+            const auto &route = snapshot->fixtureChannelRoutes[(size_t)(cell - numGridCells)];
+            midiChannel = route.midiChannel;
+            midiMessages.addEvent(juce::MidiMessage::controllerEvent(midiChannel, route.ccNumber, value), samplePosition);
+        }
+        else if (snapshot->attributeEncodings[attribute].kind == AttributeKind::position16)
+        {
+            // Coarse first, so receivers latch the fine value against the new coarse one
+            midiChannel = snapshot->groupMidiChannels[(size_t)(cell / numAttributes)];
+            midiMessages.addEvent(juce::MidiMessage::controllerEvent(midiChannel, snapshot->attributeCCNumbers[attribute], (value >> 7) & 127), samplePosition);
+            midiMessages.addEvent(juce::MidiMessage::controllerEvent(midiChannel, snapshot->attributeEncodings[attribute].fineCC, value & 127), samplePosition);
+            runtimeMetrics.countMidiEvent(midiChannel);
+        }
+        else
+        {
+            midiChannel = snapshot->groupMidiChannels[(size_t)(cell / numAttributes)];
+            midiMessages.addEvent(juce::MidiMessage::controllerEvent(midiChannel, snapshot->attributeCCNumbers[attribute], value), samplePosition);
+        }
+        runtimeMetrics.countMidiEvent(midiChannel);
+
+        // One latency sample per source change, however many smoothed steps it takes
+        if (originTicks != lastSentStamps[(size_t)cell])
+        {
+            lastSentStamps[(size_t)cell] = originTicks;
+            auto sendTicks = blockStartTicks + (juce::int64)(samplePosition * ticksPerSample);
+            latencyMonitor.record(LatencyMonitor::Stage::parameterToMidiDrain, originTicks, sendTicks);
+        } });
+
+    if (busySeconds > 0.0)
+        runtimeMetrics.increment(RuntimeMetrics::Counter::midiLinkBusyMicros, (juce::uint64)(busySeconds * 1000000.0));
+}
+
+const float *KadmiumDMXAudioProcessor::applyAudioModulation(const MidiMapSnapshot &snapshot) noexcept
+{
+    auto numCells = mergeEngine.getNumCells();
+    juce::FloatVectorOperations::copy(modulatedValues.data(), mergeEngine.getOutputValues(), numCells);
+
+    for (const auto &route : snapshot.modulationRoutes)
     {
-        auto *channelData = buffer.getWritePointer(channel);
-        juce::ignoreUnused(channelData);
-        // Audio processing would go here if needed
+        auto source = audioAnalyser.getValue(route.source) * route.depth;
+        auto gain = route.additive ? 1.0f : 1.0f - route.depth + source;
+        auto offset = route.additive ? source : 0.0f;
+
+        for (int group = 0; group < mergeEngine.getNumGroups(); ++group)
+        {
+            auto &value = modulatedValues[(size_t)mergeEngine.getCellIndex(group, route.attributeIndex)];
+            value = juce::jlimit(0.0f, 1.0f, value * gain + offset);
+        }
     }
+
+    return modulatedValues.data();
 }
 
 //==============================================================================
@@ -363,6 +941,7 @@ bool KadmiumDMXAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor *KadmiumDMXAudioProcessor::createEditor()
 {
+    startRuntime();
     return new KadmiumDMXAudioProcessorEditor(*this);
 }
 
@@ -372,17 +951,39 @@ void KadmiumDMXAudioProcessor::getStateInformation(juce::MemoryBlock &destData)
     // Save the parameter state
     auto state = apvts->copyState();
     std::unique_ptr<juce::XmlElement> xml(state.createXml());
+
+    // MIDI-learned input mappings and scenes travel alongside the parameters
+    xml->addChildElement(midiInputMap.createLearnedXml().release());
+    xml->addChildElement(sceneLibrary.createXml().release());
+
     copyXmlToBinary(*xml, destData);
 }
 
 void KadmiumDMXAudioProcessor::setStateInformation(const void *data, int sizeInBytes)
 {
+    if (inputRecorder.isRecording())
+        inputRecorder.recordState(juce::MemoryBlock(data, (size_t)sizeInBytes));
+
     // Restore the parameter state
     std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
 
     if (xmlState.get() != nullptr)
+    {
+        if (auto *learnedXml = xmlState->getChildByName(MidiInputMap::LEARNED_TAG))
+        {
+            midiInputMap.restoreLearned(*learnedXml);
+            xmlState->deleteAllChildElementsWithTagName(MidiInputMap::LEARNED_TAG);
+        }
+
+        if (auto *scenesXml = xmlState->getChildByName(SceneLibrary::SCENES_TAG))
+        {
+            sceneLibrary.restoreFromXml(*scenesXml);
+            xmlState->deleteAllChildElementsWithTagName(SceneLibrary::SCENES_TAG);
+        }
+
         if (xmlState->hasTagName(apvts->state.getType()))
             apvts->replaceState(juce::ValueTree::fromXml(*xmlState));
+    }
 }
 
 //==============================================================================
@@ -390,19 +991,20 @@ void KadmiumDMXAudioProcessor::setStateInformation(const void *data, int sizeInB
 
 juce::Result KadmiumDMXAudioProcessor::loadMidiMap(const juce::String &jsonString)
 {
+    stopFollowingMidiMapFile();
+
     MidiMap newMidiMap;
     auto result = MidiMapSerializer::deserialize(jsonString, newMidiMap);
 
     if (result.wasOk())
     {
-        currentMidiMap = std::move(newMidiMap);
-        recreateParametersFromMidiMap(); // Recreate parameters from new MIDI map
+        applyMidiMap(midiMapLoader.compile(std::move(newMidiMap)));
         DBG("MIDI Map loaded successfully:");
-        DBG(currentMidiMap.toString());
+        DBG(getMidiMap().toString());
     }
     else
     {
-        DBG("Failed to load MIDI Map: " + result.getErrorMessage());
+        KADMIUM_LOG(error, "Failed to load MIDI Map: {}", result.getErrorMessage());
     }
 
     return result;
@@ -410,87 +1012,171 @@ juce::Result KadmiumDMXAudioProcessor::loadMidiMap(const juce::String &jsonStrin
 
 juce::Result KadmiumDMXAudioProcessor::loadMidiMapFromFile(const juce::File &file)
 {
+    stopFollowingMidiMapFile();
+
     MidiMap newMidiMap;
     auto result = MidiMapSerializer::loadFromFile(file, newMidiMap);
 
     if (result.wasOk())
     {
-        currentMidiMap = std::move(newMidiMap);
-        recreateParametersFromMidiMap(); // Recreate parameters from new MIDI map
+        applyMidiMap(midiMapLoader.compile(std::move(newMidiMap)));
         DBG("MIDI Map loaded from file: " + file.getFullPathName());
-        DBG(currentMidiMap.toString());
+        DBG(getMidiMap().toString());
     }
     else
     {
-        DBG("Failed to load MIDI Map from file: " + result.getErrorMessage());
+        KADMIUM_LOG(error, "Failed to load MIDI Map from file: {}", result.getErrorMessage());
     }
 
     return result;
 }
 
+juce::Result KadmiumDMXAudioProcessor::followMidiMapFile(const juce::File &file)
+{
+    auto result = loadMidiMapFromFile(file);
+    if (result.failed())
+        return result;
+
+    followedMidiMapFile = file;
+    midiMapWatcher->addListener(file, this);
+    return result;
+}
+
+void KadmiumDMXAudioProcessor::stopFollowingMidiMapFile()
+{
+    if (followedMidiMapFile == juce::File())
+        return;
+
+    // No more edits arrive once the listener is gone; drop any still being compiled,
+    // so they can't replace the map that is being loaded instead
+    midiMapWatcher->removeListener(this);
+    midiMapLoader.cancelPending();
+    followedMidiMapFile = juce::File();
+}
+
+void KadmiumDMXAudioProcessor::midiMapFileChanged(const juce::File &, const MidiMap &map)
+{
+    // Already parsed by the watcher; compiled on our loader thread and applied on the message thread
+    midiMapLoader.loadAsync(map);
+}
+
+void KadmiumDMXAudioProcessor::handleMidiMapLoaded(std::unique_ptr<const MidiMapSnapshot> snapshot, const juce::Result &result)
+{
+    if (result.failed())
+    {
+        KADMIUM_LOG(error, "Failed to load MIDI map in the background: {}", result.getErrorMessage());
+        return;
+    }
+
+    applyMidiMap(std::move(snapshot));
+    DBG("MIDI map loaded successfully in the background");
+    DBG(getMidiMap().toString());
+}
+
+void KadmiumDMXAudioProcessor::applyMidiMap(std::unique_ptr<const MidiMapSnapshot> snapshot)
+{
+    KADMIUM_TRACE_SPAN("applyMidiMap");
+
+    // Edits that leave the parameters alone keep the APVTS, and with it the host's
+    // automation and the editor's sliders. If the groups and attributes are the same
+    // too, every layer keeps the values it holds.
+    const auto &currentMap = midiMapSnapshot.getForWriter()->map;
+    auto keepParameters = createParameterDefinitions(*snapshot) == parameterDefinitions;
+    auto keepLayerValues = keepParameters && snapshot->map.groups == currentMap.groups
+                           && snapshot->map.attributes == currentMap.attributes;
+
+    // Readers pick the new map up from here on; the audio thread holds its output
+    // until prepareMergeEngine() has resized the grids to match
+    midiMapSnapshot.publish(std::move(snapshot));
+
+    if (keepParameters)
+    {
+        // Same APVTS, so automation keeps arriving: the attribute indices are resolved
+        // into new bindings and published, never rewritten under parameterChanged
+        bindParameters();
+        updateGroupState(keepLayerValues);
+        fullMidiRefreshRequested = true; // Routing may have moved, so send every held cell again
+        sendChangeMessage();
+    }
+    else
+    {
+        recreateParametersFromMidiMap();
+    }
+
+    runtimeMetrics.increment(RuntimeMetrics::Counter::midiMapReloads);
+
+    // Maps from files and MQTT alike are captured as the JSON that was applied
+    if (inputRecorder.isRecording())
+        inputRecorder.recordMidiMap(serializeMidiMap());
+}
+
 void KadmiumDMXAudioProcessor::loadMidiMapFromMqtt()
 {
-    DBG("Loading MIDI map from MQTT...");
+    stopFollowingMidiMapFile();
+    KADMIUM_LOG(info, "Loading MIDI map from MQTT...");
+    startRuntime();
 
-    // Set up MQTT connection callbacks
-    mqttClient.setConnectionCallback([this](bool connected, const juce::String &error)
-                                     {
-        if (connected)
-        {
-            DBG("MQTT connected successfully");
-            // Subscribe to the config/midi_map topic
-            mqttClient.subscribe("config/midi_map");
-        }
-        else
-        {
-            DBG("MQTT connection failed: " + error);
-        } });
+    // Take MIDI maps from the shared subscription (replayed at once if another instance already has one)
+    wantsMidiMapFromMqtt = true;
+    outputHub->subscribe(MIDI_MAP_TOPIC, this);
 
-    mqttClient.setMessageCallback([this](const juce::String &topic, const juce::String &message)
-                                  {
-        if (topic == "config/midi_map")
-        {
-            DBG("Received MIDI map from MQTT: " + message);
-            auto result = loadMidiMap(message);
-            if (result.wasOk())
-            {
-                DBG("MIDI map loaded successfully from MQTT");
-            }
-            else
-            {
-                DBG("Failed to load MIDI map from MQTT: " + result.getErrorMessage());
-            }
-        } });
+    // Connect the shared hub to the broker
+    outputHub->connect(brokerUrl);
+}
+
+juce::String KadmiumDMXAudioProcessor::getDefaultBrokerUrl()
+{
+    auto url = juce::SystemStats::getEnvironmentVariable(BROKER_URL_VARIABLE, {});
+    return url.isNotEmpty() ? url : juce::String(DEFAULT_BROKER_URL);
+}
+
+juce::Result KadmiumDMXAudioProcessor::startInputRecording(const juce::File &file, size_t capacityBytes)
+{
+    auto result = inputRecorder.start(file, capacityBytes);
+    if (result.failed())
+        return result;
+
+    // Everything a replay needs to reach the current state comes first
+    if (getSampleRate() > 0.0)
+        inputRecorder.recordPrepare(getSampleRate(), getBlockSize());
+    inputRecorder.recordMidiMap(serializeMidiMap());
 
-    // Connect to localhost MQTT broker
-    mqttClient.connect("tcp://localhost:1883", "KadmiumDMXPlugin");
+    juce::MemoryBlock state;
+    getStateInformation(state);
+    inputRecorder.recordState(state);
+    inputRecorder.recordSelectGroup(selectedGroupId);
+
+    KADMIUM_LOG(info, "Recording inputs to {}", file.getFullPathName());
+    return result;
 }
 
 juce::String KadmiumDMXAudioProcessor::serializeMidiMap() const
 {
-    return MidiMapSerializer::serialize(currentMidiMap);
+    return MidiMapSerializer::serialize(getMidiMap());
 }
 
 void KadmiumDMXAudioProcessor::createDefaultMidiMap()
 {
     // Create the default MIDI map matching your example
-    currentMidiMap.groups.clear();
-    currentMidiMap.attributes.clear();
+    MidiMap defaultMidiMap;
 
     // Groups - in order
-    currentMidiMap.groups.push_back({"0", "Vocalist"});
-    currentMidiMap.groups.push_back({"1", "Guitarist"});
-    currentMidiMap.groups.push_back({"2", "Bassist"});
-    currentMidiMap.groups.push_back({"3", "Drummer"});
-    currentMidiMap.groups.push_back({"4", "Rear"});
+    defaultMidiMap.groups.push_back({"0", "Vocalist"});
+    defaultMidiMap.groups.push_back({"1", "Guitarist"});
+    defaultMidiMap.groups.push_back({"2", "Bassist"});
+    defaultMidiMap.groups.push_back({"3", "Drummer"});
+    defaultMidiMap.groups.push_back({"4", "Rear"});
 
     // Attributes - in order
-    currentMidiMap.attributes.push_back({"1", "Hue"});
-    currentMidiMap.attributes.push_back({"2", "Saturation"});
-    currentMidiMap.attributes.push_back({"3", "Brightness"});
+    defaultMidiMap.attributes.push_back({"1", "Hue"});
+    defaultMidiMap.attributes.push_back({"2", "Saturation"});
+    defaultMidiMap.attributes.push_back({"3", "Brightness"});
+
+    // Swapped in without a rebuild; the constructor builds the parameters and grids after this
+    midiMapSnapshot.publish(midiMapLoader.compile(std::move(defaultMidiMap)));
 
     DBG("Default MIDI Map created:");
-    DBG(currentMidiMap.toString());
+    DBG(getMidiMap().toString());
 }
 
 //==============================================================================
@@ -502,159 +1188,349 @@ juce::String KadmiumDMXAudioProcessor::getSelectedGroup() const
 
 void KadmiumDMXAudioProcessor::setSelectedGroup(const juce::String &groupId)
 {
-    if (currentMidiMap.hasGroup(groupId))
+    const auto &midiMap = getMidiMap();
+    if (midiMap.hasGroup(groupId))
     {
         selectedGroupId = groupId;
-        DBG("Selected group: " + groupId + " (" + currentMidiMap.getGroupName(groupId) + ")");
+        selectedGroupIndex = getGroupIndex(groupId);
+        inputRecorder.recordSelectGroup(groupId);
+        DBG("Selected group: " + groupId + " (" + midiMap.getGroupName(groupId) + ")");
     }
 }
 
 juce::StringArray KadmiumDMXAudioProcessor::getAvailableGroups() const
 {
-    return currentMidiMap.getAllGroupIds();
+    return getMidiMap().getAllGroupIds();
+}
+
+int KadmiumDMXAudioProcessor::getGroupIndex(const juce::String &groupId) const
+{
+    const RcuPointer<MidiMapSnapshot>::ReadScope snapshot(midiMapSnapshot);
+    return snapshot->getGroupIndex(groupId);
 }
 
 //==============================================================================
 // MIDI output methods
-void KadmiumDMXAudioProcessor::sendMidiCC(int channel, int ccNumber, int value)
+void KadmiumDMXAudioProcessor::sendMidiCC(int channel, int ccNumber, int value, juce::int64 originTicks)
 {
+    KADMIUM_TRACE_SPAN("sendMidiCC");
+
     // Clamp values to valid MIDI ranges
     channel = juce::jlimit(1, 16, channel);
     ccNumber = juce::jlimit(0, 127, ccNumber);
     value = juce::jlimit(0, 127, value);
 
-    // Create MIDI CC message
-    auto midiMessage = juce::MidiMessage::controllerEvent(channel, ccNumber, value);
+    // Add to output queue (will be sent in next processBlock call)
+    {
+        const juce::SpinLock::ScopedLockType lock(midiQueueWriteLock);
+        auto scope = midiQueueFifo.write(1);
+        if (scope.blockSize1 == 0)
+        {
+            runtimeMetrics.increment(RuntimeMetrics::Counter::midiEventsDropped);
+            KADMIUM_LOG(warning, "MIDI output queue full, dropping CC {}", ccNumber);
+            return;
+        }
+
+        midiQueue[(size_t)scope.startIndex1] = {channel, ccNumber, value, originTicks};
+    }
 
-    // Add to output buffer (will be sent in next processBlock call)
-    midiOutputBuffer.addEvent(midiMessage, 0);
+    runtimeMetrics.increment(RuntimeMetrics::Counter::midiEventsQueued);
 
-    DBG("Sending MIDI CC: Channel " + juce::String(channel) +
-        ", CC " + juce::String(ccNumber) +
-        ", Value " + juce::String(value));
+    KADMIUM_LOG(debug, "Sending MIDI CC: Channel {}, CC {}, Value {}", channel, ccNumber, value);
 }
 
 void KadmiumDMXAudioProcessor::sendAllParametersAsMidi()
 {
-    if (!currentMidiMap.hasGroup(selectedGroupId))
-        return;
-
-    // Get the MIDI channel for the selected group
-    int midiChannel = selectedGroupId.getIntValue() + 1; // Convert to 1-based MIDI channel
-
-    // Send all parameters as MIDI CC
-    for (const auto &paramPair : parameterDefinitions)
+    auto groupIndex = selectedGroupIndex.load();
+    if (groupIndex >= 0)
     {
-        const juce::String &paramId = paramPair.first;
-
-        // Find corresponding attribute ID in MIDI map
-        for (const auto &attributePair : currentMidiMap.attributes)
+        auto ticks = LatencyMonitor::now();
+        const RcuPointer<ParameterBindings>::ReadScope bindings(parameterBindings);
+        const juce::SpinLock::ScopedLockType lock(mergeLock);
+        auto &hostLayer = mergeEngine.getLayer(hostLayerIndex);
+
+        // Seed the cells the host has not written yet with the current parameter values,
+        // without refreshing the timestamps (and so the LTP claim) of cells already held
+        for (const auto &bound : bindings->parameters)
         {
-            const juce::String &attributeId = attributePair.first;
-            const juce::String &attributeName = attributePair.second;
+            auto attributeIndex = bound.attributeIndex;
+            if (attributeIndex < 0 || groupIndex >= mergeEngine.getNumGroups() || attributeIndex >= mergeEngine.getNumAttributes())
+                continue;
 
-            // Match parameter to attribute (case-insensitive)
-            if (paramId.containsIgnoreCase(attributeName) ||
-                attributeName.toLowerCase().removeCharacters(" ") == paramId)
-            {
-                // Get parameter value and convert to MIDI range (0-127)
-                float paramValue = getParameterValue(paramId);
-                auto paramDef = getParameterDefinition(paramId);
-
-                // Normalize to 0-1 range, then scale to 0-127
-                float normalizedValue = (paramValue - paramDef.minValue) / (paramDef.maxValue - paramDef.minValue);
-                int midiValue = juce::roundToInt(normalizedValue * 127.0f);
-
-                // Send MIDI CC
-                int ccNumber = attributeId.getIntValue();
-                sendMidiCC(midiChannel, ccNumber, midiValue);
-                break;
-            }
+            auto cell = mergeEngine.getCellIndex(groupIndex, attributeIndex);
+            if (!hostLayer.isActive(cell))
+                hostLayer.set(cell, bound.parameter->convertTo0to1(bound.rawValue->load(std::memory_order_relaxed)), ticks);
         }
     }
+
+    // The next processBlock re-sends every held cell
+    fullMidiRefreshRequested = true;
 }
 
 //==============================================================================
-// Timer callback for periodic MIDI output
-void KadmiumDMXAudioProcessor::timerCallback()
+// Hub refresh for periodic MIDI output
+MemoryFootprint KadmiumDMXAudioProcessor::getMemoryFootprint() const
 {
+    using MF = MemoryFootprint;
+    using Subsystem = MF::Subsystem;
+    MemoryFootprint footprint;
+
+    footprint[Subsystem::instance] = sizeof(*this);
+
+    midiMapSnapshot.forEachObject([&footprint](const MidiMapSnapshot &snapshot)
+                                  { footprint[Subsystem::midiMap] += snapshot.getMemoryUsage(); });
+
+    // The parameter objects and their state-tree entries; the strings are interned
+    auto numParameters = (size_t)getParameters().size();
+    footprint[Subsystem::parameters] = MF::getHeapBytes(parameterDefinitions)
+                                       + sizeof(juce::AudioProcessorValueTreeState)
+                                       + numParameters * (sizeof(juce::AudioParameterFloat) + sizeof(juce::ValueTree));
+
+    // Bindings still held by readers count too
+    parameterBindings.forEachObject([&footprint](const ParameterBindings &bindings)
+                                    { footprint[Subsystem::parameters] += sizeof(bindings) + MF::getHeapBytes(bindings.parameters)
+                                                                           + (size_t)bindings.indices.size() * (sizeof(juce::String) + sizeof(int) + sizeof(void *)); });
+
+    footprint[Subsystem::mergeEngine] = mergeEngine.getMemoryUsage();
+    footprint[Subsystem::outputStages] = outputSmoother.getMemoryUsage() + midiScheduler.getMemoryUsage()
+                                         + MF::getHeapBytes(modulatedValues) + MF::getHeapBytes(attributeRanges)
+                                         + MF::getHeapBytes(attributeDefaults) + MF::getHeapBytes(lastSentMidiValues)
+                                         + MF::getHeapBytes(lastSentStamps) + MF::getHeapBytes(fixtureChannelValues);
+    footprint[Subsystem::midiBuffers] = (size_t)juce::jmax(THRU_BUFFER_BYTES, thruMidiBuffer.data.size());
+    footprint[Subsystem::scenes] = sceneLibrary.getMemoryUsage() + sceneFader.getMemoryUsage();
+    footprint[Subsystem::audioAnalyser] = audioAnalyser.getMemoryUsage();
+    footprint[Subsystem::pixelRenderer] = pixelRenderer.getMemoryUsage();
+
+    footprint[MF::Shared::names] = nameTable->getMemoryUsage();
+    footprint[MF::Shared::outputHub] = outputHub->getMemoryUsage();
+    footprint[MF::Shared::eventLog] = eventLog->getMemoryUsage();
+    return footprint;
+}
+
+void KadmiumDMXAudioProcessor::hubRefresh()
+{
+    KADMIUM_TRACE_SPAN("hubRefresh");
+
+    // Free MIDI maps and parameter bindings replaced since the last refresh, once no
+    // reader still holds them, then the names that only they used
+    midiMapSnapshot.reclaim();
+    parameterBindings.reclaim();
+    nameTable->purge();
+
     // Send all parameters every 5 seconds
     sendAllParametersAsMidi();
+
+    // Stats topics are per instance; the MQTT figures come from the shared hub
+    auto statsSuffix = "/" + juce::String(hubInstanceId);
+
+    // Export latency histograms alongside the refresh
+    if (publishLatencyStats.load() && outputHub->isConnected())
+    {
+        auto *statsObject = new juce::DynamicObject();
+        statsObject->setProperty("midi", latencyMonitor.toVar());
+        statsObject->setProperty("mqtt", outputHub->getLatencyMonitor().toVar());
+        outputHub->publish(LATENCY_STATS_TOPIC + statsSuffix, juce::JSON::toString(juce::var(statsObject), true));
+    }
+
+    // Export runtime counters with rates over the last interval
+    if (publishMetrics.load() && outputHub->isConnected())
+    {
+        auto snapshot = runtimeMetrics.getSnapshot();
+        auto networkSnapshot = outputHub->getRuntimeMetrics().getSnapshot();
+
+        auto *statsObject = new juce::DynamicObject();
+        statsObject->setProperty("instance", runtimeMetrics.toVar(snapshot, lastPublishedMetrics));
+        statsObject->setProperty("hub", outputHub->getRuntimeMetrics().toVar(networkSnapshot, lastPublishedNetworkMetrics));
+        statsObject->setProperty("memory", getMemoryFootprint().toVar());
+        outputHub->publish(METRICS_TOPIC + statsSuffix, juce::JSON::toString(juce::var(statsObject), true));
+
+        lastPublishedMetrics = snapshot;
+        lastPublishedNetworkMetrics = networkSnapshot;
+    }
 }
 
 //==============================================================================
 // Parameter change callback for MIDI output
 void KadmiumDMXAudioProcessor::parameterChanged(const juce::String &parameterID, float newValue)
 {
-    // Send MIDI CC when parameter changes
-    if (!currentMidiMap.hasGroup(selectedGroupId))
+    KADMIUM_TRACE_SPAN("parameterChanged");
+
+    // Timestamp the change for end-to-end latency tracking
+    auto originTicks = LatencyMonitor::now();
+    parameterChangeSequence.fetch_add(1, std::memory_order_release);
+    inputRecorder.recordParameter(parameterID, newValue);
+
+    // Find corresponding attribute in the MIDI map. Automation can land here on the audio
+    // thread, so the bindings and the map are read through their published snapshots.
+    const RcuPointer<ParameterBindings>::ReadScope bindings(parameterBindings);
+    auto groupIndex = selectedGroupIndex.load();
+    auto parameterIndex = bindings->getIndex(parameterID);
+    if (groupIndex < 0 || parameterIndex < 0)
         return;
 
-    // Find corresponding attribute ID in MIDI map
-    for (const auto &attributePair : currentMidiMap.attributes)
-    {
-        const juce::String &attributeId = attributePair.first;
-        const juce::String &attributeName = attributePair.second;
+    const auto &bound = bindings->parameters[(size_t)parameterIndex];
+    auto attributeIndex = bound.attributeIndex;
+    if (attributeIndex < 0)
+        return;
+
+    // The listener gets the value in parameter units; the grid holds it normalised
+    float actualValue = newValue;
+    float currentValue = bound.parameter->convertTo0to1(newValue);
 
-        // Match parameter to attribute (case-insensitive)
-        if (parameterID.containsIgnoreCase(attributeName) ||
-            attributeName.toLowerCase().removeCharacters(" ") == parameterID)
+    // Write the host layer; processBlock merges it with the other sources and sends the CC.
+    // If the merge lock is busy the write is queued for the next holder instead.
+    {
+        const juce::SpinLock::ScopedTryLockType lock(mergeLock);
+        if (lock.isLocked())
+        {
+            applyPendingHostWrites(); // Older writes first
+            if (groupIndex < mergeEngine.getNumGroups() && attributeIndex < mergeEngine.getNumAttributes())
+                mergeEngine.getLayer(hostLayerIndex).set(mergeEngine.getCellIndex(groupIndex, attributeIndex), currentValue, originTicks);
+        }
+        else
         {
-            // Get parameter definition for value conversion
-            auto paramDef = getParameterDefinition(parameterID);
+            queueHostWrite({groupIndex, attributeIndex, currentValue, originTicks});
+        }
+    }
 
-            // Get the actual current value from the parameter
-            auto *param = apvts->getParameter(parameterID);
-            if (param)
-            {
-                float currentValue = param->getValue();
-                // Convert normalized value back to actual range
-                float actualValue = paramDef.minValue + currentValue * (paramDef.maxValue - paramDef.minValue);
+    const RcuPointer<MidiMapSnapshot>::ReadScope snapshot(midiMapSnapshot);
+    if (groupIndex >= snapshot->numGroups || attributeIndex >= snapshot->numAttributes)
+        return;
 
-                // Normalize to 0-1 range, then scale to 0-127
-                float normalizedValue = (actualValue - paramDef.minValue) / (paramDef.maxValue - paramDef.minValue);
-                int midiValue = juce::roundToInt(normalizedValue * 127.0f);
+    // Publish to MQTT if connected (sent from the hub's sender thread)
+    if (outputHub->isConnected())
+        outputHub->publish(snapshot->attributeTopics[snapshot->getCellIndex(groupIndex, attributeIndex)], juce::String(actualValue, 2), originTicks);
 
-                // Send MIDI CC
-                int midiChannel = selectedGroupId.getIntValue() + 1; // Convert to 1-based MIDI channel
-                int ccNumber = attributeId.getIntValue();
-                sendMidiCC(midiChannel, ccNumber, midiValue);
+    KADMIUM_LOG(debug, "Parameter '{}' changed to {} -> group {} {}", parameterID, actualValue,
+                snapshot->map.groups[(size_t)groupIndex].second, snapshot->map.attributes[(size_t)attributeIndex].second);
+}
 
-                // Publish to MQTT if connected
-                if (mqttClient.getConnectionStatus())
-                {
-                    juce::String groupName = currentMidiMap.getGroupName(selectedGroupId);
-                    juce::String topic = "dmx/" + groupName + "/" + attributeName;
-                    mqttClient.publish(topic, juce::String(actualValue, 2));
-                }
+//==============================================================================
+void KadmiumDMXAudioProcessor::hubMessageReceived(const juce::String &topic, const juce::String &message)
+{
+    if (topic == MIDI_MAP_TOPIC)
+    {
+        // Only instances that asked for a map from MQTT follow the shared topic
+        if (!wantsMidiMapFromMqtt.load())
+            return;
 
-                DBG("Parameter '" + parameterID + "' changed to " + juce::String(actualValue) +
-                    " -> MIDI CC Ch" + juce::String(midiChannel) + " CC" + juce::String(ccNumber) +
-                    " Val" + juce::String(midiValue));
-                break;
-            }
-        }
+        // Parsed and compiled in the background, then swapped in on the message thread
+        KADMIUM_LOG(info, "Received MIDI map from MQTT ({} bytes)", message.getNumBytesAsUTF8());
+        midiMapLoader.loadAsync(message);
+        return;
     }
+
+    // Handle incoming DMX commands (maps are captured when applied)
+    inputRecorder.recordMqttMessage(topic, message);
+    handleMqttMessage(topic, message);
 }
 
-//==============================================================================
 //==============================================================================
 void KadmiumDMXAudioProcessor::handleMqttMessage(const juce::String &topic, const juce::String &message)
 {
-    DBG("MQTT message received on '" + topic + "': " + message);
+    KADMIUM_TRACE_SPAN("handleMqttMessage");
+
+    // DMX commands arrive on dmx/<group name or ID>/command as a JSON object of
+    // attribute name or ID -> value in parameter units. A null value releases
+    // that attribute, {"release": true} releases the whole group.
+    auto topicParts = juce::StringArray::fromTokens(topic, "/", "");
+    if (topicParts.size() != 3 || topicParts[0] != "dmx" || topicParts[2] != "command")
+    {
+        KADMIUM_LOG(debug, "MQTT message received on '{}': {}", topic, message);
+        return;
+    }
+
+    if (topicParts[1] == "scene")
+    {
+        handleSceneCommand(juce::JSON::parse(message));
+        return;
+    }
+
+    const RcuPointer<MidiMapSnapshot>::ReadScope snapshot(midiMapSnapshot);
+    auto groupIndex = snapshot->findGroup(topicParts[1]);
+
+    auto command = juce::JSON::parse(message);
+    auto *commandObject = command.getDynamicObject();
+    if (groupIndex < 0 || commandObject == nullptr)
+    {
+        KADMIUM_LOG(warning, "Ignoring DMX command on '{}': {}", topic, message);
+        return;
+    }
+
+    auto ticks = LatencyMonitor::now();
+    const juce::SpinLock::ScopedLockType lock(mergeLock);
+    if (snapshot->generation != preparedGeneration)
+        return; // Resolved against a map the grids aren't sized for yet
+
+    auto &commandLayer = mergeEngine.getLayer(commandLayerIndex);
+
+    for (const auto &property : commandObject->getProperties())
+    {
+        auto key = property.name.toString();
+
+        if (key == "release")
+        {
+            if ((bool)property.value)
+            {
+                for (int attribute = 0; attribute < mergeEngine.getNumAttributes(); ++attribute)
+                    commandLayer.release(mergeEngine.getCellIndex(groupIndex, attribute));
+            }
+            continue;
+        }
+
+        auto attributeIndex = snapshot->findAttribute(key);
+        if (attributeIndex < 0)
+            continue;
+
+        auto cell = mergeEngine.getCellIndex(groupIndex, attributeIndex);
+        if (property.value.isVoid())
+        {
+            commandLayer.release(cell);
+            continue;
+        }
+
+        // Values use the matching parameter's range; attributes without one take raw CC values
+        auto value = (float)property.value;
+        const auto &range = attributeRanges[(size_t)attributeIndex];
+        if (!range.isEmpty())
+        {
+            commandLayer.set(cell, (value - range.getStart()) / range.getLength(), ticks);
+        }
+        else
+        {
+            commandLayer.set(cell, value / 127.0f, ticks);
+        }
+    }
+}
+
+void KadmiumDMXAudioProcessor::handleSceneCommand(const juce::var &command)
+{
+    if (command.hasProperty("capture"))
+    {
+        auto result = captureScene(command["capture"].toString());
+        if (result.failed())
+            KADMIUM_LOG(warning, "Scene capture failed: {}", result.getErrorMessage());
+    }
+
+    if (command.hasProperty("recall"))
+    {
+        auto result = recallScene(command["recall"].toString(), (double)command.getProperty("fade", 0.0));
+        if (result.failed())
+            KADMIUM_LOG(warning, "Scene recall failed: {}", result.getErrorMessage());
+    }
 
-    // TODO: Add MQTT message handling logic here
-    // For example, handle incoming DMX control commands
+    if ((bool)command.getProperty("release", false))
+        releaseScene();
 }
 
 bool KadmiumDMXAudioProcessor::isMqttConnected() const
 {
-    return mqttClient.getConnectionStatus();
+    return outputHub->isConnected();
 }
 
 juce::String KadmiumDMXAudioProcessor::getMqttStatus() const
 {
-    if (mqttClient.getConnectionStatus())
+    if (outputHub->isConnected())
     {
         return "MQTT: Connected";
     }
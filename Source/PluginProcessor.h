@@ -1,14 +1,35 @@
 #pragma once
 
 #include <juce_audio_processors/juce_audio_processors.h>
+#include <array>
+#include "AttributeTypes.h"
+#include "AudioAnalyser.h"
+#include "EventLog.h"
+#include "GroupColourSnapshot.h"
+#include "InputRecorder.h"
+#include "LatencyMonitor.h"
+#include "MemoryFootprint.h"
+#include "MergeEngine.h"
+#include "MidiInputMap.h"
 #include "MidiMap.h"
-#include "MqttClient.h"
+#include "MidiMapFileWatcher.h"
+#include "MidiMapSnapshot.h"
+#include "MidiOutputScheduler.h"
+#include "NameTable.h"
+#include "OutputHub.h"
+#include "OutputSmoother.h"
+#include "PixelMapEngine.h"
+#include "RcuPointer.h"
+#include "RuntimeMetrics.h"
+#include "SceneFader.h"
+#include "SceneLibrary.h"
 
 //==============================================================================
 class KadmiumDMXAudioProcessor : public juce::AudioProcessor,
-                                 public juce::Timer,
                                  public juce::AudioProcessorValueTreeState::Listener,
-                                 public juce::ChangeBroadcaster
+                                 public juce::ChangeBroadcaster,
+                                 private OutputHub::Instance,
+                                 private MidiMapFileWatcher::Listener
 {
 public:
     //==============================================================================
@@ -60,15 +81,30 @@ public:
         float maxValue;
         float defaultValue;
         juce::String unit;
+        float interval = 1.0f;
 
         ParameterDefinition() = default;
         ParameterDefinition(const juce::String &paramId, const juce::String &paramName,
-                            float min, float max, float def, const juce::String &paramUnit)
+                            float min, float max, float def, const juce::String &paramUnit,
+                            float step = 1.0f)
             : id(paramId), name(paramName), minValue(min), maxValue(max),
-              defaultValue(def), unit(paramUnit) {}
+              defaultValue(def), unit(paramUnit), interval(step) {}
+
+        bool operator==(const ParameterDefinition &other) const
+        {
+            return id == other.id && name == other.name && minValue == other.minValue && maxValue == other.maxValue
+                   && defaultValue == other.defaultValue && unit == other.unit && interval == other.interval;
+        }
     };
 
-    // Utility functions for parameter access
+    // Parameter access by index, in getAllParameterDefinitions() order, through pointers
+    // bound when the parameter layout is built. Indices are valid for the current layout
+    // generation. Values are normalised.
+    int getParameterIndex(const juce::String &parameterID) const; // -1 if unknown
+    float getParameterValue(int parameterIndex) const;
+    void setParameterValue(int parameterIndex, float value);
+
+    // By ID, for callers that only have one: looks the index up first
     float getParameterValue(const juce::String &parameterID) const;
     void setParameterValue(const juce::String &parameterID, float value);
 
@@ -81,12 +117,37 @@ public:
     // Get all parameter definitions
     std::vector<ParameterDefinition> getAllParameterDefinitions() const;
 
+    // Change tracking for pollers (e.g. the editor): the sequence is bumped on
+    // every parameter change, the layout generation whenever the APVTS is rebuilt
+    juce::uint32 getParameterChangeSequence() const { return parameterChangeSequence.load(std::memory_order_acquire); }
+    juce::uint32 getParameterLayoutGeneration() const { return parameterLayoutGeneration.load(std::memory_order_acquire); }
+
+    // Raw values of the hue/saturation/brightness parameters (null if the map has none).
+    // Only valid for the current parameter layout generation.
+    struct ColourParameters
+    {
+        std::atomic<float> *hue = nullptr;
+        std::atomic<float> *saturation = nullptr;
+        std::atomic<float> *brightness = nullptr;
+    };
+    ColourParameters getColourParameters() const { return colourParameters; }
+
     //==============================================================================
-    // MIDI Map management
-    const MidiMap &getMidiMap() const { return currentMidiMap; }
+    // MIDI Map management. Maps from MQTT are parsed and compiled in the background,
+    // then swapped in on the message thread; the other loads compile on the caller.
+    // getMidiMap() is for the message thread and valid until the next map is applied.
+    const MidiMap &getMidiMap() const { return midiMapSnapshot.getForWriter()->map; }
     juce::Result loadMidiMap(const juce::String &jsonString);
     juce::Result loadMidiMapFromFile(const juce::File &file);
     void loadMidiMapFromMqtt();
+
+    // Load a map file and keep following it: saves are reparsed in the background and
+    // applied (keeping the parameters when only the routing changed). Instances following
+    // the same file share one watcher and parse each edit once. Loading a map any other
+    // way stops following.
+    juce::Result followMidiMapFile(const juce::File &file);
+    void stopFollowingMidiMapFile();
+    juce::File getFollowedMidiMapFile() const { return followedMidiMapFile; }
     juce::String serializeMidiMap() const;
     void createDefaultMidiMap();
 
@@ -94,14 +155,97 @@ public:
     juce::String getSelectedGroup() const;
     void setSelectedGroup(const juce::String &groupId);
     juce::StringArray getAvailableGroups() const;
+    int getGroupIndex(const juce::String &groupId) const; // Position in the MIDI map, or -1
+    int getSelectedGroupIndex() const { return selectedGroupIndex.load(); }
+
+    // Colour currently output for every group, for the rig visualiser
+    const GroupColourSnapshot &getGroupColourSnapshot() const { return groupColours; }
 
-    // MIDI output functionality
-    void sendMidiCC(int channel, int ccNumber, int value);
+    // MIDI output functionality (originTicks is the LatencyMonitor timestamp of the causing change)
+    void sendMidiCC(int channel, int ccNumber, int value, juce::int64 originTicks = 0);
     void sendAllParametersAsMidi();
 
-    // MQTT functionality
+    // Output merge: every source writes its own layer, processBlock merges them per block.
+    // Sources of equal priority are arbitrated per attribute (HTP or LTP from the map).
+    enum class MergeSource
+    {
+        host,      // Automation and the editor
+        command,   // Inbound dmx/<group>/command messages
+        midiInput, // Incoming CCs and notes
+        scene      // Recalled scenes
+    };
+    void setMergeSourcePriority(MergeSource source, int priority);
+    static constexpr int DEFAULT_MERGE_PRIORITY = 100;
+
+    // Bandwidth of the MIDI link CCs are paced to (defaults to DIN MIDI, 0 = unlimited)
+    void setMidiLinkBytesPerSecond(double bytesPerSecond);
+
+    // MIDI input: incoming CCs and notes are translated through the input map into the
+    // MIDI input merge layer. Thru passes events on, merged with the generated output.
+    enum class MidiThruMode
+    {
+        none,
+        unmapped, // Only events that don't drive an attribute
+        all
+    };
+    void setMidiThruMode(MidiThruMode mode) { midiThruMode = (int)mode; }
+    MidiThruMode getMidiThruMode() const { return (MidiThruMode)midiThruMode.load(); }
+
+    // MIDI learn: the next CC or note-on received drives this parameter for the selected group
+    void startMidiLearn(const juce::String &parameterID);
+    void cancelMidiLearn() { midiLearnTarget = -1; }
+    bool isMidiLearnActive() const { return midiLearnTarget.load() >= 0; }
+    void clearMidiLearn() { midiInputMap.clearLearned(); }
+
+    // Scenes: named snapshots of the whole output, stored in the plugin state and
+    // recalled with a crossfade. Also driven by dmx/scene/command messages.
+    juce::Result captureScene(const juce::String &name);
+    juce::Result recallScene(const juce::String &name, double fadeSeconds);
+    void releaseScene();
+    bool removeScene(const juce::String &name) { return sceneLibrary.remove(name); }
+    juce::StringArray getSceneNames() const { return sceneLibrary.getNames(); }
+
+    // MQTT functionality. The broker defaults to $KADMIUM_MQTT_BROKER, else localhost:1883;
+    // set it before loadMidiMapFromMqtt(). The connection is shared, so instances should agree.
     bool isMqttConnected() const;
     juce::String getMqttStatus() const;
+    void setBrokerUrl(const juce::String &url) { brokerUrl = url; }
+    const juce::String &getBrokerUrl() const { return brokerUrl; }
+    static juce::String getDefaultBrokerUrl();
+
+    // Latency instrumentation (MIDI path per instance, MQTT path shared by the hub)
+    const LatencyMonitor &getLatencyMonitor() const { return latencyMonitor; }
+    const LatencyMonitor &getNetworkLatencyMonitor() const { return outputHub->getLatencyMonitor(); }
+    void resetLatencyStats() { latencyMonitor.reset(); }
+    void setLatencyStatsPublishingEnabled(bool shouldPublish) { publishLatencyStats = shouldPublish; }
+    bool isLatencyStatsPublishingEnabled() const { return publishLatencyStats.load(); }
+    static constexpr const char *LATENCY_STATS_TOPIC = "dmx/stats/latency";
+
+    // Runtime counters (MIDI path per instance, MQTT connection shared by the hub)
+    const RuntimeMetrics &getRuntimeMetrics() const { return runtimeMetrics; }
+    const RuntimeMetrics &getNetworkMetrics() const { return outputHub->getRuntimeMetrics(); }
+    void setMetricsPublishingEnabled(bool shouldPublish) { publishMetrics = shouldPublish; }
+    bool isMetricsPublishingEnabled() const { return publishMetrics.load(); }
+    static constexpr const char *METRICS_TOPIC = "dmx/stats/metrics";
+
+    // Bytes held by this instance per subsystem, and by the state all instances share
+    // (message thread). Also published with the metrics.
+    MemoryFootprint getMemoryFootprint() const;
+
+    // Input capture for reproducing problems: parameter changes, MQTT commands, map loads,
+    // state restores, group selections and each block's size, position and MIDI go to a
+    // ring file with their times (message thread). Tools/InputReplay feeds a trace back.
+    // Set $KADMIUM_INPUT_TRACE to a file to capture every instance from its start.
+    juce::Result startInputRecording(const juce::File &file, size_t capacityBytes = InputRecorder::DEFAULT_CAPACITY_BYTES);
+    void stopInputRecording() { inputRecorder.stop(); }
+    bool isRecordingInputs() const { return inputRecorder.isRecording(); }
+    const InputRecorder &getInputRecorder() const { return inputRecorder; }
+
+    // Diagnostics shared by every instance, formatted off the calling threads
+    EventLog &getEventLog() { return *eventLog; }
+
+    // Feed a message in as if it came from the broker, e.g. when replaying a trace
+    void injectMqttMessage(const juce::String &topic, const juce::String &message) { hubMessageReceived(topic, message); }
 
 private:
     //==============================================================================
@@ -111,32 +255,217 @@ private:
     // Dynamic parameter definitions - preserves order from MIDI map
     std::vector<std::pair<juce::String, ParameterDefinition>> parameterDefinitions;
 
-    // MIDI Map for group and attribute mapping
-    MidiMap currentMidiMap;
+    // Change tracking
+    std::atomic<juce::uint32> parameterChangeSequence{0};
+    std::atomic<juce::uint32> parameterLayoutGeneration{0};
+
+    // Compiled MIDI map, read lock-free from any thread. Swapped on the message thread;
+    // replaced snapshots are freed there once no reader can still hold them.
+    RcuPointer<MidiMapSnapshot> midiMapSnapshot;
+    juce::uint32 preparedGeneration = 0; // snapshot the grids below are sized for (under mergeLock)
 
     // Selected group for MIDI output
     juce::String selectedGroupId;
+    std::atomic<int> selectedGroupIndex{-1};
+
+    // Per-group output colour and the parameters it is derived from
+    GroupColourSnapshot groupColours;
+    ColourParameters colourParameters;
+
+    // Merge stage state. Writers take the lock; processBlock only tries it and
+    // skips the frame if it is contended.
+    MergeEngine mergeEngine;
+    int hostLayerIndex = -1;
+    int commandLayerIndex = -1;
+    int inputLayerIndex = -1;
+    int sceneLayerIndex = -1;
+    juce::SpinLock mergeLock;
+
+    // Smoothing between the merged frame and the CCs, advanced once per block
+    OutputSmoother outputSmoother;
+    double currentSampleRate = 44100.0;
+
+    // Audio-reactive modulation: analysis of the host audio (audio-reactive build only)
+    // applied to the merged frame before smoothing, through the snapshot's routes
+    AudioAnalyser audioAnalyser;
+    bool audioInputActive = false;          // audio thread: the host gave us input channels this block
+    bool modulationApplied = false;         // audio thread: the smoother targets are modulated
+    std::vector<float> modulatedValues;     // per cell
+
+    // Stored scenes and the fade that drives the scene layer
+    SceneLibrary sceneLibrary;
+    SceneFader sceneFader;
+
+    // Paces the CCs to the link bandwidth, collapsing values still waiting
+    MidiOutputScheduler midiScheduler;
+
+    // MIDI input translation. Updates are collected by the audio thread and
+    // applied to the input layer once it holds the merge lock.
+    struct PendingInput
+    {
+        int groupIndex = 0;
+        int attributeIndex = 0;
+        float value = 0.0f; // Negative releases the cell (note off)
+        juce::int64 originTicks = 0;
+    };
 
-    // MIDI output buffer for sending CC messages
-    juce::MidiBuffer midiOutputBuffer;
-
-    // Timer for periodic MIDI output (every 5 seconds)
-    static constexpr int MIDI_BLAST_INTERVAL_MS = 5000; // 5 seconds
+    static constexpr int MAX_PENDING_INPUTS = 512;
+    MidiInputMap midiInputMap;
+    std::array<PendingInput, MAX_PENDING_INPUTS> pendingInputs;
+    int numPendingInputs = 0;
+
+    // Host parameter writes that found the merge lock busy, applied in order by whoever
+    // holds it next. Their own lock is only held to copy an entry, so automation on the
+    // audio thread never waits behind prepareMergeEngine().
+    static constexpr int MAX_PENDING_HOST_WRITES = 256;
+    std::array<PendingInput, MAX_PENDING_HOST_WRITES> pendingHostWrites;
+    int numPendingHostWrites = 0;
+    juce::SpinLock pendingHostWriteLock;
+    void queueHostWrite(const PendingInput &write);
+    void applyPendingHostWrites(); // Caller holds mergeLock
+    std::atomic<int> midiThruMode{(int)MidiThruMode::unmapped};
+    std::atomic<juce::int32> midiLearnTarget{-1}; // group << 16 | attribute, -1 when not learning
+    juce::MidiBuffer thruMidiBuffer;
+    static constexpr int THRU_BUFFER_BYTES = 4096; // reserved by prepareToPlay
+
+    // Per-instance output state for the merged grid (the routing is in the snapshot)
+    std::vector<juce::Range<float>> attributeRanges; // per attribute index, the bound parameter's range; empty without one
+    std::vector<float> attributeDefaults;       // normalised, used for released cells
+    std::vector<int> lastSentMidiValues;        // per output cell, encoded value, -1 when nothing was sent
+    std::vector<juce::int64> lastSentStamps;    // per output cell, source timestamp of the last latency sample
+    std::vector<float> fixtureChannelValues;    // profile render scratch, sized for the largest profile
+    std::atomic<bool> fullMidiRefreshRequested{false};
+
+    // Pending MIDI CC messages, queued by sendMidiCC and drained by processBlock
+    struct PendingMidiEvent
+    {
+        int channel = 1;
+        int ccNumber = 0;
+        int value = 0;
+        juce::int64 originTicks = 0;
+    };
 
-    // MQTT client for networked DMX control
-    MqttClient mqttClient;
+    static constexpr int MIDI_QUEUE_SIZE = 1024;
+    juce::AbstractFifo midiQueueFifo{MIDI_QUEUE_SIZE};
+    std::array<PendingMidiEvent, MIDI_QUEUE_SIZE> midiQueue;
+    juce::SpinLock midiQueueWriteLock; // Writers only; the audio thread reads lock-free
+
+    // End-to-end latency histograms for the MIDI path
+    LatencyMonitor latencyMonitor;
+    std::atomic<bool> publishLatencyStats{false};
+
+    // Runtime counters for the MIDI path
+    RuntimeMetrics runtimeMetrics;
+    std::atomic<bool> publishMetrics{false};
+    RuntimeMetrics::Snapshot lastPublishedMetrics;
+    RuntimeMetrics::Snapshot lastPublishedNetworkMetrics;
+
+    // Process-wide log, created before the hub so its lines have somewhere to go
+    juce::SharedResourcePointer<EventLog> eventLog;
+
+    // Process-wide hub: shared MQTT connection, sender thread and refresh timer
+    juce::SharedResourcePointer<OutputHub> outputHub;
+    int hubInstanceId = -1;
+    std::atomic<bool> runtimeStarted{false};
+
+    // Process-wide pool of the names, IDs and topics every instance's maps and parameters use
+    juce::SharedResourcePointer<NameTable> nameTable;
+    std::atomic<bool> wantsMidiMapFromMqtt{false};
+    static constexpr const char *MIDI_MAP_TOPIC = "config/midi_map";
+    static constexpr const char *DEFAULT_BROKER_URL = "tcp://localhost:1883";
+    static constexpr const char *BROKER_URL_VARIABLE = "KADMIUM_MQTT_BROKER";
+    juce::String brokerUrl = getDefaultBrokerUrl();
+
+    // Captured inputs; idle (no thread or buffers) until started
+    InputRecorder inputRecorder;
+    static constexpr const char *INPUT_TRACE_VARIABLE = "KADMIUM_INPUT_TRACE";
+
+    // Pixel-mapped groups, rendered on their own thread and published per universe
+    PixelMapRenderer pixelRenderer{groupColours, [this](int universe, const juce::uint8 *data, int size)
+                                   { publishUniverse(universe, data, size); }};
+    static constexpr const char *UNIVERSE_TOPIC_PREFIX = "dmx/universe/";
+
+    // Map file this instance follows, through the process-wide watcher
+    juce::SharedResourcePointer<MidiMapFileWatcher> midiMapWatcher;
+    juce::File followedMidiMapFile;
+    void midiMapFileChanged(const juce::File &file, const MidiMap &map) override;
+
+    // Background parsing and compiling of maps from MQTT and followed files
+    MidiMapLoader midiMapLoader{[this](std::unique_ptr<const MidiMapSnapshot> snapshot, const juce::Result &result)
+                                { handleMidiMapLoaded(std::move(snapshot), result); }};
+
+    // Join the output hub and start the pixel renderer. Called by the first prepareToPlay(),
+    // createEditor() or MQTT map request; later calls do nothing.
+    void startRuntime();
 
     // Initialize parameter definitions
     void initializeParameterDefinitions();
 
     // Recreate parameters from MIDI map attributes
     void recreateParametersFromMidiMap();
+    std::vector<std::pair<juce::String, ParameterDefinition>> createParameterDefinitions(const MidiMapSnapshot &snapshot);
+
+    // Rebind the parameter pointers and colour values after the APVTS is rebuilt
+    void bindParameters();
+    void bindColourParameters();
+
+    // Refresh group indices and the colour snapshot after a map change. The held values
+    // may be kept only when the new map has the same groups and attributes.
+    void updateGroupState(bool keepLayerValues = false);
+
+    // Swap in a compiled map and rebuild the parameters and grids for it (message thread)
+    void applyMidiMap(std::unique_ptr<const MidiMapSnapshot> snapshot);
+    void handleMidiMapLoaded(std::unique_ptr<const MidiMapSnapshot> snapshot, const juce::Result &result);
+
+    // dmx/universe/<n>, base64 channel data (pixel render thread)
+    void publishUniverse(int universe, const juce::uint8 *data, int size);
+
+    // Resize the merge grid and configure the per-instance output stages for the current map
+    void prepareMergeEngine(bool keepLayerValues = false);
+
+    // Attribute index in the map for a parameter ID, or -1 (precompiled with the parameters)
+    int getAttributeIndexForParameter(const juce::String &parameterID) const;
+
+    // Per parameter index, so bulk paths don't look parameters up by ID
+    struct BoundParameter
+    {
+        juce::RangedAudioParameter *parameter = nullptr;
+        std::atomic<float> *rawValue = nullptr; // in parameter units
+        int attributeIndex = -1;                // resolved against the map when bound
+    };
+
+    // Bindings for one parameter layout and map. Built in full by bindParameters() and
+    // published, never modified, so automation on the audio thread reads them under a
+    // ReadScope while the message thread rebinds for a new map.
+    struct ParameterBindings
+    {
+        std::vector<BoundParameter> parameters;
+        juce::HashMap<juce::String, int> indices; // ID -> index
+
+        int getIndex(const juce::String &parameterID) const { return indices.contains(parameterID) ? indices[parameterID] : -1; }
+    };
+    RcuPointer<ParameterBindings> parameterBindings;
+
+    // dmx/scene/command: {"recall": name, "fade": seconds}, {"capture": name} or {"release": true}
+    void handleSceneCommand(const juce::var &command);
+
+    // Translate incoming events and replace the buffer with the thru events (audio thread)
+    void handleMidiInput(juce::MidiBuffer &midiMessages);
+
+    // Merge all layers, smooth them over the block, queue every CC whose quantised
+    // value changed and send what the link allows (audio thread). numDirectEvents
+    // is the number of CCs already sent this block from the sendMidiCC queue.
+    void renderMergedOutput(juce::MidiBuffer &midiMessages, int numSamples, int numDirectEvents);
+
+    // Merged frame with the audio modulation routes applied (audio thread)
+    const float *applyAudioModulation(const MidiMapSnapshot &snapshot) noexcept;
 
     // Create parameter layout from definitions
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
-    // Timer callback for periodic MIDI output
-    void timerCallback() override;
+    // OutputHub::Instance callbacks
+    void hubRefresh() override;
+    void hubMessageReceived(const juce::String &topic, const juce::String &message) override;
 
     // Parameter change callback for MIDI output
     void parameterChanged(const juce::String &parameterID, float newValue) override;
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/**
+ * Read-copy-update pointer to an immutable object.
+ *
+ * One writer thread builds a complete object and publish()es it with a
+ * single atomic pointer swap. Readers on any thread open a ReadScope, which
+ * costs two atomic increments and a load. They never block and never see a
+ * half-built object.
+ *
+ * Replaced objects are retired rather than deleted. reclaim() deletes them
+ * on the writer thread once no reader can still hold them. Readers register
+ * in one of two counters, picked by the parity of a grace-period epoch. An
+ * object retired in epoch E is freed after the writer has advanced to E + 2.
+ * Each advance waits for the readers of the counter it is about to reuse,
+ * so nothing is freed under a reader, and a stalled reader only delays
+ * reclamation.
+ */
+template <typename ObjectType>
+class RcuPointer
+{
+public:
+    RcuPointer() = default;
+
+    ~RcuPointer()
+    {
+        // No readers may remain
+        delete current.load(std::memory_order_acquire);
+    }
+
+    //==============================================================================
+    class ReadScope
+    {
+    public:
+        explicit ReadScope(const RcuPointer &pointerToRead) noexcept
+            : owner(pointerToRead),
+              slot(owner.epoch.load(std::memory_order_seq_cst) & 1)
+        {
+            owner.readers[slot].fetch_add(1, std::memory_order_seq_cst);
+            object = owner.current.load(std::memory_order_seq_cst);
+        }
+
+        ~ReadScope() { owner.readers[slot].fetch_sub(1, std::memory_order_release); }
+
+        const ObjectType *get() const noexcept { return object; }
+        const ObjectType *operator->() const noexcept { return object; }
+        const ObjectType &operator*() const noexcept { return *object; }
+
+    private:
+        const RcuPointer &owner;
+        juce::uint32 slot;
+        const ObjectType *object = nullptr;
+
+        JUCE_DECLARE_NON_COPYABLE(ReadScope)
+    };
+
+    //==============================================================================
+    // Writer thread only
+    void publish(std::unique_ptr<const ObjectType> newObject)
+    {
+        auto *previous = current.exchange(newObject.release(), std::memory_order_seq_cst);
+        if (previous != nullptr)
+            retired.push_back({std::unique_ptr<const ObjectType>(previous), epoch.load(std::memory_order_relaxed)});
+
+        reclaim();
+    }
+
+    // The current object, without a scope. Valid until the writer next publishes.
+    const ObjectType *getForWriter() const noexcept { return current.load(std::memory_order_relaxed); }
+
+    // Visit the current object and every retired one not yet freed
+    template <typename Visitor>
+    void forEachObject(Visitor &&visit) const
+    {
+        if (auto *object = getForWriter())
+            visit(*object);
+
+        for (const auto &entry : retired)
+            visit(*entry.object);
+    }
+
+    // Free what no reader can still hold; returns the number still waiting
+    int reclaim()
+    {
+        while (!retired.empty())
+        {
+            auto currentEpoch = epoch.load(std::memory_order_relaxed);
+            retired.erase(std::remove_if(retired.begin(), retired.end(), [currentEpoch](const Retired &entry)
+                                         { return currentEpoch - entry.epoch >= 2; }),
+                          retired.end());
+
+            if (retired.empty() || readers[(currentEpoch + 1) & 1].load(std::memory_order_seq_cst) != 0)
+                break;
+
+            epoch.store(currentEpoch + 1, std::memory_order_seq_cst);
+        }
+
+        return (int)retired.size();
+    }
+
+private:
+    struct Retired
+    {
+        std::unique_ptr<const ObjectType> object;
+        juce::uint32 epoch = 0;
+    };
+
+    std::atomic<const ObjectType *> current{nullptr};
+    std::atomic<juce::uint32> epoch{0};
+    mutable std::array<std::atomic<int>, 2> readers{};
+    std::vector<Retired> retired;
+
+    JUCE_DECLARE_NON_COPYABLE(RcuPointer)
+};
@@ -0,0 +1,165 @@
+#include "RenderPool.h"
+
+//==============================================================================
+class RenderPool::Worker : public juce::Thread
+{
+public:
+    Worker(RenderPool &ownerPool, int participantIndex)
+        : juce::Thread("Render worker " + juce::String(participantIndex)), owner(ownerPool), participant(participantIndex)
+    {
+    }
+
+    ~Worker() override
+    {
+        signalThreadShouldExit();
+        frameReady.signal();
+        stopThread(1000);
+    }
+
+    void startFrame() { frameReady.signal(); }
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            frameReady.wait();
+            if (threadShouldExit())
+                break;
+
+            owner.runJobs(participant);
+            owner.workersBusy.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+private:
+    RenderPool &owner;
+    int participant;
+    juce::WaitableEvent frameReady;
+};
+
+//==============================================================================
+RenderPool::RenderPool()
+    : RenderPool(juce::SystemStats::getNumCpus() - 1)
+{
+}
+
+RenderPool::RenderPool(int numWorkers)
+{
+    numParticipants = juce::jlimit(0, MAX_WORKERS, numWorkers) + 1;
+    ranges.reset(new JobRange[(size_t)numParticipants]);
+}
+
+RenderPool::~RenderPool()
+{
+    workers.clear();
+}
+
+//==============================================================================
+void RenderPool::run(int numJobs, JobInvoker invoker, void *context)
+{
+    if (numJobs <= 0)
+        return;
+
+    const juce::ScopedLock lock(callLock);
+
+    // Small frames aren't worth waking anyone for
+    if (numParticipants == 1 || numJobs == 1)
+    {
+        for (int job = 0; job < numJobs; ++job)
+            invoker(context, job);
+        return;
+    }
+
+    if (workers.empty())
+        startWorkers();
+
+    currentInvoker = invoker;
+    currentContext = context;
+    jobsRemaining.store(numJobs, std::memory_order_relaxed);
+
+    // Deal contiguous ranges, so neighbouring jobs (and their cache lines) stay on one core
+    for (int participant = 0; participant < numParticipants; ++participant)
+    {
+        auto begin = (juce::uint32)((juce::int64)numJobs * participant / numParticipants);
+        auto end = (juce::uint32)((juce::int64)numJobs * (participant + 1) / numParticipants);
+        ranges[(size_t)participant].packed.store(pack(begin, end), std::memory_order_relaxed);
+    }
+
+    workersBusy.store((int)workers.size(), std::memory_order_release);
+    for (auto &worker : workers)
+        worker->startFrame();
+
+    runJobs(0);
+
+    // Stragglers: wait for the last jobs, then for every worker to let go of the context
+    while (jobsRemaining.load(std::memory_order_acquire) > 0 || workersBusy.load(std::memory_order_acquire) > 0)
+        juce::Thread::yield();
+
+    currentInvoker = nullptr;
+    currentContext = nullptr;
+}
+
+void RenderPool::startWorkers()
+{
+    for (int participant = 1; participant < numParticipants; ++participant)
+    {
+        workers.push_back(std::make_unique<Worker>(*this, participant));
+        workers.back()->startThread(juce::Thread::Priority::high);
+    }
+}
+
+void RenderPool::runJobs(int participant) noexcept
+{
+    int job = 0;
+    while (takeJob(participant, job) || stealJob(participant, job))
+    {
+        currentInvoker(currentContext, job);
+        jobsRemaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+bool RenderPool::takeJob(int participant, int &job) noexcept
+{
+    auto &range = ranges[(size_t)participant].packed;
+    auto current = range.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        auto begin = (juce::uint32)(current >> 32);
+        auto end = (juce::uint32)current;
+        if (begin >= end)
+            return false;
+
+        if (range.compare_exchange_weak(current, pack(begin + 1, end), std::memory_order_acq_rel))
+        {
+            job = (int)begin;
+            return true;
+        }
+    }
+}
+
+bool RenderPool::stealJob(int thief, int &job) noexcept
+{
+    // Start with the next participant along, so thieves spread over their victims
+    for (int offset = 1; offset < numParticipants; ++offset)
+    {
+        auto &range = ranges[(size_t)((thief + offset) % numParticipants)].packed;
+        auto current = range.load(std::memory_order_acquire);
+
+        for (;;)
+        {
+            auto begin = (juce::uint32)(current >> 32);
+            auto end = (juce::uint32)current;
+            if (begin >= end)
+                break;
+
+            if (range.compare_exchange_weak(current, pack(begin, end - 1), std::memory_order_acq_rel))
+            {
+                job = (int)(end - 1);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
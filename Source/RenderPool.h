@@ -0,0 +1,76 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+//==============================================================================
+/**
+ * Fixed-size worker pool for splitting a frame into independent jobs.
+ *
+ * parallelFor() deals the job indices out as one contiguous range per
+ * participant: the calling thread plus every worker. Each participant
+ * takes jobs from the front of its own range. Once that range is empty it
+ * steals single jobs from the back of the others, so an uneven split still
+ * finishes together. A range is one packed atomic word, so taking and
+ * stealing are both a single compare-and-swap.
+ *
+ * The call returns once every job has run and no worker still references
+ * the job function. Calls from several threads are serialised, which lets
+ * one pool be shared by every instance through juce::SharedResourcePointer.
+ * Workers are started by the first call with more than one job, so a pool
+ * that is never used costs no threads. After that, parallelFor() does not
+ * allocate.
+ */
+class RenderPool
+{
+public:
+    // One worker per core beyond the caller's, up to MAX_WORKERS
+    RenderPool();
+    explicit RenderPool(int numWorkers);
+    ~RenderPool();
+
+    template <typename Function>
+    void parallelFor(int numJobs, Function &&function)
+    {
+        run(numJobs, [](void *context, int job)
+            { (*static_cast<std::remove_reference_t<Function> *>(context))(job); },
+            const_cast<void *>(static_cast<const void *>(&function)));
+    }
+
+    int getNumWorkers() const { return numParticipants - 1; }
+
+    static constexpr int MAX_WORKERS = 15;
+
+private:
+    using JobInvoker = void (*)(void *context, int job);
+
+    class Worker;
+
+    struct alignas(64) JobRange
+    {
+        std::atomic<juce::uint64> packed{0}; // begin << 32 | end
+    };
+
+    void run(int numJobs, JobInvoker invoker, void *context);
+    void startWorkers();
+    void runJobs(int participant) noexcept;
+    bool takeJob(int participant, int &job) noexcept;
+    bool stealJob(int thief, int &job) noexcept;
+
+    static juce::uint64 pack(juce::uint32 begin, juce::uint32 end) noexcept { return ((juce::uint64)begin << 32) | end; }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::unique_ptr<JobRange[]> ranges; // participant 0 is the caller, 1.. the workers
+    int numParticipants = 1;
+
+    JobInvoker currentInvoker = nullptr;
+    void *currentContext = nullptr;
+    std::atomic<int> jobsRemaining{0};
+    std::atomic<int> workersBusy{0};
+    juce::CriticalSection callLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderPool)
+};
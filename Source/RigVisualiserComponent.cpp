@@ -0,0 +1,217 @@
+#include "RigVisualiserComponent.h"
+#include <optional>
+
+//==============================================================================
+RigVisualiserComponent::RigVisualiserComponent(const GroupColourSnapshot &snapshot)
+    : colourSnapshot(snapshot)
+{
+    setOpaque(true);
+}
+
+RigVisualiserComponent::~RigVisualiserComponent()
+{
+    stopTimer();
+}
+
+//==============================================================================
+void RigVisualiserComponent::paint(juce::Graphics &g)
+{
+    // Only the dirty region is blitted from the cache
+    if (cache.isValid())
+        g.drawImageAt(cache, 0, 0);
+    else
+        g.fillAll(juce::Colours::black);
+}
+
+void RigVisualiserComponent::resized()
+{
+    rebuildLayout();
+}
+
+void RigVisualiserComponent::visibilityChanged()
+{
+    updateTimerState();
+}
+
+void RigVisualiserComponent::parentHierarchyChanged()
+{
+    updateTimerState();
+}
+
+void RigVisualiserComponent::updateTimerState()
+{
+    if (isShowing())
+    {
+        if (!isTimerRunning())
+        {
+            // Catch up on anything that changed while we were hidden
+            layoutDirty = true;
+            startTimerHz(FRAME_RATE_HZ);
+        }
+    }
+    else
+    {
+        stopTimer();
+    }
+}
+
+//==============================================================================
+void RigVisualiserComponent::setGroupNames(const juce::StringArray &names)
+{
+    groupNames = names;
+    rebuildLayout();
+}
+
+void RigVisualiserComponent::setSelectedGroupIndex(int groupIndex)
+{
+    if (groupIndex == selectedGroupIndex)
+        return;
+
+    auto previousIndex = selectedGroupIndex;
+    selectedGroupIndex = groupIndex;
+
+    if (layoutDirty || !cache.isValid())
+        return;
+
+    // Redraw just the two affected cells
+    juce::Graphics g(cache);
+    for (auto index : {previousIndex, selectedGroupIndex})
+    {
+        if (index >= 0 && index < numGroups)
+        {
+            drawCell(g, index, colourSnapshot.getColour(index));
+            repaint(getCellBounds(index));
+        }
+    }
+}
+
+//==============================================================================
+void RigVisualiserComponent::timerCallback()
+{
+    if (layoutDirty || colourSnapshot.getNumGroups() != numGroups)
+    {
+        rebuildLayout();
+        return;
+    }
+
+    // Nothing in the rig changed since the last frame
+    auto sequence = colourSnapshot.getSequence();
+    if (sequence == drawnSequence || !cache.isValid())
+        return;
+
+    drawnSequence = sequence;
+
+    juce::RectangleList<int> dirtyCells;
+    int numDirty = 0;
+
+    {
+        std::optional<juce::Graphics> g;
+
+        for (int i = 0; i < numGroups; ++i)
+        {
+            auto version = colourSnapshot.getVersion(i);
+            if (version == drawnVersions[(size_t)i])
+                continue;
+
+            drawnVersions[(size_t)i] = version;
+
+            if (!g.has_value())
+                g.emplace(cache);
+
+            drawCell(*g, i, colourSnapshot.getColour(i));
+            dirtyCells.addWithoutMerging(getCellBounds(i));
+            ++numDirty;
+        }
+    }
+
+    // Past a quarter of the rig a single full repaint is cheaper than many small ones
+    if (numDirty > numGroups / 4)
+    {
+        repaint();
+    }
+    else
+    {
+        for (const auto &cell : dirtyCells)
+            repaint(cell);
+    }
+}
+
+void RigVisualiserComponent::rebuildLayout()
+{
+    layoutDirty = false;
+    numGroups = colourSnapshot.getNumGroups();
+
+    auto width = getWidth();
+    auto height = getHeight();
+    if (width <= 0 || height <= 0)
+    {
+        cache = {};
+        layoutDirty = true;
+        return;
+    }
+
+    // Pick a column count that keeps cells roughly square
+    auto aspect = (double)width / (double)height;
+    numColumns = juce::jmax(1, (int)std::ceil(std::sqrt((double)juce::jmax(1, numGroups) * aspect)));
+    numRows = juce::jmax(1, (numGroups + numColumns - 1) / numColumns);
+
+    if (!cache.isValid() || cache.getWidth() != width || cache.getHeight() != height)
+        cache = juce::Image(juce::Image::RGB, width, height, false);
+
+    // Read the sequence before the versions so a concurrent change is picked up next frame
+    drawnSequence = colourSnapshot.getSequence();
+    drawnVersions.assign((size_t)numGroups, 0);
+
+    {
+        juce::Graphics g(cache);
+        g.fillAll(juce::Colours::black);
+
+        for (int i = 0; i < numGroups; ++i)
+        {
+            drawnVersions[(size_t)i] = colourSnapshot.getVersion(i);
+            drawCell(g, i, colourSnapshot.getColour(i));
+        }
+    }
+
+    repaint();
+}
+
+void RigVisualiserComponent::drawCell(juce::Graphics &g, int groupIndex, juce::uint32 argb) const
+{
+    auto bounds = getCellBounds(groupIndex);
+    auto colour = juce::Colour(argb);
+
+    g.setColour(juce::Colours::black);
+    g.fillRect(bounds);
+
+    auto inner = bounds.reduced(1);
+    g.setColour(colour);
+    g.fillRect(inner);
+
+    if (groupIndex == selectedGroupIndex)
+    {
+        g.setColour(juce::Colours::white);
+        g.drawRect(inner, 2);
+    }
+
+    if (bounds.getWidth() >= MIN_LABEL_CELL_WIDTH && groupIndex < groupNames.size())
+    {
+        g.setColour(colour.contrasting());
+        g.setFont(juce::FontOptions(juce::jmin(12.0f, (float)bounds.getHeight() * 0.4f)));
+        g.drawFittedText(groupNames[groupIndex], inner.reduced(2), juce::Justification::centred, 2);
+    }
+}
+
+juce::Rectangle<int> RigVisualiserComponent::getCellBounds(int groupIndex) const
+{
+    auto column = groupIndex % numColumns;
+    auto row = groupIndex / numColumns;
+
+    // Proportional edges so the grid always fills the component exactly
+    auto x0 = column * getWidth() / numColumns;
+    auto x1 = (column + 1) * getWidth() / numColumns;
+    auto y0 = row * getHeight() / numRows;
+    auto y1 = (row + 1) * getHeight() / numRows;
+
+    return {x0, y0, x1 - x0, y1 - y0};
+}
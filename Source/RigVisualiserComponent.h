@@ -0,0 +1,58 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <vector>
+#include "GroupColourSnapshot.h"
+
+//==============================================================================
+/**
+ * Grid view of every group in the rig.
+ *
+ * Cells are drawn into a cached image; each frame only the cells whose
+ * snapshot version changed are redrawn into the cache and repainted, so the
+ * cost per frame scales with the number of changes rather than the rig size.
+ */
+class RigVisualiserComponent : public juce::Component,
+                               private juce::Timer
+{
+public:
+    explicit RigVisualiserComponent(const GroupColourSnapshot &snapshot);
+    ~RigVisualiserComponent() override;
+
+    void paint(juce::Graphics &g) override;
+    void resized() override;
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
+
+    // Labels drawn in cells that are large enough, in map order
+    void setGroupNames(const juce::StringArray &names);
+
+    // Highlight the group the editor is controlling (-1 for none)
+    void setSelectedGroupIndex(int groupIndex);
+
+private:
+    void timerCallback() override;
+    void updateTimerState();
+
+    // Cache management
+    void rebuildLayout();
+    void drawCell(juce::Graphics &g, int groupIndex, juce::uint32 argb) const;
+    juce::Rectangle<int> getCellBounds(int groupIndex) const;
+
+    static constexpr int FRAME_RATE_HZ = 60;
+    static constexpr int MIN_LABEL_CELL_WIDTH = 48;
+
+    const GroupColourSnapshot &colourSnapshot;
+
+    juce::Image cache;
+    juce::StringArray groupNames;
+    std::vector<juce::uint32> drawnVersions;
+    juce::uint32 drawnSequence = 0;
+    int numGroups = 0;
+    int numColumns = 1;
+    int numRows = 1;
+    int selectedGroupIndex = -1;
+    bool layoutDirty = true;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RigVisualiserComponent)
+};
@@ -0,0 +1,156 @@
+#include "RuntimeMetrics.h"
+
+//==============================================================================
+int RuntimeMetrics::getShardIndexForCurrentThread() noexcept
+{
+    static std::atomic<int> nextShard{0};
+    static thread_local const int shardIndex = nextShard.fetch_add(1, std::memory_order_relaxed) % numShards;
+    return shardIndex;
+}
+
+void RuntimeMetrics::add(int valueIndex, juce::uint64 amount) noexcept
+{
+    auto &shard = shards[(size_t)getShardIndexForCurrentThread()];
+    shard.values[(size_t)valueIndex].fetch_add(amount, std::memory_order_relaxed);
+}
+
+void RuntimeMetrics::increment(Counter counter, juce::uint64 amount) noexcept
+{
+    if (counter != Counter::numCounters)
+        add((int)counter, amount);
+}
+
+void RuntimeMetrics::countMidiEvent(int channel) noexcept
+{
+    if (channel >= 1 && channel <= numMidiChannels)
+        add(numCounters + channel - 1, 1);
+}
+
+void RuntimeMetrics::setMidiQueueDepth(int depth) noexcept
+{
+    midiQueueDepth.store(depth, std::memory_order_relaxed);
+
+    auto currentPeak = midiQueuePeak.load(std::memory_order_relaxed);
+    while (depth > currentPeak && !midiQueuePeak.compare_exchange_weak(currentPeak, depth, std::memory_order_relaxed))
+    {
+    }
+}
+
+//==============================================================================
+RuntimeMetrics::Snapshot RuntimeMetrics::getSnapshot() const
+{
+    Snapshot snapshot;
+    snapshot.timeMs = juce::Time::getMillisecondCounterHiRes();
+
+    for (const auto &shard : shards)
+    {
+        for (int i = 0; i < numCounters; ++i)
+            snapshot.counters[(size_t)i] += shard.values[(size_t)i].load(std::memory_order_relaxed);
+
+        for (int i = 0; i < numMidiChannels; ++i)
+            snapshot.ccsPerChannel[(size_t)i] += shard.values[(size_t)(numCounters + i)].load(std::memory_order_relaxed);
+    }
+
+    snapshot.midiQueueDepth = midiQueueDepth.load(std::memory_order_relaxed);
+    snapshot.midiQueuePeak = midiQueuePeak.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+double RuntimeMetrics::getRate(const Snapshot &current, const Snapshot &previous, Counter counter)
+{
+    auto elapsedSeconds = (current.timeMs - previous.timeMs) / 1000.0;
+    if (elapsedSeconds <= 0.0)
+        return 0.0;
+
+    return (double)(current.get(counter) - previous.get(counter)) / elapsedSeconds;
+}
+
+double RuntimeMetrics::getChannelRate(const Snapshot &current, const Snapshot &previous, int channel)
+{
+    auto elapsedSeconds = (current.timeMs - previous.timeMs) / 1000.0;
+    if (elapsedSeconds <= 0.0 || channel < 1 || channel > numMidiChannels)
+        return 0.0;
+
+    auto index = (size_t)(channel - 1);
+    return (double)(current.ccsPerChannel[index] - previous.ccsPerChannel[index]) / elapsedSeconds;
+}
+
+juce::var RuntimeMetrics::toVar(const Snapshot &current, const Snapshot &previous) const
+{
+    auto *rootObject = new juce::DynamicObject();
+
+    // Totals and per-second rates
+    auto *countersObject = new juce::DynamicObject();
+    auto *ratesObject = new juce::DynamicObject();
+    for (int i = 0; i < numCounters; ++i)
+    {
+        auto counter = (Counter)i;
+        countersObject->setProperty(getCounterName(counter), (juce::int64)current.get(counter));
+        ratesObject->setProperty(getCounterName(counter), getRate(current, previous, counter));
+    }
+    rootObject->setProperty("counters", juce::var(countersObject));
+    rootObject->setProperty("perSecond", juce::var(ratesObject));
+
+    // CCs per second for each MIDI channel that has been used
+    auto *channelsObject = new juce::DynamicObject();
+    for (int channel = 1; channel <= numMidiChannels; ++channel)
+    {
+        if (current.ccsPerChannel[(size_t)(channel - 1)] > 0)
+            channelsObject->setProperty(juce::String(channel), getChannelRate(current, previous, channel));
+    }
+    rootObject->setProperty("ccsPerSecondByChannel", juce::var(channelsObject));
+
+    // Share of the MIDI link's bandwidth in use over the interval
+    rootObject->setProperty("midiLinkOccupancy", getRate(current, previous, Counter::midiLinkBusyMicros) / 1000000.0);
+
+    // Queue gauges
+    rootObject->setProperty("midiQueueDepth", current.midiQueueDepth);
+    rootObject->setProperty("midiQueuePeak", current.midiQueuePeak);
+
+    // Parameter rebuild durations
+    auto rebuild = getParameterRebuildSummary();
+    auto *rebuildObject = new juce::DynamicObject();
+    rebuildObject->setProperty("count", (juce::int64)rebuild.count);
+    rebuildObject->setProperty("p50Ms", rebuild.p50Ms);
+    rebuildObject->setProperty("maxMs", rebuild.maxMs);
+    rootObject->setProperty("parameterRebuild", juce::var(rebuildObject));
+
+    return juce::var(rootObject);
+}
+
+const char *RuntimeMetrics::getCounterName(Counter counter)
+{
+    switch (counter)
+    {
+    case Counter::midiEventsQueued:
+        return "midiEventsQueued";
+    case Counter::midiEventsDropped:
+        return "midiEventsDropped";
+    case Counter::midiEventsSuperseded:
+        return "midiEventsSuperseded";
+    case Counter::midiLinkBusyMicros:
+        return "midiLinkBusyMicros";
+    case Counter::midiInputEvents:
+        return "midiInputEvents";
+    case Counter::mqttPublishes:
+        return "mqttPublishes";
+    case Counter::mqttPublishFailures:
+        return "mqttPublishFailures";
+    case Counter::mqttPublishesCoalesced:
+        return "mqttPublishesCoalesced";
+    case Counter::mqttPublishesDropped:
+        return "mqttPublishesDropped";
+    case Counter::mqttSubscribeErrors:
+        return "mqttSubscribeErrors";
+    case Counter::mqttReconnectAttempts:
+        return "mqttReconnectAttempts";
+    case Counter::mqttMessagesReceived:
+        return "mqttMessagesReceived";
+    case Counter::midiMapReloads:
+        return "midiMapReloads";
+    case Counter::numCounters:
+        break;
+    }
+
+    return "unknown";
+}
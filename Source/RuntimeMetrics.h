@@ -0,0 +1,91 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include "LatencyMonitor.h"
+
+//==============================================================================
+/**
+ * Lightweight runtime counters for the plugin's health.
+ *
+ * Counters are sharded per thread: each writing thread is assigned one of a
+ * fixed set of cache-line aligned shards, so the audio, message and MQTT
+ * threads never contend on the same line. Reads sum all shards.
+ */
+class RuntimeMetrics
+{
+public:
+    enum class Counter
+    {
+        midiEventsQueued,
+        midiEventsDropped,
+        midiEventsSuperseded,
+        midiLinkBusyMicros,
+        midiInputEvents,
+        mqttPublishes,
+        mqttPublishFailures,
+        mqttPublishesCoalesced,
+        mqttPublishesDropped,
+        mqttSubscribeErrors,
+        mqttReconnectAttempts,
+        mqttMessagesReceived,
+        midiMapReloads,
+        numCounters
+    };
+
+    static constexpr int numCounters = (int)Counter::numCounters;
+    static constexpr int numMidiChannels = 16;
+
+    // Point-in-time aggregate of every shard
+    struct Snapshot
+    {
+        double timeMs = 0.0;
+        std::array<juce::uint64, numCounters> counters{};
+        std::array<juce::uint64, numMidiChannels> ccsPerChannel{};
+        int midiQueueDepth = 0;
+        int midiQueuePeak = 0;
+
+        juce::uint64 get(Counter counter) const { return counters[(size_t)counter]; }
+    };
+
+    RuntimeMetrics() = default;
+
+    // Counting (safe from any thread, allocation-free)
+    void increment(Counter counter, juce::uint64 amount = 1) noexcept;
+    void countMidiEvent(int channel) noexcept; // 1-based MIDI channel
+    void setMidiQueueDepth(int depth) noexcept;
+    void recordParameterRebuild(juce::int64 micros) noexcept { parameterRebuildTimes.record(micros); }
+
+    // Aggregation
+    Snapshot getSnapshot() const;
+    LatencyHistogram::Summary getParameterRebuildSummary() const { return parameterRebuildTimes.getSummary(); }
+
+    // Per-second rate of a counter between two snapshots
+    static double getRate(const Snapshot &current, const Snapshot &previous, Counter counter);
+    static double getChannelRate(const Snapshot &current, const Snapshot &previous, int channel);
+
+    // JSON-friendly representation for the stats topic (rates relative to previous)
+    juce::var toVar(const Snapshot &current, const Snapshot &previous) const;
+
+    static const char *getCounterName(Counter counter);
+
+private:
+    static constexpr int numShards = 16;
+    static constexpr int valuesPerShard = numCounters + numMidiChannels;
+
+    struct alignas(64) Shard
+    {
+        std::array<std::atomic<juce::uint64>, valuesPerShard> values{};
+    };
+
+    static int getShardIndexForCurrentThread() noexcept;
+    void add(int valueIndex, juce::uint64 amount) noexcept;
+
+    std::array<Shard, numShards> shards;
+    std::atomic<int> midiQueueDepth{0};
+    std::atomic<int> midiQueuePeak{0};
+    LatencyHistogram parameterRebuildTimes;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RuntimeMetrics)
+};
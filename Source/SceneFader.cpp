@@ -0,0 +1,123 @@
+#include "SceneFader.h"
+#include "MemoryFootprint.h"
+
+//==============================================================================
+void SceneFader::prepare(int newNumGroups, int newNumAttributes)
+{
+    numGroups = juce::jmax(0, newNumGroups);
+    numAttributes = juce::jmax(0, newNumAttributes);
+
+    auto numCells = (size_t)(numGroups * numAttributes);
+    from.assign(numCells, 0.0f);
+    to.assign(numCells, 0.0f);
+    active.assign(numCells, 0.0f);
+    frame.assign(numCells, 0.0f);
+
+    attributeWraps.assign((size_t)numAttributes, false);
+    wrappingCells.clear();
+    wrappingCells.reserve(numCells);
+    wrappingCellsStale = false;
+
+    fading = false;
+}
+
+void SceneFader::setAttributeWraps(int attributeIndex, bool wraps)
+{
+    if (attributeIndex < 0 || attributeIndex >= numAttributes)
+        return;
+
+    if (attributeWraps[(size_t)attributeIndex] != wraps)
+    {
+        attributeWraps[(size_t)attributeIndex] = wraps;
+        wrappingCellsStale = true;
+    }
+}
+
+void SceneFader::updateWrappingCells() noexcept
+{
+    // Fits the capacity prepare() reserved, so this doesn't allocate
+    wrappingCells.clear();
+    for (int group = 0; group < numGroups; ++group)
+    {
+        for (int attribute = 0; attribute < numAttributes; ++attribute)
+        {
+            if (attributeWraps[(size_t)attribute])
+                wrappingCells.push_back(group * numAttributes + attribute);
+        }
+    }
+
+    wrappingCellsStale = false;
+}
+
+//==============================================================================
+void SceneFader::start(const float *targetValues, const float *targetActive,
+                       const float *currentValues, const float *currentActive,
+                       double fadeSeconds, juce::int64 ticks) noexcept
+{
+    using FVO = juce::FloatVectorOperations;
+
+    auto numCells = (int)to.size();
+    FVO::copy(to.data(), targetValues, numCells);
+    FVO::copy(active.data(), targetActive, numCells);
+
+    for (size_t cell = 0; cell < (size_t)numCells; ++cell)
+        from[cell] = currentActive[cell] > 0.5f ? currentValues[cell] : targetValues[cell];
+
+    if (wrappingCellsStale)
+        updateWrappingCells();
+
+    // Hue goes the short way round: move the target by a full turn if that is closer
+    for (auto cell : wrappingCells)
+    {
+        auto distance = to[(size_t)cell] - from[(size_t)cell];
+        if (distance > 0.5f)
+            to[(size_t)cell] -= 1.0f;
+        else if (distance < -0.5f)
+            to[(size_t)cell] += 1.0f;
+    }
+
+    fadeDuration = juce::jmax(0.0, fadeSeconds);
+    elapsed = 0.0;
+    stamp = ticks;
+    fading = true;
+}
+
+bool SceneFader::process(double blockSeconds, MergeLayer &layer) noexcept
+{
+    using FVO = juce::FloatVectorOperations;
+
+    auto numCells = (int)frame.size();
+    if (!fading || layer.getNumCells() != numCells)
+        return false;
+
+    elapsed += blockSeconds;
+    auto position = fadeDuration > 0.0 ? (float)juce::jmin(1.0, elapsed / fadeDuration) : 1.0f;
+
+    // frame = from + position * (to - from)
+    FVO::subtract(frame.data(), to.data(), from.data(), numCells);
+    FVO::multiply(frame.data(), position, numCells);
+    FVO::add(frame.data(), from.data(), numCells);
+
+    for (auto cell : wrappingCells)
+    {
+        auto &value = frame[(size_t)cell];
+        if (value < 0.0f)
+            value += 1.0f;
+        else if (value > 1.0f)
+            value -= 1.0f;
+    }
+
+    layer.setFrame(frame.data(), active.data(), stamp);
+
+    if (position >= 1.0f)
+        fading = false;
+
+    return true;
+}
+
+size_t SceneFader::getMemoryUsage() const
+{
+    using MF = MemoryFootprint;
+    return MF::getHeapBytes(attributeWraps) + MF::getHeapBytes(wrappingCells) + MF::getHeapBytes(from)
+           + MF::getHeapBytes(to) + MF::getHeapBytes(active) + MF::getHeapBytes(frame);
+}
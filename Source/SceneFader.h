@@ -0,0 +1,64 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <vector>
+#include "MergeEngine.h"
+
+//==============================================================================
+/**
+ * Crossfades the scene merge layer from the current output to a recalled
+ * scene.
+ *
+ * Start and target frames are kept as flat arrays, so each block is one
+ * vectorised lerp over the whole grid. Wrapping attributes (hue) have their
+ * target moved by a full turn where that is the shorter way round, and are
+ * wrapped back into range after the lerp.
+ *
+ * Not internally synchronised; the owner serialises access (the processor
+ * does this with its merge lock). start() and process() don't allocate.
+ */
+class SceneFader
+{
+public:
+    SceneFader() = default;
+
+    // Configuration. Setting flags is O(1); the wrapping cells are listed once, by the next start().
+    void prepare(int numGroups, int numAttributes);
+    void setAttributeWraps(int attributeIndex, bool wraps);
+
+    // Begin a fade to the target frame. Cells the current output doesn't
+    // hold start at their target rather than fading in from zero.
+    void start(const float *targetValues, const float *targetActive,
+               const float *currentValues, const float *currentActive,
+               double fadeSeconds, juce::int64 ticks) noexcept;
+    void stop() noexcept { fading = false; }
+    bool isFading() const { return fading; }
+
+    // Advance by one block and write the layer. Returns false when idle.
+    bool process(double blockSeconds, MergeLayer &layer) noexcept;
+
+    // Heap bytes held, not counting the object itself (message thread)
+    size_t getMemoryUsage() const;
+
+private:
+    int numGroups = 0;
+    int numAttributes = 0;
+
+    std::vector<bool> attributeWraps;
+    std::vector<int> wrappingCells; // capacity reserved by prepare()
+    bool wrappingCellsStale = false;
+    void updateWrappingCells() noexcept;
+
+    // Per-cell frames (structure of arrays)
+    std::vector<float> from;
+    std::vector<float> to;
+    std::vector<float> active;
+    std::vector<float> frame;
+
+    double fadeDuration = 0.0;
+    double elapsed = 0.0;
+    juce::int64 stamp = 0;
+    bool fading = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SceneFader)
+};
@@ -0,0 +1,172 @@
+#include "SceneLibrary.h"
+#include "MemoryFootprint.h"
+
+//==============================================================================
+void SceneLibrary::store(Scene scene)
+{
+    const juce::ScopedLock scopedLock(lock);
+
+    for (auto &existing : scenes)
+    {
+        if (existing.name == scene.name)
+        {
+            existing = std::move(scene);
+            return;
+        }
+    }
+
+    scenes.push_back(std::move(scene));
+}
+
+bool SceneLibrary::remove(const juce::String &name)
+{
+    const juce::ScopedLock scopedLock(lock);
+
+    for (auto it = scenes.begin(); it != scenes.end(); ++it)
+    {
+        if (it->name == name)
+        {
+            scenes.erase(it);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+juce::StringArray SceneLibrary::getNames() const
+{
+    const juce::ScopedLock scopedLock(lock);
+
+    juce::StringArray names;
+    for (const auto &scene : scenes)
+        names.add(scene.name);
+    return names;
+}
+
+juce::Result SceneLibrary::getFrame(const juce::String &name,
+                                    const juce::StringArray &groupIds, const juce::StringArray &attributeIds,
+                                    std::vector<float> &values, std::vector<float> &active) const
+{
+    const juce::ScopedLock scopedLock(lock);
+
+    const Scene *scene = nullptr;
+    for (const auto &candidate : scenes)
+    {
+        if (candidate.name == name)
+            scene = &candidate;
+    }
+
+    if (scene == nullptr)
+        return juce::Result::fail("No scene named " + name);
+
+    auto numAttributes = attributeIds.size();
+    values.assign((size_t)(groupIds.size() * numAttributes), 0.0f);
+    active.assign(values.size(), 0.0f);
+
+    // Match cells by ID; anything the scene doesn't know stays released
+    for (int group = 0; group < groupIds.size(); ++group)
+    {
+        auto sceneGroup = scene->groupIds.indexOf(groupIds[group]);
+        if (sceneGroup < 0)
+            continue;
+
+        for (int attribute = 0; attribute < numAttributes; ++attribute)
+        {
+            auto sceneAttribute = scene->attributeIds.indexOf(attributeIds[attribute]);
+            if (sceneAttribute < 0)
+                continue;
+
+            auto sceneCell = (size_t)(sceneGroup * scene->attributeIds.size() + sceneAttribute);
+            auto cell = (size_t)(group * numAttributes + attribute);
+            values[cell] = scene->values[sceneCell];
+            active[cell] = scene->active[sceneCell];
+        }
+    }
+
+    return juce::Result::ok();
+}
+
+//==============================================================================
+std::unique_ptr<juce::XmlElement> SceneLibrary::createXml() const
+{
+    const juce::ScopedLock scopedLock(lock);
+
+    auto xml = std::make_unique<juce::XmlElement>(SCENES_TAG);
+    for (const auto &scene : scenes)
+    {
+        auto *sceneXml = xml->createNewChildElement("SCENE");
+        sceneXml->setAttribute("name", scene.name);
+        sceneXml->setAttribute("groups", scene.groupIds.joinIntoString(","));
+        sceneXml->setAttribute("attributes", scene.attributeIds.joinIntoString(","));
+        sceneXml->setAttribute("values", encodeFloats(scene.values));
+        sceneXml->setAttribute("active", encodeFloats(scene.active));
+    }
+
+    return xml;
+}
+
+void SceneLibrary::restoreFromXml(const juce::XmlElement &xml)
+{
+    std::vector<Scene> restored;
+
+    for (auto *sceneXml : xml.getChildWithTagNameIterator("SCENE"))
+    {
+        Scene scene;
+        scene.name = sceneXml->getStringAttribute("name");
+        scene.groupIds = juce::StringArray::fromTokens(sceneXml->getStringAttribute("groups"), ",", "");
+        scene.attributeIds = juce::StringArray::fromTokens(sceneXml->getStringAttribute("attributes"), ",", "");
+
+        auto numCells = (size_t)(scene.groupIds.size() * scene.attributeIds.size());
+        scene.values = decodeFloats(sceneXml->getStringAttribute("values"), numCells);
+        scene.active = decodeFloats(sceneXml->getStringAttribute("active"), numCells);
+
+        if (scene.name.isEmpty() || scene.values.size() != numCells || scene.active.size() != numCells)
+        {
+            DBG("Skipping malformed scene in plugin state: " + scene.name);
+            continue;
+        }
+
+        restored.push_back(std::move(scene));
+    }
+
+    const juce::ScopedLock scopedLock(lock);
+    scenes = std::move(restored);
+}
+
+juce::String SceneLibrary::encodeFloats(const std::vector<float> &data)
+{
+    return juce::MemoryBlock(data.data(), data.size() * sizeof(float)).toBase64Encoding();
+}
+
+std::vector<float> SceneLibrary::decodeFloats(const juce::String &encoded, size_t expectedSize)
+{
+    juce::MemoryBlock block;
+    if (!block.fromBase64Encoding(encoded) || block.getSize() != expectedSize * sizeof(float))
+        return {};
+
+    std::vector<float> data(expectedSize);
+    block.copyTo(data.data(), 0, block.getSize());
+    return data;
+}
+
+size_t SceneLibrary::getMemoryUsage() const
+{
+    using MF = MemoryFootprint;
+    const juce::ScopedLock scopedLock(lock);
+
+    auto bytes = MF::getHeapBytes(scenes);
+    for (const auto &scene : scenes)
+    {
+        bytes += MF::getHeapBytes(scene.name) + MF::getHeapBytes(scene.values) + MF::getHeapBytes(scene.active)
+                 + MF::getHeapBytes(scene.groupIds) + MF::getHeapBytes(scene.attributeIds);
+
+        // Scene IDs are parsed from the plugin state, so they own their buffers
+        for (const auto &id : scene.groupIds)
+            bytes += MF::getHeapBytes(id);
+        for (const auto &id : scene.attributeIds)
+            bytes += MF::getHeapBytes(id);
+    }
+
+    return bytes;
+}
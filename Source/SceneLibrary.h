@@ -0,0 +1,58 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <vector>
+
+//==============================================================================
+/**
+ * A named snapshot of the whole output grid. Groups and attributes are kept
+ * by ID so a scene still recalls correctly after the map is reordered or
+ * extended; cells the scene does not hold are left to the other sources.
+ */
+struct Scene
+{
+    juce::String name;
+    juce::StringArray groupIds;
+    juce::StringArray attributeIds;
+    std::vector<float> values; // normalised, group-major
+    std::vector<float> active; // 1 or 0
+};
+
+//==============================================================================
+/**
+ * The plugin's stored scenes. Thread-safe; scenes are captured and recalled
+ * from the message thread and from inbound MQTT commands.
+ */
+class SceneLibrary
+{
+public:
+    SceneLibrary() = default;
+
+    // Add or replace a scene
+    void store(Scene scene);
+    bool remove(const juce::String &name);
+    juce::StringArray getNames() const;
+
+    // Lay a scene out for the given map order. Values and active flags are
+    // resized to groupIds.size() * attributeIds.size().
+    juce::Result getFrame(const juce::String &name,
+                          const juce::StringArray &groupIds, const juce::StringArray &attributeIds,
+                          std::vector<float> &values, std::vector<float> &active) const;
+
+    // Plugin state
+    std::unique_ptr<juce::XmlElement> createXml() const;
+    void restoreFromXml(const juce::XmlElement &xml);
+    static constexpr const char *SCENES_TAG = "SCENES";
+
+    // Heap bytes held by the stored scenes
+    size_t getMemoryUsage() const;
+
+private:
+    static juce::String encodeFloats(const std::vector<float> &data);
+    static std::vector<float> decodeFloats(const juce::String &encoded, size_t expectedSize);
+
+    mutable juce::CriticalSection lock;
+    std::vector<Scene> scenes;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SceneLibrary)
+};
@@ -0,0 +1,167 @@
+#include "TraceEvents.h"
+#include <juce_events/juce_events.h>
+#include <cstring>
+#include <limits>
+
+std::atomic<bool> TraceEvents::enabled{false};
+
+//==============================================================================
+TraceEvents::State &TraceEvents::getState()
+{
+    static State state;
+    return state;
+}
+
+void TraceEvents::setEnabled(bool shouldBeEnabled)
+{
+    auto &state = getState();
+
+    if (shouldBeEnabled)
+    {
+        const juce::ScopedLock lock(state.lock);
+        if (!state.allocated)
+        {
+            for (auto &ring : state.rings)
+                ring.spans.allocate((size_t)SPANS_PER_THREAD, false);
+            state.allocated = true;
+        }
+    }
+
+    enabled.store(shouldBeEnabled, std::memory_order_release);
+}
+
+void TraceEvents::clear()
+{
+    auto &state = getState();
+    const juce::ScopedLock lock(state.lock);
+
+    for (auto &ring : state.rings)
+    {
+        ring.numWritten.store(0, std::memory_order_relaxed);
+        ring.threadName[0] = 0;
+    }
+
+    state.numClaimed.store(0, std::memory_order_relaxed);
+    state.generation.fetch_add(1, std::memory_order_release);
+}
+
+void TraceEvents::nameCurrentThread(const char *name) noexcept
+{
+    auto *ring = getRingForCurrentThread();
+    if (ring != nullptr && ring->threadName[0] == 0)
+        std::strncpy(ring->threadName, name, sizeof(ring->threadName) - 1);
+}
+
+//==============================================================================
+TraceEvents::ThreadRing *TraceEvents::getRingForCurrentThread() noexcept
+{
+    static thread_local ThreadRing *ring = nullptr;
+    static thread_local juce::uint32 ringGeneration = 0;
+
+    auto &state = getState();
+    auto generation = state.generation.load(std::memory_order_acquire);
+    if (ringGeneration == generation)
+        return ring;
+
+    ringGeneration = generation;
+    auto index = state.numClaimed.fetch_add(1, std::memory_order_relaxed);
+    ring = index < MAX_THREADS ? &state.rings[(size_t)index] : nullptr;
+
+    if (ring != nullptr)
+    {
+        // Named now, while it's cheap to ask; other threads can label themselves
+        const char *name = nullptr;
+        juce::String threadName;
+        if (auto *thread = juce::Thread::getCurrentThread())
+        {
+            threadName = thread->getThreadName();
+            name = threadName.toRawUTF8();
+        }
+        else if (juce::MessageManager::existsAndIsCurrentThread())
+        {
+            name = "Message thread";
+        }
+
+        if (name != nullptr)
+            std::strncpy(ring->threadName, name, sizeof(ring->threadName) - 1);
+    }
+
+    return ring;
+}
+
+void TraceEvents::record(const char *name, juce::int64 startTicks, juce::int64 endTicks) noexcept
+{
+    auto *ring = getRingForCurrentThread();
+    if (ring == nullptr || ring->spans == nullptr)
+        return;
+
+    // Only this thread writes the ring; the count publishes the span to exporters
+    auto index = ring->numWritten.load(std::memory_order_relaxed);
+    ring->spans[index % (juce::uint64)SPANS_PER_THREAD] = {name, startTicks, endTicks};
+    ring->numWritten.store(index + 1, std::memory_order_release);
+}
+
+//==============================================================================
+juce::String TraceEvents::toJson()
+{
+    auto &state = getState();
+    const juce::ScopedLock lock(state.lock);
+
+    auto numThreads = juce::jmin(state.numClaimed.load(), (int)MAX_THREADS);
+    auto getSpanRange = [](const ThreadRing &ring, juce::uint64 &first, juce::uint64 &end)
+    {
+        end = ring.numWritten.load(std::memory_order_acquire);
+        first = end > (juce::uint64)SPANS_PER_THREAD ? end - (juce::uint64)SPANS_PER_THREAD : 0;
+    };
+
+    // Times are relative to the earliest span still held
+    auto originTicks = std::numeric_limits<juce::int64>::max();
+    for (int thread = 0; thread < numThreads; ++thread)
+    {
+        const auto &ring = state.rings[(size_t)thread];
+        juce::uint64 first, end;
+        getSpanRange(ring, first, end);
+        for (auto i = first; i < end; ++i)
+            originTicks = juce::jmin(originTicks, ring.spans[i % (juce::uint64)SPANS_PER_THREAD].startTicks);
+    }
+
+    auto toMicros = [](juce::int64 ticks)
+    { return juce::String(juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6, 3); };
+
+    juce::MemoryOutputStream json;
+    json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    auto separator = "";
+    for (int thread = 0; thread < numThreads; ++thread)
+    {
+        const auto &ring = state.rings[(size_t)thread];
+        auto threadName = ring.threadName[0] != 0 ? juce::String(ring.threadName) : "Thread " + juce::String(thread);
+
+        json << separator << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread
+             << ",\"args\":{\"name\":" << juce::JSON::toString(threadName) << "}}";
+        separator = ",";
+
+        juce::uint64 first, end;
+        getSpanRange(ring, first, end);
+        for (auto i = first; i < end; ++i)
+        {
+            const auto &span = ring.spans[i % (juce::uint64)SPANS_PER_THREAD];
+            if (span.name == nullptr)
+                continue;
+
+            json << ",\n{\"name\":" << juce::JSON::toString(juce::String(span.name)) << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+                 << ",\"ts\":" << toMicros(span.startTicks - originTicks) << ",\"dur\":" << toMicros(span.endTicks - span.startTicks) << "}";
+        }
+    }
+
+    json << "\n]}\n";
+    return json.toString();
+}
+
+juce::Result TraceEvents::exportToFile(const juce::File &file)
+{
+    if (!file.replaceWithText(toJson()))
+        return juce::Result::fail("Could not write " + file.getFullPathName());
+
+    return juce::Result::ok();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/**
+ * Process-wide span tracing of the hot paths, exported as Chrome trace-event
+ * JSON (chrome://tracing or ui.perfetto.dev) to show how the audio, message
+ * and MQTT threads interleave.
+ *
+ * Every thread that records claims a ring of its own on first use, so spans
+ * are written without locks or allocation; a full ring overwrites its oldest
+ * spans. While tracing is off a span costs one relaxed load. The rings are
+ * allocated when tracing is first enabled and kept for the life of the
+ * process. Span names must be string literals.
+ */
+class TraceEvents
+{
+public:
+    static void setEnabled(bool shouldBeEnabled);
+    static bool isEnabled() noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    // Drop everything recorded (while tracing is off)
+    static void clear();
+
+    // Label the calling thread in the export, if JUCE doesn't already know its name
+    // (host audio threads, Paho's callback thread). Allocation-free.
+    static void nameCurrentThread(const char *name) noexcept;
+
+    // Everything recorded so far. Export with tracing off for a consistent trace;
+    // spans recorded meanwhile may come out torn.
+    static juce::String toJson();
+    static juce::Result exportToFile(const juce::File &file);
+
+    // Times its scope on the calling thread
+    class ScopedSpan
+    {
+    public:
+        explicit ScopedSpan(const char *spanName) noexcept
+            : name(spanName), startTicks(isEnabled() ? juce::Time::getHighResolutionTicks() : 0)
+        {
+        }
+
+        ~ScopedSpan() noexcept
+        {
+            if (startTicks != 0)
+                record(name, startTicks, juce::Time::getHighResolutionTicks());
+        }
+
+    private:
+        const char *name;
+        juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedSpan)
+    };
+
+    static constexpr int MAX_THREADS = 32;         // later threads go untraced
+    static constexpr int SPANS_PER_THREAD = 16384; // 384 KB per thread
+
+private:
+    struct Span
+    {
+        const char *name = nullptr;
+        juce::int64 startTicks = 0;
+        juce::int64 endTicks = 0;
+    };
+
+    struct ThreadRing
+    {
+        juce::HeapBlock<Span> spans;
+        std::atomic<juce::uint64> numWritten{0};
+        char threadName[64] = {};
+    };
+
+    struct State
+    {
+        std::array<ThreadRing, MAX_THREADS> rings;
+        std::atomic<int> numClaimed{0};
+        std::atomic<juce::uint32> generation{1}; // bumped by clear(), so threads claim again
+        juce::CriticalSection lock;
+        bool allocated = false;
+    };
+
+    static State &getState();
+    static ThreadRing *getRingForCurrentThread() noexcept;
+    static void record(const char *name, juce::int64 startTicks, juce::int64 endTicks) noexcept;
+
+    static std::atomic<bool> enabled;
+};
+
+// Times the rest of the enclosing scope
+#define KADMIUM_TRACE_SPAN(name) TraceEvents::ScopedSpan JUCE_JOIN_MACRO(traceSpan_, __LINE__)(name)
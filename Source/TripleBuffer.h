@@ -0,0 +1,68 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/**
+ * Lock-free single-producer, single-consumer triple buffer.
+ *
+ * The producer always has a buffer to write and never waits; the consumer
+ * always reads the most recently published frame. Frames published while
+ * the consumer is busy are replaced rather than queued. Handing over is one
+ * atomic exchange of the shared "middle" index, tagged with a fresh bit.
+ */
+template <typename FrameType>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    // Producer side
+    FrameType &getWriteBuffer() noexcept { return buffers[(size_t)writeIndex]; }
+
+    void publish() noexcept
+    {
+        writeIndex = middle.exchange(writeIndex | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Consumer side: true if a new frame replaced the read buffer
+    bool acquire() noexcept
+    {
+        if ((middle.load(std::memory_order_relaxed) & freshBit) == 0)
+            return false;
+
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const FrameType &getReadBuffer() const noexcept { return buffers[(size_t)readIndex]; }
+
+    // Both sides at once, e.g. to size the frames (no producer or consumer may be running)
+    template <typename Function>
+    void forEachBuffer(Function &&function)
+    {
+        for (auto &buffer : buffers)
+            function(buffer);
+    }
+
+    // Forget any published frame (no producer or consumer may be running)
+    void reset() noexcept
+    {
+        writeIndex = 0;
+        middle.store(1, std::memory_order_relaxed);
+        readIndex = 2;
+    }
+
+private:
+    static constexpr int freshBit = 4;
+    static constexpr int indexMask = 3;
+
+    std::array<FrameType, 3> buffers;
+    int writeIndex = 0;
+    std::atomic<int> middle{1};
+    int readIndex = 2;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TripleBuffer)
+};
@@ -0,0 +1,284 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
+#include "../Source/InputRecorder.h"
+#include "../Source/PluginProcessor.h"
+#include "../Source/TraceEvents.h"
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+    using RecordType = InputRecorder::RecordType;
+
+    // Hands the processor each block's recorded host position
+    class ReplayPlayHead : public juce::AudioPlayHead
+    {
+    public:
+        juce::Optional<PositionInfo> getPosition() const override { return position; }
+
+        juce::Optional<PositionInfo> position;
+    };
+
+    struct Settings
+    {
+        juce::File trace;
+        bool realtime = false;
+        double fromSeconds = 0.0;
+        double toSeconds = std::numeric_limits<double>::max();
+        int numSlowest = 10;
+        juce::File traceEvents;
+    };
+
+    struct BlockTiming
+    {
+        double traceSeconds = 0.0;
+        double micros = 0.0;
+        double budgetMicros = 0.0; // the block's duration
+        int numSamples = 0;
+    };
+
+    bool parseArguments(int argc, char *argv[], Settings &settings)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            juce::String argument(argv[i]);
+            auto hasValue = i + 1 < argc;
+
+            if (argument == "--realtime")
+                settings.realtime = true;
+            else if (argument == "--from" && hasValue)
+                settings.fromSeconds = juce::String(argv[++i]).getDoubleValue();
+            else if (argument == "--to" && hasValue)
+                settings.toSeconds = juce::String(argv[++i]).getDoubleValue();
+            else if (argument == "--slowest" && hasValue)
+                settings.numSlowest = juce::jmax(0, juce::String(argv[++i]).getIntValue());
+            else if (argument == "--trace" && hasValue)
+                settings.traceEvents = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+            else if (!argument.startsWith("--") && settings.trace == juce::File())
+                settings.trace = juce::File::getCurrentWorkingDirectory().getChildFile(argument);
+            else
+                return false;
+        }
+
+        return settings.trace != juce::File();
+    }
+
+    void printBlocks(std::vector<BlockTiming> blocks, int numSlowest)
+    {
+        if (blocks.empty())
+        {
+            std::cout << "No blocks in the window\n";
+            return;
+        }
+
+        auto overBudget = std::count_if(blocks.begin(), blocks.end(), [](const BlockTiming &block)
+                                        { return block.micros > block.budgetMicros; });
+        auto total = std::accumulate(blocks.begin(), blocks.end(), 0.0, [](double sum, const BlockTiming &block)
+                                     { return sum + block.micros; });
+
+        std::sort(blocks.begin(), blocks.end(), [](const BlockTiming &a, const BlockTiming &b)
+                  { return a.micros > b.micros; });
+
+        std::vector<double> micros;
+        for (const auto &block : blocks)
+            micros.push_back(block.micros);
+        std::sort(micros.begin(), micros.end());
+
+        std::cout << "Blocks:    " << blocks.size() << ", " << juce::String(total / (double)blocks.size(), 1) << " us mean, "
+                  << juce::String(micros[(size_t)((double)(micros.size() - 1) * 0.99)], 1) << " us p99, "
+                  << juce::String(micros.back(), 1) << " us max, " << (juce::int64)overBudget << " over their duration\n";
+
+        if (numSlowest > 0)
+            std::cout << "Slowest:\n";
+
+        for (int i = 0; i < juce::jmin(numSlowest, (int)blocks.size()); ++i)
+        {
+            const auto &block = blocks[(size_t)i];
+            std::cout << "  at " << juce::String(block.traceSeconds, 3).paddedLeft(' ', 10) << " s"
+                      << juce::String(block.micros, 1).paddedLeft(' ', 10) << " us  ("
+                      << block.numSamples << " samples, " << juce::String(block.budgetMicros, 0) << " us budget)\n";
+        }
+    }
+} // namespace
+
+//==============================================================================
+/**
+ * Feeds a trace from InputRecorder back into a headless processor.
+ *
+ *     InputReplay <trace> [--realtime] [--from seconds] [--to seconds] [--slowest n] [--trace file]
+ *
+ * Every input is applied in recorded order: playback settings, map loads,
+ * state restores, group selections, parameter changes, MQTT commands and
+ * blocks with their host position and MIDI. Audio is silence and nothing
+ * connects to a broker. By default it runs at full speed; --realtime paces
+ * the inputs as they were recorded, timers included. Only blocks between
+ * --from and --to are timed (and paced); earlier ones run untimed at full
+ * speed so the state is the same, which makes bisecting a long trace quick.
+ * Prints per-block processing times and the slowest blocks by trace time.
+ * --trace writes the window's spans as Chrome trace-event JSON.
+ */
+int main(int argc, char *argv[])
+{
+    Settings settings;
+    if (!parseArguments(argc, argv, settings))
+    {
+        std::cout << "Usage: InputReplay <trace> [--realtime] [--from seconds] [--to seconds] [--slowest n] [--trace file]\n";
+        return 1;
+    }
+
+    // Timers and async updates need a message manager, as in a host
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    InputTraceReader reader;
+    auto result = reader.open(settings.trace);
+    if (result.failed())
+    {
+        std::cout << result.getErrorMessage() << "\n";
+        return 1;
+    }
+
+    auto processor = std::make_unique<KadmiumDMXAudioProcessor>();
+    ReplayPlayHead playHead;
+    processor->setPlayHead(&playHead);
+
+    auto numChannels = juce::jmax(processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels());
+    juce::AudioBuffer<float> buffer;
+    juce::MidiBuffer midi;
+    double sampleRate = 0.0;
+
+    auto prepare = [&](double newSampleRate, int blockSize)
+    {
+        sampleRate = newSampleRate;
+        processor->setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor->prepareToPlay(sampleRate, blockSize);
+        buffer.setSize(numChannels, blockSize);
+        midi.ensureSize(4096);
+    };
+
+    std::array<juce::int64, (size_t)RecordType::block + 1> recordCounts{};
+    std::vector<BlockTiming> blocks;
+    juce::int64 numOutputEvents = 0;
+    double firstSeconds = -1.0, lastSeconds = 0.0, lastPumpSeconds = 0.0;
+    double windowStartSeconds = -1.0, windowStartMs = 0.0;
+
+    auto replayStartMs = juce::Time::getMillisecondCounterHiRes();
+    InputTraceReader::Record record;
+
+    while (reader.readNext(record))
+    {
+        if (record.timeSeconds > settings.toSeconds)
+            break;
+
+        if (firstSeconds < 0.0)
+            firstSeconds = record.timeSeconds;
+        lastSeconds = record.timeSeconds;
+        ++recordCounts[juce::jmin((size_t)record.type, recordCounts.size() - 1)];
+
+        auto inWindow = record.timeSeconds >= settings.fromSeconds;
+        if (inWindow && windowStartSeconds < 0.0)
+        {
+            windowStartSeconds = record.timeSeconds;
+            windowStartMs = juce::Time::getMillisecondCounterHiRes();
+
+            if (settings.traceEvents != juce::File())
+                TraceEvents::setEnabled(true);
+        }
+
+        if (settings.realtime && inWindow)
+        {
+            // Wait for the record's time, running timers and async updates meanwhile
+            auto dueMs = windowStartMs + (record.timeSeconds - windowStartSeconds) * 1000.0;
+            for (auto waitMs = dueMs - juce::Time::getMillisecondCounterHiRes(); waitMs >= 1.0;
+                 waitMs = dueMs - juce::Time::getMillisecondCounterHiRes())
+                juce::MessageManager::getInstance()->runDispatchLoopUntil(juce::jmin(10, (int)waitMs));
+        }
+        else if (record.timeSeconds - lastPumpSeconds >= 1.0)
+        {
+            // At full speed, let the message loop run once per trace second
+            juce::MessageManager::getInstance()->runDispatchLoopUntil(1);
+            lastPumpSeconds = record.timeSeconds;
+        }
+
+        switch (record.type)
+        {
+        case RecordType::prepare:
+            prepare(record.sampleRate, record.numSamples);
+            break;
+
+        case RecordType::midiMap:
+            if (auto mapResult = processor->loadMidiMap(record.text); mapResult.failed())
+                std::cout << "Map at " << juce::String(record.timeSeconds, 3) << " s failed: " << mapResult.getErrorMessage() << "\n";
+            break;
+
+        case RecordType::state:
+            processor->setStateInformation(record.data.getData(), (int)record.data.getSize());
+            break;
+
+        case RecordType::selectGroup:
+            processor->setSelectedGroup(record.text);
+            break;
+
+        case RecordType::parameter:
+            if (auto *parameter = processor->getValueTreeState().getParameter(record.text))
+                parameter->setValueNotifyingHost(parameter->convertTo0to1(record.value));
+            break;
+
+        case RecordType::mqttMessage:
+            processor->injectMqttMessage(record.text, record.message);
+            break;
+
+        case RecordType::block:
+        {
+            // Traces started before the host prepared the processor carry no settings
+            if (sampleRate <= 0.0)
+                prepare(44100.0, juce::jmax(512, record.numSamples));
+
+            buffer.setSize(numChannels, record.numSamples, false, false, true);
+            buffer.clear();
+            midi.swapWith(record.midi);
+            playHead.position = record.position;
+
+            auto startTicks = juce::Time::getHighResolutionTicks();
+            processor->processBlock(buffer, midi);
+            auto micros = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1.0e6;
+
+            numOutputEvents += midi.getNumEvents();
+            if (inWindow)
+                blocks.push_back({record.timeSeconds, micros, 1.0e6 * record.numSamples / sampleRate, record.numSamples});
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    auto replayMs = juce::Time::getMillisecondCounterHiRes() - replayStartMs;
+    auto traceSpan = juce::jmax(0.0, lastSeconds - juce::jmax(0.0, firstSeconds));
+
+    std::cout << "Trace:     " << settings.trace.getFullPathName() << " (" << reader.getNumSegments() << " segments), "
+              << juce::String(juce::jmax(0.0, firstSeconds), 3) << " - " << juce::String(lastSeconds, 3) << " s\n"
+              << "Records:   " << recordCounts[(size_t)RecordType::block] << " blocks, "
+              << recordCounts[(size_t)RecordType::parameter] << " parameter changes, "
+              << recordCounts[(size_t)RecordType::mqttMessage] << " MQTT messages, "
+              << recordCounts[(size_t)RecordType::midiMap] << " maps, "
+              << recordCounts[(size_t)RecordType::state] << " states, "
+              << recordCounts[(size_t)RecordType::selectGroup] << " group selections\n"
+              << "Replay:    " << juce::String(replayMs, 1) << " ms (" << juce::String(traceSpan * 1000.0 / juce::jmax(replayMs, 0.001), 1)
+              << "x real time), " << numOutputEvents << " MIDI events out\n";
+
+    printBlocks(std::move(blocks), settings.numSlowest);
+
+    if (settings.traceEvents != juce::File())
+    {
+        TraceEvents::setEnabled(false);
+        auto traceResult = TraceEvents::exportToFile(settings.traceEvents);
+        std::cout << (traceResult.wasOk() ? "Spans:     " + settings.traceEvents.getFullPathName() : traceResult.getErrorMessage()) << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,459 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
+#include "../Source/PluginProcessor.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+    struct Settings
+    {
+        int numInstances = 16; // 0 sweeps 1, 2, 4... until realtime breaks
+        int blockSize = 64;
+        double seconds = 10.0;
+        int numThreads = 0; // 0 uses one per core, leaving one for the message thread
+        double sampleRate = 48000.0;
+        double commandsPerSecond = 200.0;
+        double reloadIntervalSeconds = 2.0;
+        double maxMissRate = 0.001; // sweep stops above this share of missed periods
+    };
+
+    struct Timings
+    {
+        double mean = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    Timings summarise(std::vector<double> values)
+    {
+        Timings timings;
+        if (values.empty())
+            return timings;
+
+        std::sort(values.begin(), values.end());
+        timings.mean = std::accumulate(values.begin(), values.end(), 0.0) / (double)values.size();
+        timings.p99 = values[(size_t)((double)(values.size() - 1) * 0.99)];
+        timings.max = values.back();
+        return timings;
+    }
+
+    // CPU time of the calling thread, so preemption isn't charged to the plugin
+    double getThreadCpuMicros() noexcept
+    {
+#if JUCE_LINUX
+        timespec time{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+        return (double)time.tv_sec * 1.0e6 + (double)time.tv_nsec / 1.0e3;
+#else
+        return juce::Time::getMillisecondCounterHiRes() * 1.0e3;
+#endif
+    }
+
+    //==============================================================================
+    // One plugin instance as a host holds it: the processor, its buffers and the
+    // parameters it automates
+    struct HostedInstance
+    {
+        std::unique_ptr<KadmiumDMXAudioProcessor> processor = std::make_unique<KadmiumDMXAudioProcessor>();
+        juce::AudioBuffer<float> buffer;
+        juce::MidiBuffer midi;
+        double phase = 0.0;
+
+        // Parameters are rebuilt with the map, so reloads swap the list under this lock.
+        // The audio thread skips automation (never the block) while it is held.
+        juce::SpinLock parametersLock;
+        juce::Array<juce::AudioProcessorParameter *> parameters;
+
+        void refreshParameters()
+        {
+            const juce::SpinLock::ScopedLockType lock(parametersLock);
+            parameters = processor->getParameters();
+        }
+    };
+
+    //==============================================================================
+    // A host audio thread: processes its share of the instances once per period
+    // and records what each callback cost and whether the period was met
+    class AudioCallbackThread : public juce::Thread
+    {
+    public:
+        AudioCallbackThread(const Settings &runSettings, std::vector<HostedInstance *> instancesToProcess, double startMs)
+            : juce::Thread("Host audio callback"),
+              settings(runSettings),
+              instances(std::move(instancesToProcess)),
+              firstPeriodMs(startMs),
+              periodMs(1000.0 * runSettings.blockSize / runSettings.sampleRate)
+        {
+            auto expectedPeriods = (size_t)(settings.seconds * 1000.0 / periodMs) + 1;
+            callbackMicros.reserve(expectedPeriods * instances.size());
+            periodLoads.reserve(expectedPeriods);
+        }
+
+        ~AudioCallbackThread() override { stopThread(5000); }
+
+        void run() override
+        {
+            auto endMs = firstPeriodMs + settings.seconds * 1000.0;
+            auto periodStartMs = firstPeriodMs;
+
+            while (!threadShouldExit() && periodStartMs < endMs)
+            {
+                // Wait for the period, sleeping for the coarse part
+                while (juce::Time::getMillisecondCounterHiRes() < periodStartMs - 1.0)
+                    juce::Thread::sleep(1);
+                while (juce::Time::getMillisecondCounterHiRes() < periodStartMs)
+                    juce::Thread::yield();
+
+                auto periodCpuMicros = 0.0;
+                for (auto *instance : instances)
+                    periodCpuMicros += processBlock(*instance);
+
+                periodLoads.push_back(periodCpuMicros / (periodMs * 10.0)); // % of the period
+                ++numPeriods;
+
+                // Finishing after the next period should have started is a dropout;
+                // the periods slept through are missed too
+                auto finishedMs = juce::Time::getMillisecondCounterHiRes();
+                periodStartMs += periodMs;
+                if (finishedMs > periodStartMs)
+                {
+                    auto periodsLate = (juce::int64)((finishedMs - periodStartMs) / periodMs) + 1;
+                    numMisses += periodsLate;
+                    periodStartMs += (double)(periodsLate - 1) * periodMs;
+                }
+            }
+        }
+
+        const Settings &settings;
+        std::vector<HostedInstance *> instances;
+        double firstPeriodMs = 0.0;
+        double periodMs = 0.0;
+
+        std::vector<double> callbackMicros;
+        std::vector<double> periodLoads;
+        juce::int64 numPeriods = 0;
+        juce::int64 numMisses = 0;
+        juce::int64 numOutputEvents = 0;
+
+    private:
+        double processBlock(HostedInstance &instance)
+        {
+            // Dense automation: every parameter moves every block
+            auto phaseStep = juce::MathConstants<double>::twoPi * 0.5 * settings.blockSize / settings.sampleRate;
+            instance.phase = std::fmod(instance.phase + phaseStep, juce::MathConstants<double>::twoPi);
+
+            // Program material for the audio-reactive build
+            for (int channel = 0; channel < instance.buffer.getNumChannels(); ++channel)
+            {
+                auto *samples = instance.buffer.getWritePointer(channel);
+                for (int sample = 0; sample < settings.blockSize; ++sample)
+                    samples[sample] = 0.25f * (float)std::sin(instance.phase * 200.0 + sample * 0.1);
+            }
+
+            auto startMicros = getThreadCpuMicros();
+            {
+                const juce::SpinLock::ScopedTryLockType lock(instance.parametersLock);
+                if (lock.isLocked())
+                {
+                    for (int i = 0; i < instance.parameters.size(); ++i)
+                    {
+                        auto value = 0.5 + 0.5 * std::sin(instance.phase + i);
+                        instance.parameters.getUnchecked(i)->setValueNotifyingHost((float)value);
+                    }
+                }
+            }
+
+            instance.midi.clear();
+            instance.processor->processBlock(instance.buffer, instance.midi);
+
+            auto elapsedMicros = getThreadCpuMicros() - startMicros;
+            callbackMicros.push_back(elapsedMicros);
+            numOutputEvents += instance.midi.getNumEvents();
+            return elapsedMicros;
+        }
+
+        JUCE_DECLARE_NON_COPYABLE(AudioCallbackThread)
+    };
+
+    //==============================================================================
+    // Inbound MQTT traffic: DMX commands for random groups and the odd scene
+    // recall, delivered through the shared hub as the MQTT callback thread would
+    class TrafficThread : public juce::Thread
+    {
+    public:
+        TrafficThread(const Settings &runSettings, juce::StringArray groupNames)
+            : juce::Thread("MQTT traffic"), settings(runSettings), groups(std::move(groupNames))
+        {
+        }
+
+        ~TrafficThread() override { stopThread(5000); }
+
+        void run() override
+        {
+            juce::Random random;
+            auto intervalMs = 1000.0 / juce::jmax(1.0, settings.commandsPerSecond);
+            auto nextMs = juce::Time::getMillisecondCounterHiRes();
+
+            while (!threadShouldExit())
+            {
+                nextMs += intervalMs;
+                auto waitMs = nextMs - juce::Time::getMillisecondCounterHiRes();
+                if (waitMs > 1.0)
+                    wait((int)waitMs);
+
+                if (random.nextInt(50) == 0)
+                {
+                    hub->deliverMessage("dmx/scene/command", "{\"recall\": \"load\", \"fade\": 0.5}");
+                }
+                else
+                {
+                    auto topic = "dmx/" + groups[random.nextInt(groups.size())] + "/command";
+                    auto payload = "{\"Hue\": " + juce::String(random.nextInt(360)) + ", \"Brightness\": " + juce::String(random.nextInt(101)) + "}";
+                    hub->deliverMessage(topic, payload);
+                }
+
+                ++numMessages;
+            }
+        }
+
+        const Settings &settings;
+        juce::StringArray groups;
+        juce::SharedResourcePointer<OutputHub> hub;
+        juce::int64 numMessages = 0;
+    };
+
+    //==============================================================================
+    // Map reloads on the message thread, alternating between two maps
+    class MapReloader : private juce::Timer
+    {
+    public:
+        MapReloader(std::vector<std::unique_ptr<HostedInstance>> &instancesToReload, juce::StringArray mapsToLoad, double intervalSeconds)
+            : instances(instancesToReload), maps(std::move(mapsToLoad))
+        {
+            startTimer(juce::jmax(1, (int)(intervalSeconds * 1000.0)));
+        }
+
+        int numReloads = 0;
+
+    private:
+        void timerCallback() override
+        {
+            auto &instance = *instances[(size_t)(numReloads % (int)instances.size())];
+            const auto &map = maps[numReloads % maps.size()];
+
+            {
+                const juce::SpinLock::ScopedLockType lock(instance.parametersLock);
+                instance.processor->loadMidiMap(map);
+                instance.parameters = instance.processor->getParameters();
+            }
+
+            ++numReloads;
+        }
+
+        std::vector<std::unique_ptr<HostedInstance>> &instances;
+        juce::StringArray maps;
+    };
+
+    //==============================================================================
+    juce::String createStageMap(int numGroups)
+    {
+        MidiMap map;
+        const char *names[] = {"Vocalist", "Guitarist", "Bassist", "Drummer", "Keys", "Rear", "Front", "Floor"};
+        for (int group = 0; group < numGroups; ++group)
+            map.groups.push_back({juce::String(group), juce::String(names[group % 8]) + (group >= 8 ? juce::String(group) : juce::String())});
+
+        map.attributes.push_back({"1", "Hue"});
+        map.attributes.push_back({"2", "Saturation"});
+        map.attributes.push_back({"3", "Brightness"});
+        map.attributes.push_back({"4", "Strobe"});
+        return MidiMapSerializer::serialize(map);
+    }
+
+    struct RunResult
+    {
+        Timings callback;
+        Timings load;
+        juce::int64 numPeriods = 0;
+        juce::int64 numMisses = 0;
+        juce::int64 numOutputEvents = 0;
+        juce::int64 numMessages = 0;
+        int numReloads = 0;
+        int numThreads = 0;
+
+        double getMissRate() const { return numPeriods > 0 ? (double)numMisses / (double)numPeriods : 0.0; }
+    };
+
+    RunResult runLoad(const Settings &settings, int numInstances)
+    {
+        auto numThreads = settings.numThreads > 0 ? settings.numThreads : juce::jmax(1, juce::SystemStats::getNumCpus() - 1);
+        numThreads = juce::jmin(numThreads, numInstances);
+
+        juce::StringArray maps{createStageMap(5), createStageMap(16)};
+
+        // Construct and prepare on the message thread, as a host does when a session opens
+        std::vector<std::unique_ptr<HostedInstance>> instances;
+        for (int i = 0; i < numInstances; ++i)
+        {
+            auto instance = std::make_unique<HostedInstance>();
+            auto &processor = *instance->processor;
+            processor.loadMidiMap(maps[0]);
+            processor.setRateAndBufferSizeDetails(settings.sampleRate, settings.blockSize);
+            processor.prepareToPlay(settings.sampleRate, settings.blockSize);
+            auto captured = processor.captureScene("load");
+            if (captured.failed())
+                std::cerr << "Scene capture failed: " << captured.getErrorMessage() << "\n";
+
+            auto numChannels = juce::jmax(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+            instance->buffer.setSize(numChannels, settings.blockSize);
+            instance->midi.ensureSize(4096);
+            instance->refreshParameters();
+            instances.push_back(std::move(instance));
+        }
+
+        // Spread the instances over the host threads and start together
+        auto startMs = juce::Time::getMillisecondCounterHiRes() + 100.0;
+        std::vector<std::unique_ptr<AudioCallbackThread>> threads;
+        for (int t = 0; t < numThreads; ++t)
+        {
+            std::vector<HostedInstance *> share;
+            for (int i = t; i < numInstances; i += numThreads)
+                share.push_back(instances[(size_t)i].get());
+
+            threads.push_back(std::make_unique<AudioCallbackThread>(settings, std::move(share), startMs));
+
+            auto periodMs = 1000.0 * settings.blockSize / settings.sampleRate;
+            if (!threads.back()->startRealtimeThread(juce::Thread::RealtimeOptions{}.withPeriodMs(periodMs)))
+                threads.back()->startThread(juce::Thread::Priority::highest);
+        }
+
+        juce::StringArray groupNames;
+        for (const auto &group : instances.front()->processor->getMidiMap().groups)
+            groupNames.add(group.second);
+
+        TrafficThread traffic(settings, groupNames);
+        traffic.startThread();
+
+        RunResult result;
+        {
+            MapReloader reloader(instances, maps, settings.reloadIntervalSeconds);
+
+            // The main thread is the host's message thread for the whole run
+            auto endMs = startMs + settings.seconds * 1000.0;
+            while (juce::Time::getMillisecondCounterHiRes() < endMs)
+                juce::MessageManager::getInstance()->runDispatchLoopUntil(20);
+
+            result.numReloads = reloader.numReloads;
+        }
+
+        traffic.stopThread(5000);
+        result.numMessages = traffic.numMessages;
+
+        std::vector<double> callbackMicros, periodLoads;
+        for (auto &thread : threads)
+        {
+            thread->stopThread(juce::roundToInt(settings.seconds * 1000.0) + 5000);
+            callbackMicros.insert(callbackMicros.end(), thread->callbackMicros.begin(), thread->callbackMicros.end());
+            periodLoads.insert(periodLoads.end(), thread->periodLoads.begin(), thread->periodLoads.end());
+            result.numPeriods += thread->numPeriods;
+            result.numMisses += thread->numMisses;
+            result.numOutputEvents += thread->numOutputEvents;
+        }
+
+        result.callback = summarise(std::move(callbackMicros));
+        result.load = summarise(std::move(periodLoads));
+        result.numThreads = numThreads;
+
+        threads.clear();
+        for (auto &instance : instances)
+            instance->processor->releaseResources();
+
+        return result;
+    }
+
+    void printHeader()
+    {
+        std::cout << "Instances  Threads  Callback mean/p99/max (us)  Period load p99  Misses        Events/s  Messages  Reloads\n";
+    }
+
+    void printResult(int numInstances, const RunResult &result, const Settings &settings)
+    {
+        auto callbacks = juce::String(result.callback.mean, 1) + " / " + juce::String(result.callback.p99, 1) + " / " + juce::String(result.callback.max, 1);
+        auto misses = juce::String(result.numMisses) + " (" + juce::String(100.0 * result.getMissRate(), 2) + "%)";
+
+        std::cout << juce::String(numInstances).paddedLeft(' ', 9) << "  "
+                  << juce::String(result.numThreads).paddedLeft(' ', 7) << "  "
+                  << callbacks.paddedLeft(' ', 26) << "  "
+                  << (juce::String(result.load.p99, 1) + " %").paddedLeft(' ', 15) << "  "
+                  << misses.paddedLeft(' ', 12) << "  "
+                  << juce::String((double)result.numOutputEvents / settings.seconds, 0).paddedLeft(' ', 10) << "  "
+                  << juce::String(result.numMessages).paddedLeft(' ', 8) << "  "
+                  << juce::String(result.numReloads).paddedLeft(' ', 7) << "\n";
+    }
+} // namespace
+
+//==============================================================================
+/**
+ * Hosts many processors at once on simulated audio callback threads and
+ * reports where realtime breaks.
+ *
+ *     LoadTest [instances] [blockSize] [seconds] [threads]
+ *
+ * Each period, every host thread runs processBlock() for its share of the
+ * instances with every parameter automated. Meanwhile a traffic thread
+ * delivers DMX commands and scene recalls through the shared hub, and the
+ * message thread reloads a MIDI map on one instance every two seconds.
+ * Callback cost is thread CPU time. A period is missed when its thread
+ * finishes after the next one was due.
+ *
+ * Defaults to 16 instances, 64-sample blocks at 48 kHz, 10 seconds and one
+ * thread per core but one. With 0 instances it sweeps 1, 2, 4... and stops
+ * at the first count that misses more than 0.1% of periods. No broker is
+ * needed.
+ */
+int main(int argc, char *argv[])
+{
+    Settings settings;
+    if (argc > 1)
+        settings.numInstances = juce::jmax(0, juce::String(argv[1]).getIntValue());
+    if (argc > 2)
+        settings.blockSize = juce::jlimit(16, 4096, juce::String(argv[2]).getIntValue());
+    if (argc > 3)
+        settings.seconds = juce::jmax(1.0, juce::String(argv[3]).getDoubleValue());
+    if (argc > 4)
+        settings.numThreads = juce::jmax(0, juce::String(argv[4]).getIntValue());
+
+    // The main thread runs the message loop, as in a host
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    std::cout << "Block: " << settings.blockSize << " samples at " << settings.sampleRate << " Hz ("
+              << juce::String(1000.0 * settings.blockSize / settings.sampleRate, 3) << " ms)\n\n";
+    printHeader();
+
+    if (settings.numInstances > 0)
+    {
+        auto result = runLoad(settings, settings.numInstances);
+        printResult(settings.numInstances, result, settings);
+        return result.numMisses == 0 ? 0 : 1;
+    }
+
+    // Sweep until the miss rate crosses the limit
+    int lastGoodCount = 0;
+    for (int numInstances = 1; numInstances <= 1024; numInstances *= 2)
+    {
+        auto result = runLoad(settings, numInstances);
+        printResult(numInstances, result, settings);
+
+        if (result.getMissRate() > settings.maxMissRate)
+            break;
+
+        lastGoodCount = numInstances;
+    }
+
+    std::cout << "\nLargest instance count within realtime: " << lastGoodCount << "\n";
+    return 0;
+}
@@ -0,0 +1,257 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
+#include "../Source/MqttClient.h"
+#include "../Source/PluginProcessor.h"
+#include "MqttTestBroker.h"
+#include <iostream>
+
+namespace
+{
+    constexpr int TIMEOUT_MS = 30000;
+
+    // Poll until the condition holds, running the message loop meanwhile
+    template <typename Condition>
+    bool waitFor(Condition &&condition, int timeoutMs = TIMEOUT_MS)
+    {
+        auto endMs = juce::Time::getMillisecondCounterHiRes() + timeoutMs;
+        while (!condition())
+        {
+            if (juce::Time::getMillisecondCounterHiRes() > endMs)
+                return false;
+
+            juce::MessageManager::getInstance()->runDispatchLoopUntil(1);
+        }
+
+        return true;
+    }
+
+    double elapsedMs(double startMs) { return juce::Time::getMillisecondCounterHiRes() - startMs; }
+
+    void printRate(const char *label, juce::int64 count, double ms)
+    {
+        std::cout << label << juce::String(count) << " in " << juce::String(ms, 1) << " ms ("
+                  << juce::String(1000.0 * (double)count / juce::jmax(ms, 0.001), 0) << " /s)\n";
+    }
+
+    void printLatency(const char *label, const LatencyHistogram &histogram)
+    {
+        auto summary = histogram.getSummary();
+        std::cout << label << "p50 " << juce::String(summary.p50Ms, 3) << " ms, p99 "
+                  << juce::String(summary.p99Ms, 3) << " ms, max " << juce::String(summary.maxMs, 3) << " ms\n";
+    }
+
+    //==============================================================================
+    // A client with counters on its inbound side; payloads carry their send time.
+    // Sessions are clean, so it subscribes again on every connect, as the hub does.
+    struct BenchClient
+    {
+        MqttClient client;
+        LatencyMonitor latencyMonitor;
+        RuntimeMetrics metrics;
+        LatencyHistogram inboundLatency;
+        std::atomic<juce::int64> numReceived{0};
+        std::atomic<bool> connected{false};
+
+        explicit BenchClient(const juce::String &url)
+        {
+            client.setLatencyMonitor(&latencyMonitor);
+            client.setRuntimeMetrics(&metrics);
+            client.setConnectionCallback([this](bool isConnected, const juce::String &)
+                                         {
+                                             if (isConnected)
+                                                 client.subscribe("dmx/+/command");
+                                             connected = isConnected; });
+            client.setMessageCallback([this](const juce::String &, const juce::String &payload)
+                                      {
+                                          auto sentTicks = payload.getLargeIntValue();
+                                          auto micros = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - sentTicks) * 1.0e6;
+                                          inboundLatency.record((juce::int64)micros);
+                                          ++numReceived; });
+            client.connect(url, "bench");
+        }
+    };
+
+    juce::String makeTimestampPayload() { return juce::String(juce::Time::getHighResolutionTicks()); }
+
+    // The subscription is live once a probe gets through; probes until then are lost
+    bool waitForSubscription(MqttTestBroker &broker, BenchClient &bench)
+    {
+        auto receivedBefore = bench.numReceived.load();
+        auto endMs = juce::Time::getMillisecondCounterHiRes() + TIMEOUT_MS;
+
+        while (bench.numReceived.load() == receivedBefore)
+        {
+            if (juce::Time::getMillisecondCounterHiRes() > endMs)
+                return false;
+
+            broker.publish("dmx/probe/command", makeTimestampPayload());
+            waitFor([&]
+                    { return bench.numReceived.load() != receivedBefore; }, 20);
+        }
+
+        return true;
+    }
+
+    // Broker -> client: publish a burst of commands and wait until all have arrived
+    bool runInbound(MqttTestBroker &broker, BenchClient &bench, int numMessages, const char *label)
+    {
+        bench.numReceived = 0;
+        bench.inboundLatency.reset();
+        auto droppedBefore = broker.getNumPacketsDropped();
+
+        auto startMs = juce::Time::getMillisecondCounterHiRes();
+        for (int i = 0; i < numMessages; ++i)
+            broker.publish("dmx/" + juce::String(i % 8) + "/command", makeTimestampPayload());
+
+        // Dropped packets never arrive, so wait for everything the broker kept
+        auto ok = waitFor([&]
+                          { return bench.numReceived.load() + (broker.getNumPacketsDropped() - droppedBefore) >= numMessages; });
+        auto ms = elapsedMs(startMs);
+
+        std::cout << label << "\n";
+        printRate("  received:  ", bench.numReceived.load(), ms);
+        std::cout << "  dropped:   " << (broker.getNumPacketsDropped() - droppedBefore) << "\n";
+        printLatency("  latency:   ", bench.inboundLatency);
+        if (!ok)
+            std::cout << "  TIMED OUT\n";
+
+        return ok;
+    }
+} // namespace
+
+//==============================================================================
+/**
+ * Benchmarks the MQTT paths against an in-process broker, so it runs the
+ * same anywhere with nothing else installed.
+ *
+ *     MqttBenchmark [messages] [reconnects]
+ *
+ * Publish throughput and delivery latency through MqttClient; inbound
+ * command throughput and latency, clean, with delivery latency injected and
+ * with a slow consumer; reconnect recovery after the broker drops every
+ * connection; and a processor taking its MIDI map and commands over MQTT
+ * through the shared hub. Defaults to 20000 messages and 5 reconnects.
+ * Exits non-zero if any phase times out.
+ */
+int main(int argc, char *argv[])
+{
+    auto numMessages = argc > 1 ? juce::jmax(1, juce::String(argv[1]).getIntValue()) : 20000;
+    auto numReconnects = argc > 2 ? juce::jmax(1, juce::String(argv[2]).getIntValue()) : 5;
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    MqttTestBroker broker;
+    if (!broker.start())
+    {
+        std::cout << "Could not start the broker\n";
+        return 1;
+    }
+
+    std::cout << "Broker: " << broker.getUrl() << "\n\n";
+    auto allOk = true;
+
+    {
+        BenchClient bench(broker.getUrl());
+        if (!waitForSubscription(broker, bench))
+        {
+            std::cout << "Client could not connect\n";
+            return 1;
+        }
+
+        // Client -> broker
+        {
+            auto receivedBefore = broker.getNumPublishesReceived();
+            auto startMs = juce::Time::getMillisecondCounterHiRes();
+            for (int i = 0; i < numMessages; ++i)
+                bench.client.publish("dmx/bench/" + juce::String(i % 64), makeTimestampPayload());
+
+            auto ok = waitFor([&]
+                              { return broker.getNumPublishesReceived() - receivedBefore >= numMessages; });
+            auto ms = elapsedMs(startMs);
+
+            std::cout << "Publish (client -> broker)\n";
+            printRate("  published: ", broker.getNumPublishesReceived() - receivedBefore, ms);
+            std::cout << "  failures:  " << bench.metrics.getSnapshot().get(RuntimeMetrics::Counter::mqttPublishFailures) << "\n";
+            auto delivery = bench.latencyMonitor.getSummary(LatencyMonitor::Stage::mqttSendToDelivery);
+            std::cout << "  delivery:  p50 " << juce::String(delivery.p50Ms, 3) << " ms, p99 " << juce::String(delivery.p99Ms, 3) << " ms\n";
+            if (!ok)
+                std::cout << "  TIMED OUT\n";
+            allOk = allOk && ok;
+        }
+
+        // Broker -> client, clean and with faults
+        allOk = runInbound(broker, bench, numMessages, "Inbound commands (broker -> client)") && allOk;
+
+        // Faults apply to packets queued after they are set
+
+        MqttTestBroker::Faults latency;
+        latency.deliveryLatencyMs = 20;
+        broker.setFaults(latency);
+        allOk = runInbound(broker, bench, numMessages, "Inbound commands, 20 ms delivery latency") && allOk;
+
+        MqttTestBroker::Faults slowConsumer;
+        slowConsumer.bytesPerSecondPerClient = 256 * 1024;
+        slowConsumer.maxQueuedPackets = 2000;
+        broker.setFaults(slowConsumer);
+        allOk = runInbound(broker, bench, numMessages, "Inbound commands, slow consumer (256 KB/s, 2000 queued)") && allOk;
+        broker.setFaults({});
+
+        // Broker restarts: time from the drop until commands reach the client again
+        std::vector<double> recoveryMs;
+        for (int i = 0; i < numReconnects; ++i)
+        {
+            auto startMs = juce::Time::getMillisecondCounterHiRes();
+            broker.dropConnections();
+
+            auto ok = waitFor([&]
+                              { return !bench.connected.load(); }) &&
+                      waitForSubscription(broker, bench);
+            recoveryMs.push_back(elapsedMs(startMs));
+            allOk = allOk && ok;
+        }
+
+        std::sort(recoveryMs.begin(), recoveryMs.end());
+        std::cout << "Reconnect recovery (" << numReconnects << " drops)\n"
+                  << "  median " << juce::String(recoveryMs[recoveryMs.size() / 2], 1) << " ms, max "
+                  << juce::String(recoveryMs.back(), 1) << " ms\n";
+    }
+
+    // A processor taking its map and commands through the shared hub
+    {
+        auto processor = std::make_unique<KadmiumDMXAudioProcessor>();
+        processor->setBrokerUrl(broker.getUrl());
+
+        MidiMap map;
+        for (int group = 0; group < 12; ++group)
+            map.groups.push_back({juce::String(group), "Group " + juce::String(group)});
+        map.attributes.push_back({"1", "Hue"});
+        map.attributes.push_back({"2", "Saturation"});
+        map.attributes.push_back({"3", "Brightness"});
+        broker.publish("config/midi_map", MidiMapSerializer::serialize(map), true);
+
+        auto startMs = juce::Time::getMillisecondCounterHiRes();
+        processor->loadMidiMapFromMqtt();
+        auto mapOk = waitFor([&]
+                             { return processor->getMidiMap().groups.size() == map.groups.size(); });
+        std::cout << "Processor\n"
+                  << "  map over MQTT:  " << juce::String(elapsedMs(startMs), 1) << " ms" << (mapOk ? "" : " (TIMED OUT)") << "\n";
+
+        const auto &hubMetrics = processor->getNetworkMetrics();
+        auto receivedBefore = hubMetrics.getSnapshot().get(RuntimeMetrics::Counter::mqttMessagesReceived);
+
+        startMs = juce::Time::getMillisecondCounterHiRes();
+        for (int i = 0; i < numMessages; ++i)
+            broker.publish("dmx/Group " + juce::String(i % 12) + "/command", "{\"Hue\": " + juce::String(i % 360) + "}");
+
+        auto commandsOk = waitFor([&]
+                                  { return hubMetrics.getSnapshot().get(RuntimeMetrics::Counter::mqttMessagesReceived) - receivedBefore >= (juce::uint64)numMessages; });
+        printRate("  commands:       ", (juce::int64)(hubMetrics.getSnapshot().get(RuntimeMetrics::Counter::mqttMessagesReceived) - receivedBefore), elapsedMs(startMs));
+        if (!commandsOk)
+            std::cout << "  TIMED OUT\n";
+
+        allOk = allOk && mapOk && commandsOk;
+    }
+
+    broker.stop();
+    return allOk ? 0 : 1;
+}
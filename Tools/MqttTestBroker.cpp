@@ -0,0 +1,525 @@
+#include "MqttTestBroker.h"
+
+namespace
+{
+    // Control packet types (high nibble of the fixed header)
+    enum PacketType
+    {
+        connectPacket = 1,
+        connackPacket = 2,
+        publishPacket = 3,
+        pubackPacket = 4,
+        pubrecPacket = 5,
+        pubrelPacket = 6,
+        pubcompPacket = 7,
+        subscribePacket = 8,
+        subackPacket = 9,
+        unsubscribePacket = 10,
+        unsubackPacket = 11,
+        pingreqPacket = 12,
+        pingrespPacket = 13,
+        disconnectPacket = 14
+    };
+
+    constexpr juce::uint8 connackServerUnavailable = 3;
+    constexpr juce::uint8 connackBadProtocol = 1;
+
+    juce::MemoryBlock makePacket(int type, int flags, const juce::MemoryBlock &body)
+    {
+        juce::MemoryOutputStream out;
+        out.writeByte((char)((type << 4) | flags));
+
+        // Remaining length, 7 bits per byte, low bits first
+        auto remaining = body.getSize();
+        do
+        {
+            auto encoded = (int)(remaining % 128);
+            remaining /= 128;
+            out.writeByte((char)(remaining > 0 ? encoded | 0x80 : encoded));
+        } while (remaining > 0);
+
+        out.write(body.getData(), body.getSize());
+        return out.getMemoryBlock();
+    }
+
+    juce::MemoryBlock makeIdPacket(int type, int flags, int packetId)
+    {
+        juce::MemoryOutputStream body;
+        body.writeShortBigEndian((short)packetId);
+        return makePacket(type, flags, body.getMemoryBlock());
+    }
+
+    void writeString(juce::MemoryOutputStream &out, const juce::String &text)
+    {
+        out.writeShortBigEndian((short)text.getNumBytesAsUTF8());
+        out.write(text.toRawUTF8(), text.getNumBytesAsUTF8());
+    }
+
+    juce::String readString(juce::MemoryInputStream &in)
+    {
+        auto length = (int)(juce::uint16)in.readShortBigEndian();
+        juce::MemoryBlock bytes;
+        in.readIntoMemoryBlock(bytes, length);
+        return juce::String::fromUTF8((const char *)bytes.getData(), (int)bytes.getSize());
+    }
+
+    juce::MemoryBlock makePublishPacket(const juce::String &topic, const juce::String &payload, bool retain)
+    {
+        juce::MemoryOutputStream body;
+        writeString(body, topic);
+        body.write(payload.toRawUTF8(), payload.getNumBytesAsUTF8());
+        return makePacket(publishPacket, retain ? 1 : 0, body.getMemoryBlock());
+    }
+} // namespace
+
+//==============================================================================
+// One client: reads its packets and writes what is queued for it, with the
+// broker's faults applied to the outbound side
+class MqttTestBroker::Connection : public juce::Thread
+{
+public:
+    Connection(MqttTestBroker &ownerBroker, std::unique_ptr<juce::StreamingSocket> clientSocket)
+        : juce::Thread("MQTT test broker connection"), broker(ownerBroker), socket(std::move(clientSocket))
+    {
+    }
+
+    ~Connection() override
+    {
+        requestClose();
+        stopThread(2000);
+    }
+
+    void run() override
+    {
+        while (!threadShouldExit() && !closeRequested.load())
+        {
+            if (!flushOutbound())
+                break;
+
+            auto ready = socket->waitUntilReady(true, 1);
+            if (ready < 0 || (ready > 0 && !readPacket()))
+                break;
+        }
+
+        socket->close();
+        closed = true;
+    }
+
+    void send(juce::MemoryBlock packet, bool isPublish = false)
+    {
+        auto currentFaults = broker.getFaults();
+        const juce::ScopedLock lock(outboundLock);
+
+        if ((int)outbound.size() >= currentFaults.maxQueuedPackets)
+        {
+            broker.packetsDropped.fetch_add(1);
+            return;
+        }
+
+        outbound.push_back({std::move(packet), juce::Time::getMillisecondCounterHiRes() + currentFaults.deliveryLatencyMs, isPublish});
+    }
+
+    bool isSubscribedTo(const juce::String &topic) const
+    {
+        const juce::ScopedLock lock(subscriptionsLock);
+        for (const auto &filter : subscriptions)
+        {
+            if (MqttTestBroker::topicMatches(filter, topic))
+                return true;
+        }
+
+        return false;
+    }
+
+    bool isAccepted() const { return accepted.load(); }
+    bool isClosed() const { return closed.load(); }
+    void requestClose() { closeRequested = true; }
+
+private:
+    struct Outbound
+    {
+        juce::MemoryBlock packet;
+        double dueMs = 0.0;
+        bool isPublish = false;
+    };
+
+    bool readBytes(void *destination, int numBytes)
+    {
+        return numBytes == 0 || socket->read(destination, numBytes, true) == numBytes;
+    }
+
+    bool readPacket()
+    {
+        juce::uint8 header = 0;
+        if (!readBytes(&header, 1))
+            return false;
+
+        int remaining = 0;
+        for (int shift = 0; shift <= 21; shift += 7)
+        {
+            juce::uint8 encoded = 0;
+            if (!readBytes(&encoded, 1))
+                return false;
+
+            remaining |= (encoded & 0x7f) << shift;
+            if ((encoded & 0x80) == 0)
+                break;
+        }
+
+        juce::MemoryBlock body((size_t)remaining);
+        if (!readBytes(body.getData(), remaining))
+            return false;
+
+        auto type = header >> 4;
+        if (type != connectPacket && !accepted.load())
+            return false; // Anything before CONNECT is a protocol violation
+
+        juce::MemoryInputStream in(body, false);
+        switch (type)
+        {
+        case connectPacket:
+            return handleConnect(in);
+        case publishPacket:
+            handlePublish(in, header & 0x0f);
+            return true;
+        case pubrelPacket:
+            send(makeIdPacket(pubcompPacket, 0, (juce::uint16)in.readShortBigEndian()));
+            return true;
+        case subscribePacket:
+            handleSubscribe(in);
+            return true;
+        case unsubscribePacket:
+            handleUnsubscribe(in);
+            return true;
+        case pingreqPacket:
+            send(makePacket(pingrespPacket, 0, {}));
+            return true;
+        case disconnectPacket:
+            return false;
+        default:
+            return true; // Acks for QoS 0 deliveries never arrive; ignore anything else
+        }
+    }
+
+    bool handleConnect(juce::MemoryInputStream &in)
+    {
+        auto protocolName = readString(in);
+        auto protocolLevel = (int)(juce::uint8)in.readByte();
+        auto isKnownProtocol = (protocolName == "MQTT" && protocolLevel == 4) || (protocolName == "MQIsdp" && protocolLevel == 3);
+
+        auto returnCode = (juce::uint8)0;
+        if (!isKnownProtocol)
+            returnCode = connackBadProtocol;
+        else if (broker.getFaults().refuseConnections)
+            returnCode = connackServerUnavailable;
+
+        // No session is ever present
+        juce::MemoryOutputStream body;
+        body.writeByte(0);
+        body.writeByte((char)returnCode);
+        send(makePacket(connackPacket, 0, body.getMemoryBlock()));
+
+        if (returnCode != 0)
+        {
+            // Let the CONNACK out before closing
+            flushOutbound(true);
+            return false;
+        }
+
+        accepted = true;
+        return true;
+    }
+
+    void handlePublish(juce::MemoryInputStream &in, int flags)
+    {
+        auto qos = (flags >> 1) & 3;
+        auto retain = (flags & 1) != 0;
+        auto topic = readString(in);
+        auto packetId = qos > 0 ? (int)(juce::uint16)in.readShortBigEndian() : 0;
+
+        juce::MemoryBlock payloadBytes;
+        in.readIntoMemoryBlock(payloadBytes);
+        auto payload = juce::String::fromUTF8((const char *)payloadBytes.getData(), (int)payloadBytes.getSize());
+
+        if (qos == 1)
+            send(makeIdPacket(pubackPacket, 0, packetId));
+        else if (qos == 2)
+            send(makeIdPacket(pubrecPacket, 0, packetId));
+
+        broker.publishesReceived.fetch_add(1);
+        {
+            const juce::ScopedLock lock(broker.callbackLock);
+            if (broker.messageCallback)
+                broker.messageCallback(topic, payload);
+        }
+
+        broker.route(topic, payload, retain);
+    }
+
+    void handleSubscribe(juce::MemoryInputStream &in)
+    {
+        auto packetId = (int)(juce::uint16)in.readShortBigEndian();
+
+        juce::StringArray filters;
+        juce::MemoryOutputStream body;
+        body.writeShortBigEndian((short)packetId);
+
+        while (!in.isExhausted())
+        {
+            filters.add(readString(in));
+            in.readByte(); // Requested QoS; everything goes out at QoS 0
+            body.writeByte(0);
+        }
+
+        {
+            const juce::ScopedLock lock(subscriptionsLock);
+            subscriptions.addArray(filters);
+        }
+
+        send(makePacket(subackPacket, 0, body.getMemoryBlock()));
+
+        // Retained messages follow the SUBACK
+        const juce::ScopedLock lock(broker.retainedLock);
+        for (const auto &topic : broker.retainedMessages.getAllKeys())
+        {
+            for (const auto &filter : filters)
+            {
+                if (MqttTestBroker::topicMatches(filter, topic))
+                {
+                    send(makePublishPacket(topic, broker.retainedMessages[topic], true), true);
+                    break;
+                }
+            }
+        }
+    }
+
+    void handleUnsubscribe(juce::MemoryInputStream &in)
+    {
+        auto packetId = (int)(juce::uint16)in.readShortBigEndian();
+
+        {
+            const juce::ScopedLock lock(subscriptionsLock);
+            while (!in.isExhausted())
+                subscriptions.removeString(readString(in));
+        }
+
+        send(makeIdPacket(unsubackPacket, 0, packetId));
+    }
+
+    // Write what is due, within the client's byte budget. force ignores the faults.
+    bool flushOutbound(bool force = false)
+    {
+        auto currentFaults = broker.getFaults();
+        auto rate = (double)currentFaults.bytesPerSecondPerClient;
+        auto nowMs = juce::Time::getMillisecondCounterHiRes();
+
+        // Token bucket holding at most one second of bytes
+        if (rate > 0.0)
+            byteBudget = juce::jmin(rate, byteBudget + (nowMs - lastRefillMs) * rate / 1000.0);
+        lastRefillMs = nowMs;
+
+        for (;;)
+        {
+            Outbound next;
+            {
+                const juce::ScopedLock lock(outboundLock);
+                if (outbound.empty())
+                    return true;
+
+                auto &front = outbound.front();
+                auto size = (double)front.packet.getSize();
+                if (!force && (front.dueMs > nowMs || (rate > 0.0 && byteBudget < juce::jmin(size, rate))))
+                    return true;
+
+                next = std::move(front);
+                outbound.pop_front();
+            }
+
+            if (rate > 0.0)
+                byteBudget -= (double)next.packet.getSize();
+
+            if (socket->write(next.packet.getData(), (int)next.packet.getSize()) != (int)next.packet.getSize())
+                return false;
+
+            if (next.isPublish)
+                broker.publishesDelivered.fetch_add(1);
+        }
+    }
+
+    MqttTestBroker &broker;
+    std::unique_ptr<juce::StreamingSocket> socket;
+    std::atomic<bool> accepted{false};
+    std::atomic<bool> closeRequested{false};
+    std::atomic<bool> closed{false};
+
+    mutable juce::CriticalSection subscriptionsLock;
+    juce::StringArray subscriptions;
+
+    juce::CriticalSection outboundLock;
+    std::deque<Outbound> outbound;
+    double byteBudget = 0.0;
+    double lastRefillMs = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Connection)
+};
+
+//==============================================================================
+MqttTestBroker::MqttTestBroker() : juce::Thread("MQTT test broker")
+{
+}
+
+MqttTestBroker::~MqttTestBroker()
+{
+    stop();
+}
+
+bool MqttTestBroker::start(int portToUse)
+{
+    if (!listener.createListener(portToUse, "127.0.0.1"))
+        return false;
+
+    port = listener.getBoundPort();
+    startThread();
+    return true;
+}
+
+void MqttTestBroker::stop()
+{
+    signalThreadShouldExit();
+    listener.close(); // Wakes the accept call
+    stopThread(2000);
+
+    const juce::ScopedLock lock(connectionsLock);
+    connections.clear();
+}
+
+void MqttTestBroker::run()
+{
+    while (!threadShouldExit())
+    {
+        std::unique_ptr<juce::StreamingSocket> clientSocket(listener.waitForNextConnection());
+        if (clientSocket == nullptr)
+            continue;
+
+        removeClosedConnections();
+
+        auto *connection = new Connection(*this, std::move(clientSocket));
+        {
+            const juce::ScopedLock lock(connectionsLock);
+            connections.add(connection);
+        }
+        connection->startThread();
+    }
+}
+
+void MqttTestBroker::removeClosedConnections()
+{
+    const juce::ScopedLock lock(connectionsLock);
+    for (int i = connections.size(); --i >= 0;)
+    {
+        if (connections.getUnchecked(i)->isClosed())
+            connections.remove(i);
+    }
+}
+
+//==============================================================================
+void MqttTestBroker::publish(const juce::String &topic, const juce::String &payload, bool retain)
+{
+    route(topic, payload, retain);
+}
+
+void MqttTestBroker::route(const juce::String &topic, const juce::String &payload, bool retain)
+{
+    if (retain)
+    {
+        // An empty retained payload clears the topic
+        const juce::ScopedLock lock(retainedLock);
+        if (payload.isEmpty())
+            retainedMessages.remove(topic);
+        else
+            retainedMessages.set(topic, payload);
+    }
+
+    auto packet = makePublishPacket(topic, payload, false);
+
+    const juce::ScopedLock lock(connectionsLock);
+    for (auto *connection : connections)
+    {
+        if (connection->isAccepted() && !connection->isClosed() && connection->isSubscribedTo(topic))
+            connection->send(packet, true);
+    }
+}
+
+//==============================================================================
+void MqttTestBroker::setFaults(const Faults &newFaults)
+{
+    const juce::ScopedLock lock(faultsLock);
+    faults = newFaults;
+}
+
+MqttTestBroker::Faults MqttTestBroker::getFaults() const
+{
+    const juce::ScopedLock lock(faultsLock);
+    return faults;
+}
+
+void MqttTestBroker::dropConnections()
+{
+    const juce::ScopedLock lock(connectionsLock);
+    for (auto *connection : connections)
+        connection->requestClose();
+}
+
+void MqttTestBroker::setMessageCallback(MessageCallback callback)
+{
+    const juce::ScopedLock lock(callbackLock);
+    messageCallback = std::move(callback);
+}
+
+int MqttTestBroker::getNumClients() const
+{
+    const juce::ScopedLock lock(connectionsLock);
+
+    int numClients = 0;
+    for (auto *connection : connections)
+    {
+        if (connection->isAccepted() && !connection->isClosed())
+            ++numClients;
+    }
+
+    return numClients;
+}
+
+bool MqttTestBroker::waitForClients(int numClients, int timeoutMs) const
+{
+    auto endMs = juce::Time::getMillisecondCounterHiRes() + timeoutMs;
+    while (getNumClients() < numClients)
+    {
+        if (juce::Time::getMillisecondCounterHiRes() > endMs)
+            return false;
+
+        juce::Thread::sleep(1);
+    }
+
+    return true;
+}
+
+bool MqttTestBroker::topicMatches(const juce::String &filter, const juce::String &topic)
+{
+    auto filterLevels = juce::StringArray::fromTokens(filter, "/", "");
+    auto topicLevels = juce::StringArray::fromTokens(topic, "/", "");
+
+    for (int i = 0; i < filterLevels.size(); ++i)
+    {
+        if (filterLevels[i] == "#")
+            return true;
+
+        if (i >= topicLevels.size())
+            return false;
+
+        if (filterLevels[i] != "+" && filterLevels[i] != topicLevels[i])
+            return false;
+    }
+
+    return filterLevels.size() == topicLevels.size();
+}
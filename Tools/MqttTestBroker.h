@@ -0,0 +1,97 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+
+//==============================================================================
+/**
+ * A minimal MQTT 3.1.1 broker for tools and tests, so nothing needs an
+ * external broker.
+ *
+ * Listens on 127.0.0.1, on an ephemeral port by default. Supports CONNECT,
+ * PUBLISH (QoS 0-2 in, QoS 0 out), SUBSCRIBE and UNSUBSCRIBE with + and #
+ * wildcards, retained messages, PINGREQ and DISCONNECT. That is everything
+ * MqttClient uses. Sessions are always clean and there is no authentication.
+ *
+ * Faults can be injected at any time:
+ *  - delivery latency: every packet to a client is held for a fixed time
+ *  - slow consumers: each client's outbound bytes are paced to a rate, and
+ *    packets beyond the queue limit are dropped and counted
+ *  - disconnects: dropConnections() closes every client, as on a broker restart
+ *  - refused connections: CONNECT is answered with "server unavailable"
+ */
+class MqttTestBroker : private juce::Thread
+{
+public:
+    struct Faults
+    {
+        int deliveryLatencyMs = 0;
+        int bytesPerSecondPerClient = 0; // 0 = unlimited
+        int maxQueuedPackets = 100000;   // per client; packets beyond are dropped
+        bool refuseConnections = false;
+    };
+
+    // Every PUBLISH a client sends (client connection thread)
+    using MessageCallback = std::function<void(const juce::String &topic, const juce::String &payload)>;
+
+    MqttTestBroker();
+    ~MqttTestBroker() override;
+
+    // Listen on the port (0 picks a free one); false if it can't be bound
+    bool start(int port = 0);
+    void stop();
+
+    int getPort() const { return port; }
+    juce::String getUrl() const { return "tcp://127.0.0.1:" + juce::String(port); }
+
+    // Publish from the broker side, as another client would
+    void publish(const juce::String &topic, const juce::String &payload, bool retain = false);
+
+    // Fault injection (any thread)
+    void setFaults(const Faults &newFaults);
+    Faults getFaults() const;
+    void dropConnections();
+
+    // Observation
+    void setMessageCallback(MessageCallback callback);
+    int getNumClients() const;
+    bool waitForClients(int numClients, int timeoutMs) const;
+    juce::int64 getNumPublishesReceived() const { return publishesReceived.load(); }
+    juce::int64 getNumPublishesDelivered() const { return publishesDelivered.load(); }
+    juce::int64 getNumPacketsDropped() const { return packetsDropped.load(); }
+
+    static bool topicMatches(const juce::String &filter, const juce::String &topic);
+
+private:
+    class Connection;
+
+    // Accept thread
+    void run() override;
+
+    void route(const juce::String &topic, const juce::String &payload, bool retain);
+    void removeClosedConnections();
+
+    juce::StreamingSocket listener;
+    int port = 0;
+
+    mutable juce::CriticalSection connectionsLock;
+    juce::OwnedArray<Connection> connections;
+
+    juce::CriticalSection retainedLock;
+    juce::StringPairArray retainedMessages;
+
+    mutable juce::CriticalSection faultsLock;
+    Faults faults;
+
+    juce::CriticalSection callbackLock;
+    MessageCallback messageCallback;
+
+    std::atomic<juce::int64> publishesReceived{0};
+    std::atomic<juce::int64> publishesDelivered{0};
+    std::atomic<juce::int64> packetsDropped{0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MqttTestBroker)
+};
@@ -0,0 +1,116 @@
+#include <juce_core/juce_core.h>
+#include "../Source/PixelMapEngine.h"
+#include "../Source/RenderPool.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+
+//==============================================================================
+/**
+ * Renders a rig of pixel-mapped groups for a fixed number of frames and
+ * reports the per-frame cost against the DMX frame budget, on one core and
+ * then across a growing render pool.
+ *
+ *     PixelMapBenchmark [universes] [frames]
+ *
+ * Defaults to 64 full universes (170 RGB pixels each) and 2000 frames. Every
+ * effect is represented, so the result covers all of the render kernels.
+ */
+int main(int argc, char *argv[])
+{
+    auto numUniverses = argc > 1 ? juce::jmax(1, juce::String(argv[1]).getIntValue()) : 64;
+    auto numFrames = argc > 2 ? juce::jmax(1, juce::String(argv[2]).getIntValue()) : 2000;
+    constexpr int pixelsPerUniverse = PixelMapEngine::UNIVERSE_SIZE / PixelMapEngine::CHANNELS_PER_PIXEL;
+
+    // One 10 x 17 matrix per universe, cycling through the effects
+    const PixelEffect::Type effects[] = {PixelEffect::Type::solid, PixelEffect::Type::gradient, PixelEffect::Type::noise,
+                                         PixelEffect::Type::chase, PixelEffect::Type::image};
+
+    juce::Image image(juce::Image::RGB, 64, 16, false);
+    for (int y = 0; y < image.getHeight(); ++y)
+        for (int x = 0; x < image.getWidth(); ++x)
+            image.setPixelAt(x, y, juce::Colour::fromHSV((float)x / (float)image.getWidth(), 1.0f, 1.0f, 1.0f));
+
+    GroupColourSnapshot groupColours;
+    groupColours.setNumGroups(numUniverses);
+
+    std::vector<PixelGeometry> geometries;
+    for (int i = 0; i < numUniverses; ++i)
+    {
+        PixelGeometry geometry;
+        geometry.groupIndex = i;
+        geometry.width = 10;
+        geometry.height = pixelsPerUniverse / 10;
+        geometry.serpentine = true;
+        geometry.universe = i + 1;
+        geometry.effect.type = effects[(size_t)i % std::size(effects)];
+        geometry.effect.secondColour = juce::Colours::blue;
+        geometry.effect.speed = 0.5f;
+        geometry.effect.scale = 2.0f;
+        geometry.effect.angle = 30.0f;
+        geometry.effect.image = image;
+        geometries.push_back(geometry);
+
+        groupColours.setColour(i, juce::Colour::fromHSV((float)i / (float)numUniverses, 1.0f, 1.0f, 1.0f).getARGB());
+    }
+
+    PixelMapEngine engine;
+    engine.prepare(geometries);
+
+    struct Result
+    {
+        double mean = 0.0;
+        double p99 = 0.0;
+    };
+
+    // Mean and p99 frame time in microseconds, with the jobs spread over the pool if there is one
+    auto measure = [&](RenderPool *pool)
+    {
+        std::vector<double> frameMicros;
+        frameMicros.reserve((size_t)numFrames);
+
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            auto start = juce::Time::getHighResolutionTicks();
+            engine.advance(1.0 / 44.0);
+            engine.render(groupColours, pool);
+            auto end = juce::Time::getHighResolutionTicks();
+
+            frameMicros.push_back(juce::Time::highResolutionTicksToSeconds(end - start) * 1.0e6);
+        }
+
+        std::sort(frameMicros.begin(), frameMicros.end());
+        Result result;
+        result.mean = std::accumulate(frameMicros.begin(), frameMicros.end(), 0.0) / (double)frameMicros.size();
+        result.p99 = frameMicros[(size_t)((double)(frameMicros.size() - 1) * 0.99)];
+        return result;
+    };
+
+    auto singleCore = measure(nullptr);
+    auto budget = 1.0e6 / 44.0;
+
+    std::cout << "Universes:        " << engine.getNumUniverses() << "\n"
+              << "Pixels:           " << engine.getNumPixels() << "\n"
+              << "Jobs per frame:   " << engine.getNumJobs() << "\n"
+              << "Frames:           " << numFrames << "\n"
+              << "Mean frame:       " << juce::String(singleCore.mean, 1) << " us\n"
+              << "p99 frame:        " << juce::String(singleCore.p99, 1) << " us\n"
+              << "Max frame rate:   " << juce::String(1.0e6 / singleCore.mean, 0) << " fps\n"
+              << "Budget at 44 fps: " << juce::String(100.0 * singleCore.mean / budget, 2) << " % of one core\n\n";
+
+    // Scaling over the render pool: the caller plus 1, 3, 7... workers
+    std::cout << "Threads  Mean (us)  p99 (us)  Speedup\n";
+    for (int numWorkers = 1; numWorkers < juce::SystemStats::getNumCpus() && numWorkers <= RenderPool::MAX_WORKERS; numWorkers = numWorkers * 2 + 1)
+    {
+        RenderPool pool(numWorkers);
+        auto result = measure(&pool);
+
+        std::cout << juce::String(numWorkers + 1).paddedLeft(' ', 7) << "  "
+                  << juce::String(result.mean, 1).paddedLeft(' ', 9) << "  "
+                  << juce::String(result.p99, 1).paddedLeft(' ', 8) << "  "
+                  << juce::String(singleCore.mean / result.mean, 2).paddedLeft(' ', 7) << "x\n";
+    }
+
+    return singleCore.p99 < budget ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
+#include "../Source/PluginProcessor.h"
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+    struct Timings
+    {
+        double mean = 0.0;
+        double p99 = 0.0;
+    };
+
+    // Mean and p99 in microseconds
+    Timings summarise(std::vector<double> micros)
+    {
+        std::sort(micros.begin(), micros.end());
+        Timings timings;
+        timings.mean = std::accumulate(micros.begin(), micros.end(), 0.0) / (double)micros.size();
+        timings.p99 = micros[(size_t)((double)(micros.size() - 1) * 0.99)];
+        return timings;
+    }
+
+    double elapsedMicros(juce::int64 startTicks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1.0e6;
+    }
+
+    void print(const char *label, const Timings &timings)
+    {
+        std::cout << label << juce::String(timings.mean, 1).paddedLeft(' ', 10) << " us mean"
+                  << juce::String(timings.p99, 1).paddedLeft(' ', 10) << " us p99\n";
+    }
+} // namespace
+
+//==============================================================================
+/**
+ * Measures what hosts pay to instantiate the plugin.
+ *
+ *     StartupBenchmark [scans] [instances]
+ *
+ * The scan pass constructs and destroys one processor at a time, as a host
+ * does while scanning or validating a plugin folder. The session pass keeps
+ * [instances] processors alive together, as when a session opens. It then
+ * times each one's first prepareToPlay(), which starts the networking and
+ * threads that construction defers. Defaults to 200 scans and 32 instances.
+ * No broker is needed; nothing connects until a MIDI map is requested.
+ * The memory footprint of one prepared instance is printed last.
+ */
+int main(int argc, char *argv[])
+{
+    auto numScans = argc > 1 ? juce::jmax(1, juce::String(argv[1]).getIntValue()) : 200;
+    auto numInstances = argc > 2 ? juce::jmax(1, juce::String(argv[2]).getIntValue()) : 32;
+
+    // Timers and async updates need a message manager, as in a host
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    // Scan: construct and destroy, one at a time
+    std::vector<double> constructMicros, destroyMicros;
+    for (int scan = 0; scan < numScans; ++scan)
+    {
+        auto startTicks = juce::Time::getHighResolutionTicks();
+        auto processor = std::make_unique<KadmiumDMXAudioProcessor>();
+        constructMicros.push_back(elapsedMicros(startTicks));
+
+        startTicks = juce::Time::getHighResolutionTicks();
+        processor.reset();
+        destroyMicros.push_back(elapsedMicros(startTicks));
+    }
+
+    // Session: many instances alive together, then prepared for playback
+    std::vector<double> sessionConstructMicros, prepareMicros, sessionDestroyMicros;
+    std::vector<std::unique_ptr<KadmiumDMXAudioProcessor>> processors;
+
+    for (int i = 0; i < numInstances; ++i)
+    {
+        auto startTicks = juce::Time::getHighResolutionTicks();
+        processors.push_back(std::make_unique<KadmiumDMXAudioProcessor>());
+        sessionConstructMicros.push_back(elapsedMicros(startTicks));
+    }
+
+    for (auto &processor : processors)
+    {
+        auto startTicks = juce::Time::getHighResolutionTicks();
+        processor->prepareToPlay(48000.0, 512);
+        prepareMicros.push_back(elapsedMicros(startTicks));
+    }
+
+    auto footprint = processors.front()->getMemoryFootprint();
+
+    for (auto &processor : processors)
+    {
+        processor->releaseResources();
+        auto startTicks = juce::Time::getHighResolutionTicks();
+        processor.reset();
+        sessionDestroyMicros.push_back(elapsedMicros(startTicks));
+    }
+
+    std::cout << "Scans:     " << numScans << "\n"
+              << "Instances: " << numInstances << "\n\n";
+    print("Scan construct:      ", summarise(constructMicros));
+    print("Scan destroy:        ", summarise(destroyMicros));
+    print("Session construct:   ", summarise(sessionConstructMicros));
+    print("First prepareToPlay: ", summarise(prepareMicros));
+    print("Session destroy:     ", summarise(sessionDestroyMicros));
+
+    std::cout << "\nPer instance:\n";
+    for (int i = 0; i < MemoryFootprint::numSubsystems; ++i)
+    {
+        auto subsystem = (MemoryFootprint::Subsystem)i;
+        std::cout << "  " << juce::String(MemoryFootprint::getSubsystemName(subsystem)).paddedRight(' ', 16)
+                  << juce::String((juce::int64)footprint.get(subsystem)).paddedLeft(' ', 10) << " bytes\n";
+    }
+    std::cout << "  " << juce::String("total").paddedRight(' ', 16)
+              << juce::String((juce::int64)footprint.getInstanceTotal()).paddedLeft(' ', 10) << " bytes\n";
+
+    std::cout << "Shared by all instances:\n";
+    for (int i = 0; i < MemoryFootprint::numShared; ++i)
+    {
+        auto shared = (MemoryFootprint::Shared)i;
+        std::cout << "  " << juce::String(MemoryFootprint::getSharedName(shared)).paddedRight(' ', 16)
+                  << juce::String((juce::int64)footprint.get(shared)).paddedLeft(' ', 10) << " bytes\n";
+    }
+
+    return 0;
+}